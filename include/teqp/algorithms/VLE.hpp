@@ -56,6 +56,18 @@ auto linsolve(const A& a, const B& b) {
     return a.matrix().colPivHouseholderQr().solve(b.matrix()).array().eval();
 }
 
+/***
+* \brief The Hessian of Psi and the gradient of Psir w.r.t. the molar concentrations, from one evaluation of build_Psir_fgradHessian_autodiff
+*
+* The diagonal entries of the Hessian for zero concentrations are the residual ones (see add_ideal_gas_Psi_Hessian_diagonal); the
+* gradient of Psir is returned alongside so that the infinite-dilution branches can treat them
+*/
+inline auto build_Psi_Hessian_Psir_gradient(const AbstractModel& model, const double T, const Eigen::ArrayXd& rhovec) {
+    auto [Psir, murr, H] = model.build_Psir_fgradHessian_autodiff(T, rhovec);
+    add_ideal_gas_Psi_Hessian_diagonal(H, model.get_R(rhovec / rhovec.sum())*T, rhovec);
+    return std::make_tuple(H, murr);
+}
+
 /***
 * \brief Do a vapor-liquid phase equilibrium problem for a mixture (binary only for now) with mole fractions specified in the liquid phase
 * \param model The model to operate on
@@ -351,8 +363,18 @@ inline auto mix_VLE_Tp(const AbstractModel& model, double T, double pgiven, cons
         for (auto iter = 0; iter < flags.maxiter; ++iter) {
             Eigen::VectorXd rv(2 * N); rv.setZero();
             functor(x, rv);
+            niter = iter;
+            nfev = iter + 1;
+            if ((rv.array().cwiseAbs() < flags.atol).all()) {
+                return_code = VLE_return_code::functol_satisfied;
+                break;
+            }
             functor.df(x, J);
             Eigen::ArrayXd dx = J.colPivHouseholderQr().solve(-rv);
+            if (!dx.allFinite()) {
+                return_code = VLE_return_code::notfinite_step;
+                break;
+            }
             if ((x.array() + dx.array() < 0).any()) {
                 // The step that would take all the concentrations to zero
                 Eigen::ArrayXd dxmax = -x;
@@ -362,9 +384,18 @@ inline auto mix_VLE_Tp(const AbstractModel& model, double T, double pgiven, cons
                 dx *= f/2; // Only allow a step half the way to most constraining molar concentrations at most
             }
             x.array() += dx.array();
-            niter = iter;
-            nfev = iter;
+            niter = iter + 1;
+            
+            auto xtol_threshold = (flags.axtol + flags.relxtol * x.array().cwiseAbs()).eval();
+            if ((dx.cwiseAbs() < xtol_threshold).all()) {
+                return_code = VLE_return_code::xtol_satisfied;
+                break;
+            }
+            if (iter == flags.maxiter - 1) {
+                return_code = VLE_return_code::maxiter_met;
+            }
         }
+        success = (return_code == VLE_return_code::xtol_satisfied || return_code == VLE_return_code::functol_satisfied);
     }
     Eigen::VectorXd final_r(2 * N); final_r.setZero();
     functor(x, final_r);
@@ -395,9 +426,11 @@ inline auto mix_VLE_Tp(const AbstractModel& model, double T, double pgiven, cons
 * \param rhovecV0 Initial values for vapor mole concentrations
 
 * \param flags Additional flags
+* \param num_iter The number of Newton iterations that were carried out
 */
-inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eigen::ArrayXd& xmolar_spec, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<MixVLEpxFlags>& flags_ = std::nullopt) {
+inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eigen::ArrayXd& xmolar_spec, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<MixVLEpxFlags>& flags_, int& num_iter) {
     using Scalar = double;
+    num_iter = 0;
     
     auto flags = flags_.value_or(MixVLEpxFlags{});
 
@@ -426,6 +459,7 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
     VLE_return_code return_code = VLE_return_code::unset;
 
     for (int iter = 0; iter < flags.maxiter; ++iter) {
+        num_iter = iter + 1;
 
         auto RL = model.get_R(xmolar_spec);
         auto RLT = RL * T;
@@ -521,18 +555,22 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
     return std::make_tuple(return_code, T, rhovecLfinal, rhovecVfinal);
 }
 
+/// The same as the other overload, without the iteration counter
+inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eigen::ArrayXd& xmolar_spec, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<MixVLEpxFlags>& flags_ = std::nullopt) {
+    int num_iter = 0;
+    return mixture_VLE_px(model, p_spec, xmolar_spec, T0, rhovecL0, rhovecV0, flags_, num_iter);
+}
+
 inline auto get_drhovecdp_Tsat(const AbstractModel& model, const double &T, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV) {
     //tic = timeit.default_timer();
-    using Scalar = double;
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = model.build_Psi_Hessian_autodiff(T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = model.build_Psi_Hessian_autodiff(T, rhovecV).eval();
-    //Hvap[~np.isfinite(Hvap)] = 1e20;
-    //Hliq[~np.isfinite(Hliq)] = 1e20;
+    // One pass per phase gives both the Hessian of Psi and the residual chemical potentials needed at infinite dilution
+    const auto [Hliq, murL] = build_Psi_Hessian_Psir_gradient(model, T, rhovecL);
+    const auto [Hvap, murV] = build_Psi_Hessian_Psir_gradient(model, T, rhovecV);
 
     auto N = rhovecL.size();
-    Eigen::MatrixXd A = decltype(Hliq)::Zero(N, N);
-    auto b = decltype(Hliq)::Ones(N, 1);
-    decltype(Hliq) drhodp_liq, drhodp_vap;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(N, N);
+    auto b = Eigen::MatrixXd::Ones(N, 1);
+    Eigen::MatrixXd drhodp_liq, drhodp_vap;
     assert(rhovecL.size() == rhovecV.size());
     if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
         // Normal treatment for all concentrations not equal to zero
@@ -546,8 +584,6 @@ inline auto get_drhovecdp_Tsat(const AbstractModel& model, const double &T, cons
     }
     else{
         // Special treatment for infinite dilution
-        auto murL = model.build_Psir_gradient_autodiff(T, rhovecL);
-        auto murV = model.build_Psir_gradient_autodiff(T, rhovecV);
         auto RL = model.get_R(rhovecL / rhovecL.sum());
         auto RV = model.get_R(rhovecV / rhovecV.sum());
 
@@ -596,17 +632,17 @@ inline auto get_drhovecdp_Tsat(const AbstractModel& model, const double &T, cons
  * Derivative of molar concentration vectors w.r.t. p along an isobar of the phase envelope for binary mixtures
 */
 inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV) {
-    using Scalar = double;
     if (rhovecL.size() != 2) { throw std::invalid_argument("Binary mixtures only"); }
     assert(rhovecL.size() == rhovecV.size());
 
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = model.build_Psi_Hessian_autodiff(T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = model.build_Psi_Hessian_autodiff(T, rhovecV).eval();
+    // One pass per phase gives both the Hessian of Psi and the residual chemical potentials needed at infinite dilution
+    const auto [Hliq, murL] = build_Psi_Hessian_Psir_gradient(model, T, rhovecL);
+    const auto [Hvap, murV] = build_Psi_Hessian_Psir_gradient(model, T, rhovecV);
 
     auto N = rhovecL.size();
-    Eigen::MatrixXd A = decltype(Hliq)::Zero(N, N);
-    Eigen::MatrixXd b = decltype(Hliq)::Ones(N, 1);
-    decltype(Hliq) drhovecdT_liq, drhovecdT_vap;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(N, N);
+    Eigen::MatrixXd b = Eigen::MatrixXd::Ones(N, 1);
+    Eigen::MatrixXd drhovecdT_liq, drhovecdT_vap;
     assert(rhovecL.size() == rhovecV.size());
 
     if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
@@ -626,8 +662,6 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
     }
     else{
         // Special treatment for infinite dilution
-        auto murL = model.build_Psir_gradient_autodiff(T, rhovecL);
-        auto murV = model.build_Psir_gradient_autodiff(T, rhovecV);
         auto RL = model.get_R(rhovecL / rhovecL.sum());
         auto RV = model.get_R(rhovecV / rhovecV.sum());
 
@@ -661,13 +695,11 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
                 auto rhovec = (is_liq) ? rhovecL : rhovecV;
                 // Initial values
                 auto Aij = (Hliq.row(j).array().cwiseProduct(rhovec.array().transpose())).eval(); // coefficient - wise product
-                // Only rows in H that have a divergent entry in a column need to be adjusted
-                if (!(Hliq.row(j)).array().isFinite().all()) { 
-                    // A correction is needed in the entry in Aij corresponding to entry for zero concentration
-                    if (rhovec[j] == 0) {
-                        // Apply correction to the j term (RT if liquid, RT*phi for vapor)
-                        Aij[j] = (is_liq) ? RL * T : RL * T * exp(-(murV[j] - murL[j]) / (RL * T));
-                    }
+                // Only rows in H whose ideal-gas diagonal term diverges (zero liquid concentration) need to be adjusted,
+                // in the entry corresponding to the zero concentration
+                if (rhovecL[j] == 0 && rhovec[j] == 0) {
+                    // Apply correction to the j term (RT if liquid, RT*phi for vapor)
+                    Aij[j] = (is_liq) ? RL * T : RL * T * exp(-(murV[j] - murL[j]) / (RL * T));
                 }
                 
                 // Fill in entry
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/algorithms/VLE.hpp"
+
+namespace teqp {
+
+struct VLECacheOptions {
+    std::size_t capacity = 64; ///< The maximum number of solutions that are stored; the oldest is replaced when full
+    double max_dT = 5.0, ///< The largest temperature difference, in K, for which a stored solution is considered a neighbor
+    max_drelp = 0.1, ///< The largest relative difference in pressure for which a stored solution is considered a neighbor
+    max_dx = 0.05; ///< The largest difference in any specified mole fraction for which a stored solution is considered a neighbor
+    bool extrapolate = true; ///< If true, the stored solution is extrapolated to first order in temperature and pressure (binary mixtures only)
+};
+
+/// Counters of the use of a VLESolutionCache
+struct VLECacheStats {
+    long long num_calls = 0, ///< The number of calls
+    num_hits = 0, ///< The number of calls that were started from a stored solution
+    num_extrapolated = 0, ///< The number of hits for which the stored solution was also extrapolated
+    num_iter_hits = 0, ///< The total number of Newton iterations in the calls that were hits
+    num_iter_misses = 0, ///< The total number of Newton iterations in the calls that were misses
+    num_failures = 0; ///< The number of calls that did not converge (and were not stored)
+    double hit_rate() const { return (num_calls > 0) ? static_cast<double>(num_hits)/num_calls : 0.0; }
+    double mean_iter_hits() const { return (num_hits > 0) ? static_cast<double>(num_iter_hits)/num_hits : 0.0; }
+    double mean_iter_misses() const { return (num_calls > num_hits) ? static_cast<double>(num_iter_misses)/(num_calls - num_hits) : 0.0; }
+};
+
+/**
+ \brief A cache of converged phase equilibrium solutions used to start the solvers at nearby states
+
+ For repeated calls to mix_VLE_Tp and mixture_VLE_px at state points that are close to each other (e.g., from one time step of a
+ dynamic simulation to the next), the initial guesses are taken from the stored solution nearest to the specified state, rather than
+ having to be provided by the caller. For binary mixtures, the stored solution is also extrapolated to first order in temperature and pressure with
+ get_drhovecdT_psat and get_drhovecdp_Tsat; the derivatives are evaluated the first time a stored solution is extrapolated from and then kept with it.
+
+ The cache holds a reference to the model, which must outlive it. It has no internal locking, so each thread should use its own cache.
+ */
+class VLESolutionCache {
+public:
+    using AbstractModel = teqp::cppinterface::AbstractModel;
+private:
+    struct Entry {
+        double T, p;
+        Eigen::ArrayXd rhovecL, rhovecV, xL;
+        bool has_derivs = false;
+        Eigen::ArrayXd drhovecLdT, drhovecVdT, drhovecLdp, drhovecVdp;
+    };
+    const AbstractModel& model;
+    VLECacheOptions opt;
+    std::vector<Entry> entries;
+    std::size_t next = 0; ///< The slot to be written next once the cache is full
+    VLECacheStats stats;
+
+    /// The index of the nearest neighbor according to the distance function, or nullopt if there is none within the neighborhood
+    template<typename Distance>
+    std::optional<std::size_t> find_nearest(const Distance& distance) const {
+        std::optional<std::size_t> best;
+        double dbest = 1.0;
+        for (auto i = 0U; i < entries.size(); ++i){
+            double d = distance(entries[i]);
+            if (d <= dbest){ dbest = d; best = i; }
+        }
+        return best;
+    }
+
+    /// Evaluate and store the derivatives along the isotherm and isobar at a stored solution; false if they are not all finite
+    bool ensure_derivs(Entry& e) const {
+        if (!e.has_derivs){
+            if (e.rhovecL.size() != 2){ return false; }
+            auto [dLdT, dVdT] = model.get_drhovecdT_psat(e.T, e.rhovecL, e.rhovecV);
+            auto [dLdp, dVdp] = model.get_drhovecdp_Tsat(e.T, e.rhovecL, e.rhovecV);
+            e.drhovecLdT = dLdT; e.drhovecVdT = dVdT; e.drhovecLdp = dLdp; e.drhovecVdp = dVdp;
+            e.has_derivs = true;
+        }
+        return e.drhovecLdT.allFinite() && e.drhovecVdT.allFinite() && e.drhovecLdp.allFinite() && e.drhovecVdp.allFinite();
+    }
+
+    /// Extrapolate the concentrations of a stored solution by dT and dp, returning false (and leaving the outputs alone) if a concentration would not be positive
+    static bool extrapolate(const Entry& e, const double dT, const double dp, Eigen::ArrayXd& rhovecL, Eigen::ArrayXd& rhovecV){
+        Eigen::ArrayXd L = e.rhovecL + e.drhovecLdT*dT + e.drhovecLdp*dp;
+        Eigen::ArrayXd V = e.rhovecV + e.drhovecVdT*dT + e.drhovecVdp*dp;
+        if (!L.allFinite() || !V.allFinite() || (L <= 0).any() || (V <= 0).any()){
+            return false;
+        }
+        rhovecL = L; rhovecV = V;
+        return true;
+    }
+
+    void store(const double T, const double p, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV){
+        if (opt.capacity == 0){ return; }
+        Entry e{T, p, rhovecL, rhovecV, rhovecL/rhovecL.sum()};
+        if (entries.size() < opt.capacity){
+            entries.push_back(std::move(e));
+        }
+        else{
+            entries[next] = std::move(e);
+            next = (next + 1) % opt.capacity;
+        }
+    }
+
+public:
+    VLESolutionCache(const AbstractModel& model, const std::optional<VLECacheOptions>& options = std::nullopt) : model(model), opt(options.value_or(VLECacheOptions{})) {
+        entries.reserve(opt.capacity);
+    }
+
+    /**
+     \brief The same as teqp::mix_VLE_Tp, but with the initial guesses taken from the nearest stored solution if there is one within the neighborhood
+
+     The initial guesses provided by the caller are only used if there is no stored solution within the neighborhood; if there is neither, an exception is raised.
+     A converged solution is added to the cache.
+     */
+    MixVLEReturn mix_VLE_Tp(const double T, const double p, const std::optional<Eigen::ArrayXd>& rhovecL0 = std::nullopt, const std::optional<Eigen::ArrayXd>& rhovecV0 = std::nullopt, const std::optional<MixVLETpFlags>& flags = std::nullopt){
+        ++stats.num_calls;
+        auto i = find_nearest([&](const Entry& e){
+            return std::max(std::abs(e.T - T)/opt.max_dT, std::abs(e.p - p)/(p*opt.max_drelp));
+        });
+        Eigen::ArrayXd rhovecL, rhovecV;
+        if (i){
+            Entry& e = entries[*i];
+            rhovecL = e.rhovecL; rhovecV = e.rhovecV;
+            if (opt.extrapolate && ensure_derivs(e) && extrapolate(e, T - e.T, p - e.p, rhovecL, rhovecV)){
+                ++stats.num_extrapolated;
+            }
+        }
+        else if (rhovecL0 && rhovecV0){
+            rhovecL = rhovecL0.value(); rhovecV = rhovecV0.value();
+        }
+        else{
+            throw teqp::InvalidArgument("No stored solution is close enough to T=" + std::to_string(T) + " K and p=" + std::to_string(p) + " Pa, and no initial guesses were provided");
+        }
+        auto r = teqp::mix_VLE_Tp(model, T, p, rhovecL, rhovecV, flags);
+        (i ? stats.num_iter_hits : stats.num_iter_misses) += r.num_iter;
+        if (i){ ++stats.num_hits; }
+        if (r.success && r.rhovecL.allFinite() && r.rhovecV.allFinite()){
+            store(T, p, r.rhovecL, r.rhovecV);
+        }
+        else{
+            ++stats.num_failures;
+        }
+        return r;
+    }
+
+    /**
+     \brief The same as teqp::mixture_VLE_px, but with the initial guesses taken from the nearest stored solution if there is one within the neighborhood
+
+     For binary mixtures, the temperature change that gives the specified liquid composition is estimated to first order, and the stored solution is extrapolated
+     in temperature and pressure; for more components the nearest stored solution is used as is.
+     */
+    std::tuple<VLE_return_code, double, Eigen::ArrayXd, Eigen::ArrayXd> mixture_VLE_px(const double p, const Eigen::ArrayXd& xspec, const std::optional<double>& T0 = std::nullopt, const std::optional<Eigen::ArrayXd>& rhovecL0 = std::nullopt, const std::optional<Eigen::ArrayXd>& rhovecV0 = std::nullopt, const std::optional<MixVLEpxFlags>& flags = std::nullopt){
+        ++stats.num_calls;
+        auto i = find_nearest([&](const Entry& e){
+            if (e.xL.size() != xspec.size()){ return std::numeric_limits<double>::infinity(); }
+            return std::max(std::abs(e.p - p)/(p*opt.max_drelp), (e.xL - xspec).abs().maxCoeff()/opt.max_dx);
+        });
+        double T;
+        Eigen::ArrayXd rhovecL, rhovecV;
+        if (i){
+            Entry& e = entries[*i];
+            T = e.T; rhovecL = e.rhovecL; rhovecV = e.rhovecV;
+            if (opt.extrapolate && ensure_derivs(e)){
+                const double dp = p - e.p, rhoL = e.rhovecL.sum();
+                // First-order changes in the liquid mole fraction of the first component along the isobar and the isotherm
+                double dxdT = (e.drhovecLdT[0] - e.xL[0]*e.drhovecLdT.sum())/rhoL;
+                double dxdp = (e.drhovecLdp[0] - e.xL[0]*e.drhovecLdp.sum())/rhoL;
+                double dT = (xspec[0] - e.xL[0] - dxdp*dp)/dxdT;
+                if (std::isfinite(dT) && std::abs(dT) < opt.max_dT && extrapolate(e, dT, dp, rhovecL, rhovecV)){
+                    T = e.T + dT;
+                    ++stats.num_extrapolated;
+                }
+            }
+        }
+        else if (T0 && rhovecL0 && rhovecV0){
+            T = T0.value(); rhovecL = rhovecL0.value(); rhovecV = rhovecV0.value();
+        }
+        else{
+            throw teqp::InvalidArgument("No stored solution is close enough to p=" + std::to_string(p) + " Pa and the specified composition, and no initial guesses were provided");
+        }
+        int num_iter = 0;
+        auto [code, Tsoln, rhovecLsoln, rhovecVsoln] = teqp::mixture_VLE_px(model, p, xspec, T, rhovecL, rhovecV, flags, num_iter);
+        (i ? stats.num_iter_hits : stats.num_iter_misses) += num_iter;
+        if (i){ ++stats.num_hits; }
+        const bool success = (code == VLE_return_code::xtol_satisfied || code == VLE_return_code::functol_satisfied);
+        if (success && std::isfinite(Tsoln) && rhovecLsoln.allFinite() && rhovecVsoln.allFinite()){
+            store(Tsoln, p, rhovecLsoln, rhovecVsoln);
+        }
+        else{
+            ++stats.num_failures;
+        }
+        return std::make_tuple(code, Tsoln, rhovecLsoln, rhovecVsoln);
+    }
+
+    const VLECacheStats& get_stats() const { return stats; }
+    void reset_stats(){ stats = VLECacheStats{}; }
+    std::size_t size() const { return entries.size(); }
+    void clear(){ entries.clear(); next = 0; }
+};
+
+}
@@ -45,30 +45,21 @@ namespace VLLE {
 
         for (int iter = 0; iter < maxiter; ++iter) {
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
-            
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-
-            auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
-            double RTL1 = model.get_R(zL1)*T, RTL2 = model.get_R(zL2)*T, RTV = model.get_R(zV)*T;
-
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+            // The value, gradient and Hessian of Psi of each phase, each from one evaluation of the derivatives
+            auto [PsiV, muV, HtotV] = model.build_Psi_fgradHessian_autodiff(T, rhovecV);
+            auto [PsiL1, muL1, HtotL1] = model.build_Psi_fgradHessian_autodiff(T, rhovecL1);
+            auto [PsiL2, muL2, HtotL2] = model.build_Psi_fgradHessian_autodiff(T, rhovecL2);
+
+            double pL1 = (rhovecL1.array() * muL1.array()).sum() - PsiL1; // The (array*array).sum is a dot product
+            double pL2 = (rhovecL2.array() * muL2.array()).sum() - PsiL2; // The (array*array).sum is a dot product
+            double pV = (rhovecV.array() * muV.array()).sum() - PsiV;
+            auto dpdrhovecL1 = (HtotL1 * rhovecL1.matrix()).array();
+            auto dpdrhovecL2 = (HtotL2 * rhovecL2.matrix()).array();
+            auto dpdrhovecV = (HtotV * rhovecV.matrix()).array();
 
             // 2N rows are equality of chemical equilibria
-            r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
-            r.segment(N,N) = PsirgradL1 + RTL1 * log(rhovecL1) - (PsirgradL2 + RTL2 * log(rhovecL2));
+            r.head(N) = muV - muL1;
+            r.segment(N,N) = muL1 - muL2;
             // Followed by N pressure equilibria
             r(2*N) = pV - pL1;
             r(2*N+1) = pL1 - pL2;
@@ -152,27 +143,20 @@ namespace VLLE {
         for (int iter = 0; iter < maxiter; ++iter) {
             T = x(x.size()-1);
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
-            
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
+            // The value, gradient and Hessian of Psi of each phase, each from one evaluation of the derivatives
+            auto [PsiV, muV, HtotV] = model.build_Psi_fgradHessian_autodiff(T, rhovecV);
+            auto [PsiL1, muL1, HtotL1] = model.build_Psi_fgradHessian_autodiff(T, rhovecL1);
+            auto [PsiL2, muL2, HtotL2] = model.build_Psi_fgradHessian_autodiff(T, rhovecL2);
 
             auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
             double RL1 = model.get_R(zL1), RL2 = model.get_R(zL2), RV = model.get_R(zV);
-            double RTL1 = RL1*T, RTL2 = RL2*T, RTV = RV*T;
-
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+
+            double pL1 = (rhovecL1.array() * muL1.array()).sum() - PsiL1; // The (array*array).sum is a dot product
+            double pL2 = (rhovecL2.array() * muL2.array()).sum() - PsiL2; // The (array*array).sum is a dot product
+            double pV = (rhovecV.array() * muV.array()).sum() - PsiV;
+            auto dpdrhovecL1 = (HtotL1 * rhovecL1.matrix()).array();
+            auto dpdrhovecL2 = (HtotL2 * rhovecL2.matrix()).array();
+            auto dpdrhovecV = (HtotV * rhovecV.matrix()).array();
             
             auto DELTAVL1dmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecV.eval())
                                   - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1.eval())).eval();
@@ -182,8 +166,8 @@ namespace VLLE {
             auto DELTAL1L2_dchempot_dT = (DELTAL1L2dmu_dT_res + RL1*log(rhovecL1) - RL2*log(rhovecL2)).eval();
 
             // 2N rows are equality of chemical equilibria
-            r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
-            r.segment(N,N) = PsirgradL1 + RTL1 * log(rhovecL1) - (PsirgradL2 + RTL2 * log(rhovecL2));
+            r.head(N) = muV - muL1;
+            r.segment(N,N) = muL1 - muL2;
             // Followed by 2 pressure equilibria for the phases
             r(2*N) = pV - pL1;
             r(2*N+1) = pL1 - pL2;
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include <map>
+#include <functional>
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/models/multifluid_ancillaries.hpp"
+#include "teqp/models/superancillary.hpp"
 
 namespace teqp{
 namespace ancillaries{
@@ -151,5 +154,125 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
 }
 
 
+/**
+ Build the superancillary equations of a pure fluid for any model, from Tmin up to the critical point.
+
+ The saturated liquid density, and the logarithms of the saturated vapor density and of the vapor pressure, are fit with piecewise Chebyshev
+ expansions in \f$x=\sqrt{T_c-T}\f$ (see SuperAncillaryCurve). The values at the nodes are obtained by solving the VLE problem with
+ pure_VLE_T, starting from the closest solution obtained so far, and the intervals are split until the expansions have converged to
+ the precision of those solutions.
+
+ Very close to the critical point the VLE problem becomes too ill-conditioned to be solved in double precision, so the interval that
+ ends at the critical point is not split; it is sized such that its first node after the critical point is at Theta_nearcrit.
+
+ The flags that can be provided are:
+ - "Nfit": the degree of the expansions (default 16)
+ - "rtol": the relative magnitude of the last coefficients of the expansions below which an interval is accepted (default 1e-13)
+ - "max_refine": the maximum number of times an interval can be split in half (default 10)
+ - "Theta_nearcrit": the value of \f$(T_c-T)/T_c\f$ of the VLE solution closest to the critical point, whose starting values come from the critical extrapolation (default 1e-5)
+*/
+inline auto build_superancillaries(const AbstractModel& model, double Tcritguess, double rhocritguess, double Tmin, const std::optional<nlohmann::json>& flags_ = std::nullopt)
+{
+    nlohmann::json flags = flags_.value_or(nlohmann::json::object());
+    int Nfit = flags.value("Nfit", 16);
+    double rtol = flags.value("rtol", 1e-13);
+    int max_refine = flags.value("max_refine", 10);
+    double Theta_nearcrit = flags.value("Theta_nearcrit", 1e-5);
+    
+    double Tcrit, rhocrit; // Not a structured binding because they are captured in lambdas below
+    std::tie(Tcrit, rhocrit) = model.solve_pure_critical(Tcritguess, rhocritguess);
+    if (!(Tmin < Tcrit)){
+        throw teqp::InvalidArgument("Tmin of " + std::to_string(Tmin) + " K must be below the critical temperature of " + std::to_string(Tcrit) + " K");
+    }
+    auto molefrac = (Eigen::ArrayXd(1) << 1.0).finished();
+    double R = model.get_R(molefrac);
+    auto get_p = [&](double T, double rho){ return rho*R*T*(1+model.get_Ar01(T, rho, molefrac)); };
+    double pcrit = get_p(Tcrit, rhocrit);
+    
+    // The derivatives of the saturated densities with respect to x, obtained from the Clapeyron equation
+    auto get_drhodx = [&](double x, double rhoL, double rhoV){
+        double T = Tcrit - x*x;
+        double dpsatdT = model.dpsatdT_pure(T, rhoL, rhoV);
+        auto get_drhodT = [&](double rho){
+            double dpdrho = R*T*(1 + 2*model.get_Ar01(T, rho, molefrac) + model.get_Ar02(T, rho, molefrac));
+            double dpdT = R*rho*(1 + model.get_Ar01(T, rho, molefrac) - model.get_Ar11(T, rho, molefrac));
+            return -dpdT/dpdrho + dpsatdT/dpdrho;
+        };
+        return std::make_tuple(-2*x*get_drhodT(rhoL), -2*x*get_drhodT(rhoV));
+    };
+    
+    // A solution is accepted if it is not the trivial one and the pressures of the phases agree
+    auto is_valid = [&](double T, double rhoL, double rhoV){
+        if (!std::isfinite(rhoL) || !std::isfinite(rhoV) || rhoV <= 0 || rhoL - rhoV < 1e-6*rhocrit){
+            return false;
+        }
+        return std::abs(get_p(T, rhoL)/get_p(T, rhoV) - 1) < 1e-8;
+    };
+    
+    // The solutions obtained so far, keyed by x, and storing the densities and their derivatives with respect to x
+    std::map<double, std::array<double, 4>> solutions;
+    auto store = [&](double x, double rhoL, double rhoV){
+        auto [drhoLdx, drhoVdx] = get_drhodx(x, rhoL, rhoV);
+        solutions[x] = {rhoL, rhoV, drhoLdx, drhoVdx};
+    };
+    {
+        double xseed = sqrt(Theta_nearcrit*Tcrit), Tseed = Tcrit - xseed*xseed;
+        auto rhovec = model.extrapolate_from_critical(Tcrit, rhocrit, Tseed);
+        rhovec = model.pure_VLE_T(Tseed, rhovec[0], rhovec[1], 100);
+        if (!is_valid(Tseed, rhovec[0], rhovec[1])){
+            throw teqp::IterationFailure("Unable to obtain the VLE solution at " + std::to_string(Tseed) + " K close to the critical point");
+        }
+        store(xseed, rhovec[0], rhovec[1]);
+    }
+    
+    // Solve for the VLE at x with the starting values extrapolated linearly in x from the closest solution. If that fails, the step is
+    // halved by first obtaining the solution in between
+    std::function<std::tuple<double, double>(double, int)> solve_VLE = [&](double x, int depth) -> std::tuple<double, double> {
+        auto it = solutions.lower_bound(x);
+        if (it == solutions.end() || (it != solutions.begin() && x - std::prev(it)->first < it->first - x)){
+            --it;
+        }
+        const auto& [xclosest, v] = *it;
+        double T = Tcrit - x*x;
+        auto rhovec = model.pure_VLE_T(T, v[0] + v[2]*(x-xclosest), v[1] + v[3]*(x-xclosest), 100);
+        if (!is_valid(T, rhovec[0], rhovec[1])){
+            if (depth > 20){
+                throw teqp::IterationFailure("Unable to obtain the VLE solution at " + std::to_string(T) + " K");
+            }
+            solve_VLE((x + xclosest)/2, depth+1);
+            return solve_VLE(x, depth+1);
+        }
+        store(x, rhovec[0], rhovec[1]);
+        return std::make_tuple(rhovec[0], rhovec[1]);
+    };
+    
+    auto f = [&](double x) -> std::array<double, 3> {
+        if (x == 0){
+            return {rhocrit, log(rhocrit), log(pcrit)};
+        }
+        auto [rhoL, rhoV] = solve_VLE(x, 0);
+        return {rhoL, log(rhoV), log(get_p(Tcrit - x*x, rhoL))};
+    };
+    // The interval touching the critical point, and then the others from there down to Tmin
+    double xmax = sqrt(Tcrit - Tmin), xseed = sqrt(Theta_nearcrit*Tcrit);
+    double xcrit = std::min(xmax, xseed/((1-cos(internal::Chebyshev_pi/Nfit))/2));
+    auto pws = fit_piecewise_Chebyshev_multi(f, 0.0, xcrit, Nfit, rtol, 0);
+    if (xcrit < xmax){
+        auto pwsrest = fit_piecewise_Chebyshev_multi(f, xcrit, xmax, Nfit, rtol, max_refine);
+        for (auto m = 0U; m < pws.size(); ++m){
+            auto& e = pws[m].expansions;
+            e.insert(e.end(), pwsrest[m].expansions.begin(), pwsrest[m].expansions.end());
+        }
+    }
+    
+    return SuperAncillaryVLE(Tcrit, rhocrit, pcrit, Tmin,
+        SuperAncillaryCurve(pws[0], Tcrit, Tmin, false),
+        SuperAncillaryCurve(pws[1], Tcrit, Tmin, true),
+        SuperAncillaryCurve(pws[2], Tcrit, Tmin, true)
+    );
 }
+
+
 }
+}
+
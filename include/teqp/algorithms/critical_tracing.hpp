@@ -50,12 +50,8 @@ struct CriticalTracing {
         using id = IsochoricDerivatives<decltype(model)>;
         auto H = id::build_Psir_Hessian_mcx(model, T, rhovec);
 #endif
-        // ... and add ideal-gas terms to H
-        for (auto i = 0; i < N; ++i) {
-            if (mask[i]) {
-                H(i, i) += model.R(rhovec/rhovec.sum()) * T / rhovec[i];
-            }
-        }
+        // ... and add ideal-gas terms to H, except for the zero concentrations, which are removed below
+        add_ideal_gas_Psi_Hessian_diagonal(H, model.R(rhovec/rhovec.sum()) * T, rhovec);
 
         Eigen::Index nonzero_count = mask.count();
         auto zero_count = N - nonzero_count;
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <optional>
+#include <algorithm>
+#include <cmath>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/derivs.hpp"
+#include "teqp/algorithms/iteration.hpp"
+#include "teqp/algorithms/flash_types.hpp"
+#include "teqp/algorithms/rho_Tp.hpp"
+
+namespace teqp {
+namespace flash {
+
+using namespace cppinterface;
+
+namespace internal {
+
+    /**
+     The pressure and its derivative with respect to molar density at constant temperature and composition
+     
+     Both are NaN if \f$\alpha^{\rm r}\f$ itself is not finite; beyond close packing the derivatives can remain finite (e.g., the derivative of \f$\ln(1-b\rho)\f$) even though the value is not
+     */
+    inline auto get_p_dpdrho(const AbstractModel& model, const double T, const double rho, const REArrayd& x, const double R){
+        auto Ar0n = model.get_Ar02n(T, rho, x);
+        if (!std::isfinite(Ar0n[0])){
+            return std::make_tuple(std::nan(""), std::nan(""));
+        }
+        return std::make_tuple(rho*R*T*(1.0 + Ar0n[1]), R*T*(1.0 + 2.0*Ar0n[1] + Ar0n[2]));
+    }
+
+    /**
+     \brief Solve for the molar density of a phase at given temperature, pressure and composition, see teqp::rho_Tp::solve_rho_branch
+     \returns The density, or NaN if no root was found
+     */
+    inline double solve_rho(const AbstractModel& model, const double T, const double p, const REArrayd& x, const bool liquid, const double R, const double rho_guess = -1){
+        return rho_Tp::solve_rho_branch(model, T, p, x, liquid, R, rho_guess);
+    }
+
+    /**
+     \brief The phase identification parameter of Venkatarathnam and Oellrich, doi: 10.1016/j.fluid.2010.12.001
+     
+     \f[ \Pi = 2 + \rho\left(\frac{(\partial^2 p/\partial\rho^2)_T}{(\partial p/\partial\rho)_T} - \frac{\partial^2 p/\partial\rho\partial T}{(\partial p/\partial T)_\rho}\right) \f]
+     which is greater than one for liquid-like phases and less than one for vapor-like phases
+     */
+    inline double get_phase_identification_parameter(const AbstractModel& model, const double T, const double rho, const REArrayd& x){
+        const double Ar01 = model.get_Ar01(T, rho, x), Ar02 = model.get_Ar02(T, rho, x), Ar03 = model.get_Ar03(T, rho, x);
+        const double Ar11 = model.get_Ar11(T, rho, x), Ar12 = model.get_Ar12(T, rho, x);
+        // Common factors of R, T and rho have been removed from each ratio
+        const double d2pdrho2_over_dpdrho = (2*Ar01 + 4*Ar02 + Ar03)/(1 + 2*Ar01 + Ar02);
+        const double d2pdrhodT_over_dpdT = (1 + 2*Ar01 + Ar02 - 2*Ar11 - Ar12)/(1 + Ar01 - Ar11);
+        return 2 + d2pdrho2_over_dpdrho - d2pdrhodT_over_dpdT;
+    }
+
+    /// Natural logarithm of the fugacity coefficients at a state point for which the pressure is known
+    inline EArrayd get_lnphi(const AbstractModel& model, const double T, const double rho, const double p, const EArrayd& x){
+        const double R = model.get_R(x);
+        EArrayd rhovec = rho*x;
+        return model.build_Psir_gradient_autodiff(T, rhovec)/(R*T) - log(p/(rho*R*T));
+    }
+
+    /// A phase with known density and fugacity coefficients
+    struct Phase{
+        double rho = -1;
+        EArrayd lnphi;
+        bool ok() const { return std::isfinite(rho) && rho > 0; }
+    };
+
+    /// Solve for the density of a phase of the desired kind (falling back to the other kind), and the fugacity coefficients
+    inline Phase get_phase(const AbstractModel& model, const double T, const double p, const EArrayd& x, const bool liquid, const double rho_guess){
+        const double R = model.get_R(x);
+        Phase ph;
+        ph.rho = solve_rho(model, T, p, x, liquid, R, rho_guess);
+        if (!ph.ok() && rho_guess > 0){
+            ph.rho = solve_rho(model, T, p, x, liquid, R);
+        }
+        if (!ph.ok()){
+            ph.rho = solve_rho(model, T, p, x, !liquid, R);
+        }
+        if (ph.ok()){
+            ph.lnphi = get_lnphi(model, T, ph.rho, p, x);
+        }
+        return ph;
+    }
+
+    /**
+     \brief Solve the Rachford-Rice equation for the vapor fraction, keeping it in the range where all the phase compositions are positive
+     \returns The vapor fraction, or NaN if all the K are larger than one or all are smaller than one
+     */
+    inline double solve_Rachford_Rice(const EArrayd& z, const EArrayd& K, const double beta_guess){
+        const double Kmax = K.maxCoeff(), Kmin = K.minCoeff();
+        if (Kmax <= 1 || Kmin >= 1){
+            return std::nan("");
+        }
+        double lo = 1.0/(1.0 - Kmax), hi = 1.0/(1.0 - Kmin);
+        double beta = (beta_guess > lo && beta_guess < hi) ? beta_guess : (lo + hi)/2;
+        for (auto iter = 0; iter < 100; ++iter){
+            EArrayd Km1 = K - 1.0, denom = 1.0 + beta*Km1;
+            double f = (z*Km1/denom).sum(), dfdbeta = -(z*Km1.square()/denom.square()).sum();
+            // f is decreasing in beta, so the root is bracketed by [lo, hi]
+            if (f > 0){ lo = beta; } else { hi = beta; }
+            double betanew = beta - f/dfdbeta;
+            if (!(betanew > lo && betanew < hi)){
+                betanew = (lo + hi)/2;
+            }
+            if (std::abs(betanew - beta) < 1e-14){
+                return betanew;
+            }
+            beta = betanew;
+        }
+        return beta;
+    }
+
+    /// The result of the stability test
+    struct StabilityResult{
+        bool stable = true;
+        EArrayd K; ///< Estimate of the K factors (y/x) if unstable
+        double rhoL = -1, rhoV = -1; ///< Density estimates of the phases if unstable
+    };
+
+    /**
+     \brief Michelsen's tangent-plane stability test with successive substitution, for a vapor-like and a liquid-like trial phase
+
+     Both trial phases are converged, and the one with the more negative tangent plane distance is retained. Stationary points whose composition
+     satisfies \f$\sum_i \ln^2(w_i/z_i) < 10^{-4}\f$ are considered to be the trivial solution.
+     \param d The vector \f$\ln z_i+\ln\phi_i(z)\f$ of the feed
+     \param K0 The initial K factors used to build the trial phases
+     */
+    inline StabilityResult stability_test(const AbstractModel& model, const double T, const double p, const EArrayd& z, const EArrayd& d, const EArrayd& K0, const double rho_feed, const FlashOptions& opt, int& num_iter){
+        StabilityResult res;
+        double Wsum_best = 1 + 1e-10;
+        for (bool liquid : {false, true}){
+            EArrayd lnW = (liquid) ? (log(z) - log(K0)).eval() : (log(z) + log(K0)).eval();
+            double rho = -1;
+            bool trivial = false;
+            for (auto iter = 0; iter < opt.maxiter_stability; ++iter){
+                ++num_iter;
+                EArrayd W = exp(lnW), w = W/W.sum();
+                auto ph = get_phase(model, T, p, w, liquid, rho);
+                if (!ph.ok()){ break; }
+                rho = ph.rho;
+                EArrayd lnWnew = d - ph.lnphi;
+                double change = (lnWnew - lnW).abs().maxCoeff();
+                lnW = lnWnew;
+                trivial = (log(w/z)).square().sum() < 1e-4 && std::abs(rho - rho_feed) < 1e-2*rho_feed;
+                if (trivial || change < opt.stability_tol){ break; }
+            }
+            EArrayd W = exp(lnW);
+            if (!trivial && rho > 0 && W.sum() > Wsum_best){
+                // Negative tangent plane distance: unstable, so the trial phase is an estimate of the incipient phase
+                EArrayd w = W/W.sum();
+                Wsum_best = W.sum();
+                res.stable = false;
+                res.K = (liquid) ? (z/w).eval() : (w/z).eval();
+                if (liquid){ res.rhoL = rho; res.rhoV = rho_feed; } else { res.rhoV = rho; res.rhoL = rho_feed; }
+            }
+        }
+        return res;
+    }
+
+    /**
+     \brief Newton-Raphson on the full two-phase system in terms of the molar concentrations of both phases and their volumes per mole of feed
+
+     The unknowns are \f$\ln\rho_i'\f$, \f$\ln\rho_i''\f$, \f$V'\f$ and \f$V''\f$, and the equations are the equality of the chemical potentials,
+     the pressure of each phase, and the material balances \f$\rho_i'V'+\rho_i''V''=z_i\f$. All the derivatives are obtained from the residual Helmholtz
+     energy density and its gradient and Hessian with respect to the molar concentrations.
+     */
+    inline bool Newton_two_phase(const AbstractModel& model, const double T, const double p, const EArrayd& z, FlashResult& r, const FlashOptions& opt){
+        const auto N = z.size();
+        const double R = model.get_R(z), RT = R*T;
+        EArrayd lnrhoL = log(r.rhoL*r.x), lnrhoV = log(r.rhoV*r.y);
+        double VL = (1-r.beta)/r.rhoL, VV = r.beta/r.rhoV;
+        Eigen::VectorXd res(2*N+2);
+        Eigen::MatrixXd J(2*N+2, 2*N+2);
+        for (auto iter = 0; iter < opt.maxiter_Newton; ++iter){
+            ++r.num_Newton;
+            EArrayd rhovecL = exp(lnrhoL), rhovecV = exp(lnrhoV);
+            auto [PsirL, gradL, HL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
+            auto [PsirV, gradV, HV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
+            double pL = rhovecL.sum()*RT + (rhovecL*gradL).sum() - PsirL, pV = rhovecV.sum()*RT + (rhovecV*gradV).sum() - PsirV;
+
+            res.head(N) = (lnrhoL + gradL/RT - lnrhoV - gradV/RT).matrix();
+            res(N) = (pL - p)/p;
+            res(N+1) = (pV - p)/p;
+            res.tail(N) = (rhovecL*VL + rhovecV*VV - z).matrix();
+            if (!res.allFinite()){
+                return false;
+            }
+            if (res.cwiseAbs().maxCoeff() < opt.Newton_tol){
+                break;
+            }
+            J.setZero();
+            // Derivatives with respect to ln(rho_j) are rho_j times those with respect to rho_j
+            J.block(0, 0, N, N) = (HL*rhovecL.matrix().asDiagonal())/RT;
+            J.block(0, 0, N, N).diagonal().array() += 1.0;
+            J.block(0, N, N, N) = -(HV*rhovecV.matrix().asDiagonal())/RT;
+            J.block(0, N, N, N).diagonal().array() -= 1.0;
+            J.block(N, 0, 1, N) = ((RT + (rhovecL.matrix().transpose()*HL).array())*rhovecL.transpose())/p;
+            J.block(N+1, N, 1, N) = ((RT + (rhovecV.matrix().transpose()*HV).array())*rhovecV.transpose())/p;
+            J.block(N+2, 0, N, N).diagonal() = (rhovecL*VL).matrix();
+            J.block(N+2, N, N, N).diagonal() = (rhovecV*VV).matrix();
+            J.block(N+2, 2*N, N, 1) = rhovecL.matrix();
+            J.block(N+2, 2*N+1, N, 1) = rhovecV.matrix();
+
+            Eigen::VectorXd dx = J.partialPivLu().solve(-res);
+            if (!dx.allFinite()){
+                return false;
+            }
+            // Limit the step so that the logarithms of the concentrations change by at most 1, and the volumes stay positive
+            double scale = 1.0;
+            double maxdlnrho = dx.head(2*N).cwiseAbs().maxCoeff();
+            if (maxdlnrho > 1.0){ scale = 1.0/maxdlnrho; }
+            if (VL + scale*dx(2*N) <= 0){ scale = std::min(scale, 0.9*VL/(-dx(2*N))); }
+            if (VV + scale*dx(2*N+1) <= 0){ scale = std::min(scale, 0.9*VV/(-dx(2*N+1))); }
+            lnrhoL += scale*dx.head(N).array();
+            lnrhoV += scale*dx.segment(N, N).array();
+            VL += scale*dx(2*N);
+            VV += scale*dx(2*N+1);
+            if (iter == opt.maxiter_Newton-1){
+                return false;
+            }
+        }
+        EArrayd rhovecL = exp(lnrhoL), rhovecV = exp(lnrhoV);
+        r.rhoL = rhovecL.sum(); r.rhoV = rhovecV.sum();
+        r.x = rhovecL/r.rhoL; r.y = rhovecV/r.rhoV;
+        r.beta = VV*r.rhoV;
+        return true;
+    }
+
+    /**
+     \brief Converge a two-phase solution from estimates of the K factors and densities, first with successive substitution and Rachford-Rice, and then with the full Newton system
+     \returns True if a non-trivial solution with both phases present was found
+     */
+    inline bool two_phase(const AbstractModel& model, const double T, const double p, const EArrayd& z, EArrayd K, double rhoL, double rhoV, double beta, const FlashOptions& opt, FlashResult& r){
+        EArrayd x, y;
+        for (auto iter = 0; iter < opt.maxiter_SS; ++iter){
+            ++r.num_SS;
+            beta = solve_Rachford_Rice(z, K, beta);
+            if (!std::isfinite(beta)){
+                return false;
+            }
+            x = z/(1.0 + beta*(K - 1.0)); x /= x.sum();
+            y = K*x; y /= y.sum();
+            auto phL = get_phase(model, T, p, x, true, rhoL), phV = get_phase(model, T, p, y, false, rhoV);
+            if (!phL.ok() || !phV.ok()){
+                return false;
+            }
+            rhoL = phL.rho; rhoV = phV.rho;
+            EArrayd lnKnew = phL.lnphi - phV.lnphi;
+            double change = (lnKnew - log(K)).abs().maxCoeff();
+            K = exp(lnKnew);
+            if (lnKnew.abs().maxCoeff() < 1e-5 || std::abs(rhoL - rhoV) < 1e-8*rhoL){
+                return false; // Converging to the trivial solution
+            }
+            if (change < opt.SS_tol){
+                break;
+            }
+        }
+        beta = solve_Rachford_Rice(z, K, beta);
+        if (!std::isfinite(beta)){
+            return false;
+        }
+        r.x = z/(1.0 + beta*(K - 1.0)); r.x /= r.x.sum();
+        r.y = K*r.x; r.y /= r.y.sum();
+        r.rhoL = rhoL; r.rhoV = rhoV; r.beta = beta;
+        if (beta <= 0 || beta >= 1){
+            return false; // The negative flash indicates a single phase
+        }
+        if (!Newton_two_phase(model, T, p, z, r, opt)){
+            return false;
+        }
+        return r.beta > 0 && r.beta < 1 && (r.x - r.y).abs().maxCoeff() > 1e-8;
+    }
+
+    inline void check_composition(const EArrayd& z){
+        if (z.size() == 0 || (z <= 0).any() || std::abs(z.sum() - 1.0) > 1e-10){
+            throw teqp::InvalidArgument("Mole fractions must all be positive and sum to one");
+        }
+    }
+}
+
+/**
+ \brief Isothermal-isobaric flash
+
+ The steps are:
+ 1. If the guess is a two-phase solution, go straight to step 3 with its K factors and densities
+ 2. The feed is tested for stability with Michelsen's tangent plane analysis; if stable, it is returned as a single phase
+ 3. The phase split is obtained by successive substitution with the Rachford-Rice equation, followed by Newton-Raphson on the full system
+
+ \param model The residual model
+ \param T Temperature, in K
+ \param p Pressure, in Pa
+ \param z Mole fractions of the feed
+ \param opt Options
+ \param guess A previous solution at a nearby state point, used as a warm start
+ */
+inline FlashResult flash_PT(const AbstractModel& model, const double T, const double p, const EArrayd& z, const FlashOptions& opt = {}, const std::optional<FlashResult>& guess = std::nullopt){
+    using namespace internal;
+    check_composition(z);
+    FlashResult r;
+    r.T = T; r.p = p;
+    const bool has_guess = guess && guess->x.size() == z.size() && guess->y.size() == z.size();
+
+    // Warm start from a previous two-phase solution
+    if (has_guess && guess->Nphases == 2){
+        EArrayd K = guess->y/guess->x;
+        if (two_phase(model, T, p, z, K, guess->rhoL, guess->rhoV, guess->beta, opt, r)){
+            r.Nphases = 2; r.success = true;
+            return r;
+        }
+    }
+
+    // The roots of the feed; the one with the lower Gibbs energy is the feed phase
+    double rho_guess = (has_guess && guess->Nphases == 1) ? guess->rhoL : -1;
+    bool guess_liquid = (has_guess && guess->Nphases == 1) ? guess->beta < 0.5 : true;
+    auto phA = get_phase(model, T, p, z, guess_liquid, rho_guess);
+    auto phB = get_phase(model, T, p, z, !guess_liquid, -1);
+    if (!phA.ok() && !phB.ok()){
+        r.message = "Unable to solve for the density of the feed";
+        return r;
+    }
+    bool two_roots = phA.ok() && phB.ok() && std::abs(phA.rho - phB.rho) > 1e-6*std::max(phA.rho, phB.rho);
+    Phase feed = (!phB.ok() || (phA.ok() && (z*phA.lnphi).sum() <= (z*phB.lnphi).sum())) ? phA : phB;
+    const Phase& liq = (two_roots && phB.rho > phA.rho) ? phB : phA;
+    const Phase& vap = (two_roots && phB.rho > phA.rho) ? phA : phB;
+
+    // Estimate of the K factors from the two roots of the feed if there are two, or otherwise from an ideal-gas trial phase
+    EArrayd K0 = (two_roots) ? exp(liq.lnphi - vap.lnphi).eval() : exp(feed.lnphi).eval();
+    EArrayd d = log(z) + feed.lnphi;
+    auto stab = stability_test(model, T, p, z, d, K0, feed.rho, opt, r.num_SS);
+
+    if (!stab.stable && two_phase(model, T, p, z, stab.K, stab.rhoL, stab.rhoV, 0.5, opt, r)){
+        r.Nphases = 2; r.success = true;
+        return r;
+    }
+
+    if (!stab.stable){
+        r.message = "Stability test indicated instability, but no phase split was found";
+        return r;
+    }
+
+    // Single phase
+    r.Nphases = 1;
+    r.rhoL = feed.rho; r.rhoV = feed.rho;
+    r.x = z; r.y = z;
+    // A phase is called vapor-like if it is the lower-density root when there are two roots, or otherwise if its phase identification parameter is less than one
+    r.beta = (two_roots) ? ((feed.rho == vap.rho) ? 1.0 : 0.0) : ((get_phase_identification_parameter(model, T, feed.rho, z) < 1) ? 1.0 : 0.0);
+    r.success = true;
+    return r;
+}
+
+namespace internal {
+
+    /// A molar property of a phase; H, S and U require the ideal-gas model
+    inline double get_phase_property(const char prop, const AbstractModel& model, const AbstractModel* aig, const double T, const double rho, const EArrayd& x){
+        if (prop == 'V'){ return 1.0/rho; }
+        if (aig == nullptr){
+            throw teqp::InvalidArgument("An ideal-gas model is needed for flashes specifying H, S or U");
+        }
+        const double R = model.get_R(x);
+        auto Ar = model.get_Ar_block(1, T, rho, x);
+        auto Aig = aig->get_Ar_block(1, T, rho, x);
+        switch(prop){
+            case 'H': return R*T*(1.0 + Ar(0,1) + Ar(1,0) + Aig(1,0));
+            case 'S': return R*(Ar(1,0) + Aig(1,0) - Ar(0,0) - Aig(0,0));
+            case 'U': return R*T*(Ar(1,0) + Aig(1,0));
+            default: throw teqp::InvalidArgument("Invalid property: " + std::string(1, prop));
+        }
+    }
+
+    /// A molar property of the mixture of phases in a flash solution
+    inline double get_property(const char prop, const AbstractModel& model, const AbstractModel* aig, const FlashResult& r){
+        if (r.Nphases == 1){
+            return get_phase_property(prop, model, aig, r.T, r.rhoL, r.x);
+        }
+        return (1-r.beta)*get_phase_property(prop, model, aig, r.T, r.rhoL, r.x) + r.beta*get_phase_property(prop, model, aig, r.T, r.rhoV, r.y);
+    }
+
+    /**
+     \brief Solve f(x) = 0 with the secant method, falling back to bisection once the root is bracketed and a secant step leaves the bracket
+     \param f The function, which returns NaN on failure
+     \param x0 The initial guess
+     \param dx The initial step
+     \param ftol The convergence criterion on |f|
+     */
+    template<typename Function>
+    double solve_1D(const Function& f, double x0, double dx, const double ftol, const int maxiter, int& num_iter, const double xmin, const double xmax){
+        double fx0 = f(x0);
+        ++num_iter;
+        if (!std::isfinite(fx0)){ return std::nan(""); }
+        if (std::abs(fx0) < ftol){ return x0; }
+        double lo = std::nan(""), hi = std::nan(""); // Values of x where f is negative and positive
+        (fx0 < 0 ? lo : hi) = x0;
+        double x1 = std::clamp(x0 + dx, xmin, xmax);
+        for (auto iter = 0; iter < maxiter; ++iter){
+            double fx1 = f(x1);
+            ++num_iter;
+            if (!std::isfinite(fx1)){
+                // Retreat halfway towards the last good point
+                x1 = (x0 + x1)/2;
+                continue;
+            }
+            if (std::abs(fx1) < ftol){ return x1; }
+            (fx1 < 0 ? lo : hi) = x1;
+            double x2 = x1 - fx1*(x1 - x0)/(fx1 - fx0);
+            const bool bracketed = std::isfinite(lo) && std::isfinite(hi);
+            if (bracketed && !(x2 > std::min(lo, hi) && x2 < std::max(lo, hi))){
+                x2 = (lo + hi)/2;
+            }
+            else if (!bracketed){
+                // Do not take too big a step before the root is bracketed
+                const double maxstep = 4*std::abs(x1 - x0);
+                x2 = std::clamp(x2, x1 - maxstep, x1 + maxstep);
+            }
+            x2 = std::clamp(x2, xmin, xmax);
+            if (x2 == x1){ return x1; }
+            x0 = x1; fx0 = fx1; x1 = x2;
+        }
+        return std::nan("");
+    }
+
+    /// Try to converge a single-phase solution for the specified pair of variables with Newton-Raphson in temperature and density
+    inline bool single_phase_NR(const AbstractModel& model, const AbstractModel* aig, const std::vector<char>& vars, const Eigen::ArrayXd& vals, double& T, double& rho, const EArrayd& z, const FlashOptions& opt, int& num_iter){
+        Eigen::Ref<const Eigen::ArrayXd> rvals = vals, rz = z;
+        teqp::iteration::NRIterator NR(&model, aig, vars, rvals, T, rho, rz);
+        for (auto iter = 0; iter < opt.maxiter_outer; ++iter){
+            ++num_iter;
+            auto [dx, im] = NR.calc_step(T, rho);
+            if (!dx.allFinite()){ return false; }
+            // Damp the step to stay within 20% changes of temperature and density
+            double scale = std::min({1.0, 0.2*T/std::abs(dx(0)), 0.2*rho/std::abs(dx(1))});
+            T += scale*dx(0); rho += scale*dx(1);
+            if (std::abs(dx(0)) < opt.outer_tol*T && std::abs(dx(1)) < opt.outer_tol*rho){
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+/**
+ \brief Flash calculation for any of the supported pairs of specified variables
+
+ The PH, PS, TS and UV flashes first try to converge a single-phase solution with Newton-Raphson in temperature and density (NRIterator) starting
+ from the guess, and accept it if the isothermal-isobaric flash at the solution shows it to be stable. Otherwise, the two-phase solution is found with
+ a one-dimensional outer iteration in temperature (PH, PS), pressure (TS), or temperature with an inner iteration in pressure (UV), each point
+ of which is an isothermal-isobaric flash warm-started from the previous one.
+
+ \param model The residual model
+ \param aig The ideal-gas model, needed for the specifications involving H, S or U
+ \param spec The pair of specified variables
+ \param val1 The first specified value (for PT, PH, PS: p in Pa; TS: T in K; UV: molar internal energy in J/mol)
+ \param val2 The second specified value (for PT: T in K; PH: molar enthalpy in J/mol; PS, TS: molar entropy in J/mol/K; UV: molar volume in m^3/mol)
+ \param z Mole fractions of the feed
+ \param opt Options
+ \param guess A previous solution at a nearby state point, used as a warm start
+ */
+inline FlashResult flash(const AbstractModel& model, const AbstractModel* aig, const FlashSpecification spec, const double val1, const double val2, const EArrayd& z, const FlashOptions& opt = {}, const std::optional<FlashResult>& guess = std::nullopt){
+    using namespace internal;
+    if (spec == FlashSpecification::PT){
+        return flash_PT(model, val2, val1, z, opt, guess);
+    }
+    check_composition(z);
+    if (aig == nullptr){
+        throw teqp::InvalidArgument("An ideal-gas model is needed for flashes specifying H, S or U");
+    }
+
+    // The starting point
+    double T = (guess && guess->T > 0) ? guess->T : opt.T0, p = (guess && guess->p > 0) ? guess->p : opt.p0;
+    if (spec == FlashSpecification::PH || spec == FlashSpecification::PS){ p = val1; }
+    if (spec == FlashSpecification::TS){ T = val1; }
+    std::optional<FlashResult> last = guess;
+    auto r = flash_PT(model, T, p, z, opt, last);
+    if (!r.success){ return r; }
+    last = r;
+    int num_outer = 0;
+
+    // Single-phase attempt
+    std::vector<char> vars;
+    Eigen::ArrayXd vals(2);
+    switch(spec){
+        case FlashSpecification::PH: vars = {'P', 'H'}; vals << val1, val2; break;
+        case FlashSpecification::PS: vars = {'P', 'S'}; vals << val1, val2; break;
+        case FlashSpecification::TS: vars = {'T', 'S'}; vals << val1, val2; break;
+        case FlashSpecification::UV: vars = {'U', 'D'}; vals << val1, 1.0/val2; break;
+        default: throw teqp::InvalidArgument("Invalid flash specification");
+    }
+    if (r.Nphases == 1){
+        double Tsp = T, rhosp = r.rhoL;
+        if (single_phase_NR(model, aig, vars, vals, Tsp, rhosp, z, opt, num_outer) && Tsp > 0 && rhosp > 0){
+            auto [psp, dpdrho] = get_p_dpdrho(model, Tsp, rhosp, z, model.get_R(z));
+            if (psp > 0 && dpdrho > 0){
+                FlashResult g = r; g.rhoL = rhosp; g.rhoV = rhosp;
+                auto rsp = flash_PT(model, Tsp, psp, z, opt, g);
+                if (rsp.success && rsp.Nphases == 1 && std::abs(rsp.rhoL - rhosp) < 1e-6*rhosp){
+                    rsp.num_outer = num_outer;
+                    return rsp;
+                }
+                T = Tsp; p = psp; last = rsp;
+            }
+        }
+    }
+
+    // Outer iterations, each point of which is an isothermal-isobaric flash
+    auto do_flash = [&](double T_, double p_) -> std::optional<FlashResult> {
+        auto rr = flash_PT(model, T_, p_, z, opt, last);
+        if (!rr.success){ return std::nullopt; }
+        last = rr;
+        return rr;
+    };
+    const double R = model.get_R(z);
+    auto residual = [&](const char prop, double spec_val, double scale, double T_, double p_) {
+        auto rr = do_flash(T_, p_);
+        return (rr) ? (get_property(prop, model, aig, rr.value()) - spec_val)/scale : std::nan("");
+    };
+
+    double sol = std::nan("");
+    switch(spec){
+        case FlashSpecification::PH:
+            sol = solve_1D([&](double T_){ return residual('H', val2, R*T_, T_, p); }, T, 0.01*T, opt.outer_tol, opt.maxiter_outer, num_outer, 1e-3, 1e5);
+            break;
+        case FlashSpecification::PS:
+            sol = solve_1D([&](double T_){ return residual('S', val2, R, T_, p); }, T, 0.01*T, opt.outer_tol, opt.maxiter_outer, num_outer, 1e-3, 1e5);
+            break;
+        case FlashSpecification::TS:
+            // Entropy decreases with pressure, so iterate in -ln(p) to keep the function increasing
+            sol = solve_1D([&](double mlnp){ return residual('S', val2, R, T, exp(-mlnp)); }, -log(p), 0.05, opt.outer_tol, opt.maxiter_outer, num_outer, -log(1e12), -log(1e-6));
+            break;
+        case FlashSpecification::UV: {
+            // For each temperature, find the pressure yielding the specified molar volume (v decreases with p)
+            auto p_of_T = [&](double T_){
+                double mlnp0 = (last) ? -log(last->p) : -log(p);
+                int num_inner = 0;
+                double mlnp = solve_1D([&](double mlnp_){ return residual('V', val2, val2, T_, exp(-mlnp_)); }, mlnp0, 0.05, opt.outer_tol, opt.maxiter_outer, num_inner, -log(1e12), -log(1e-6));
+                num_outer += num_inner;
+                return exp(-mlnp);
+            };
+            sol = solve_1D([&](double T_){
+                double p_ = p_of_T(T_);
+                return (std::isfinite(p_)) ? residual('U', val1, R*T_, T_, p_) : std::nan("");
+            }, T, 0.01*T, opt.outer_tol, opt.maxiter_outer, num_outer, 1e-3, 1e5);
+            break;
+        }
+        default:
+            throw teqp::InvalidArgument("Invalid flash specification");
+    }
+    if (!std::isfinite(sol) || !last){
+        FlashResult fail;
+        fail.message = "Outer iteration of the flash did not converge";
+        fail.num_outer = num_outer;
+        return fail;
+    }
+    // The last isothermal-isobaric flash is the one at the solution
+    FlashResult out = last.value();
+    out.num_outer = num_outer;
+    return out;
+}
+
+}
+}
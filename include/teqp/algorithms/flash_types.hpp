@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <Eigen/Dense>
+
+namespace teqp{
+namespace flash{
+
+/// The pair of variables that are specified in a flash calculation
+enum class FlashSpecification { PT, PH, PS, TS, UV };
+
+struct FlashOptions {
+    double SS_tol = 1e-6, ///< Switch from successive substitution to the full Newton system once the change in ln(K) is smaller than this
+    Newton_tol = 1e-10, ///< Tolerance on the largest residual of the full Newton system
+    stability_tol = 1e-10, ///< Tolerance on the change in ln(W) in the stability test
+    outer_tol = 1e-10, ///< Relative tolerance on the specified state function(s) in the PH, PS, TS and UV flashes
+    T0 = 300, ///< Initial temperature, in K, for the PH, PS and UV flashes if no guess is provided
+    p0 = 101325; ///< Initial pressure, in Pa, for the TS and UV flashes if no guess is provided
+    int maxiter_SS = 200, maxiter_Newton = 30, maxiter_stability = 100, maxiter_outer = 100;
+};
+
+struct FlashResult {
+    bool success = false;
+    std::string message = "";
+    int Nphases = 0; ///< The number of phases, 1 or 2
+    double T = -1, ///< Temperature, in K
+    p = -1, ///< Pressure, in Pa
+    beta = -1, ///< Molar fraction of the vapor-like phase; for one phase, 0 if it is liquid-like, and 1 if it is vapor-like
+    rhoL = -1, ///< Molar density of the liquid-like phase, in mol/m^3 (for one phase, both densities are that of the phase)
+    rhoV = -1; ///< Molar density of the vapor-like phase, in mol/m^3
+    Eigen::ArrayXd x, ///< Mole fractions of the liquid-like phase
+    y; ///< Mole fractions of the vapor-like phase
+    int num_SS = 0, num_Newton = 0, num_outer = 0;
+};
+
+}
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+namespace parallel {
+
+using namespace cppinterface;
+
+/**
+ A pool of worker threads that evaluates a range of indices in parallel with work stealing
+
+ The range is split into chunks and the chunks are dealt out evenly to one queue per worker. Each worker
+ takes chunks from the front of its own queue, and when it runs dry, steals chunks from the back of the
+ queues of the other workers. Work is only ever written by index, so the output is deterministic
+ irrespective of which thread evaluates which chunk.
+
+ The thread calling parallel_for also acts as the first worker, so a pool with one thread runs everything
+ inline on the calling thread.
+ */
+class WorkStealingPool{
+private:
+    /// The chunk indices in [begin, end) that are still waiting to be evaluated by (or stolen from) a worker
+    struct ChunkQueue{
+        std::mutex m;
+        std::size_t begin = 0, end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<ChunkQueue>> queues;
+
+    std::mutex call_mutex; ///< Only one parallel_for can be active at a time
+    std::mutex m;
+    std::condition_variable cv_start, cv_done;
+    std::size_t generation = 0, remaining = 0;
+    bool stopping = false;
+
+    // The current job
+    std::function<void(std::size_t, std::size_t)> job;
+    std::size_t Nitems = 0, chunk_size = 1;
+    std::atomic<bool> abort{false};
+    std::exception_ptr error;
+
+    /// Pop a chunk from the front of the given queue (the owner) or the back (a thief)
+    bool pop_chunk(ChunkQueue& q, bool front, std::size_t& ichunk){
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.begin >= q.end){ return false; }
+        ichunk = (front) ? q.begin++ : --q.end;
+        return true;
+    }
+
+    /// Evaluate chunks until there are none left in any queue
+    void work(std::size_t iworker){
+        const auto Nqueues = queues.size();
+        std::size_t ichunk;
+        while (!abort){
+            bool found = pop_chunk(*queues[iworker], true, ichunk);
+            for (std::size_t j = 1; !found && j < Nqueues; ++j){
+                found = pop_chunk(*queues[(iworker + j) % Nqueues], false, ichunk);
+            }
+            if (!found){ return; }
+            try{
+                auto begin = ichunk*chunk_size;
+                job(begin, std::min(begin + chunk_size, Nitems));
+            }
+            catch(...){
+                std::lock_guard<std::mutex> lock(m);
+                if (!error){ error = std::current_exception(); }
+                abort = true;
+            }
+        }
+    }
+
+    void worker_loop(std::size_t iworker){
+        std::size_t seen = 0;
+        while (true){
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv_start.wait(lock, [&]{ return stopping || generation != seen; });
+                if (stopping){ return; }
+                seen = generation;
+            }
+            work(iworker);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (--remaining == 0){ cv_done.notify_one(); }
+            }
+        }
+    }
+
+public:
+    /// \param Nthreads The number of threads (including the calling thread); if 0, the hardware concurrency is used
+    explicit WorkStealingPool(std::size_t Nthreads = 0){
+        if (Nthreads == 0){
+            Nthreads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        for (std::size_t i = 0; i < Nthreads; ++i){
+            queues.emplace_back(std::make_unique<ChunkQueue>());
+        }
+        for (std::size_t i = 1; i < Nthreads; ++i){
+            threads.emplace_back(&WorkStealingPool::worker_loop, this, i);
+        }
+    }
+    ~WorkStealingPool(){
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv_start.notify_all();
+        for (auto& t : threads){ t.join(); }
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// The number of threads, including the calling thread
+    std::size_t get_Nthreads() const { return queues.size(); }
+
+    /**
+     \brief Call f(begin, end) for contiguous sub-ranges that together cover [0, N), blocking until all are complete
+
+     The first exception thrown by f is rethrown in the calling thread once all the workers have stopped
+     \param N The number of items
+     \param chunk The number of items in each chunk
+     \param f The function to be called for each chunk
+     */
+    void parallel_for(std::size_t N, std::size_t chunk, const std::function<void(std::size_t, std::size_t)>& f){
+        if (chunk == 0){
+            throw teqp::InvalidArgument("chunk size must be greater than zero");
+        }
+        if (N == 0){ return; }
+        std::lock_guard<std::mutex> call_lock(call_mutex);
+        const std::size_t Nchunks = (N + chunk - 1)/chunk, Nqueues = queues.size();
+        {
+            std::lock_guard<std::mutex> lock(m);
+            job = f; Nitems = N; chunk_size = chunk;
+            abort = false; error = nullptr;
+            // Deal out the chunks evenly, so that stealing is only needed to balance uneven cost
+            for (std::size_t i = 0; i < Nqueues; ++i){
+                std::lock_guard<std::mutex> qlock(queues[i]->m);
+                queues[i]->begin = Nchunks*i/Nqueues;
+                queues[i]->end = Nchunks*(i+1)/Nqueues;
+            }
+            remaining = threads.size();
+            ++generation;
+        }
+        cv_start.notify_all();
+        work(0);
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv_done.wait(lock, [&]{ return remaining == 0; });
+            job = nullptr;
+        }
+        if (error){
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+/// The options for the parallel batch evaluators
+struct BatchOptions{
+    std::size_t chunk_size = 256; ///< The number of state points in each unit of work
+};
+
+/**
+ \brief Parallel version of AbstractModel::get_Arxy_many
+
+ The state points are split into chunks, and each chunk is passed to the batched function of the model, so
+ the model is only required to be safe for concurrent calls of const methods, as are all the models built by make_model
+ */
+inline void get_Arxy_many(WorkStealingPool& pool, const AbstractModel& model, const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEArrayd out, const BatchOptions& opt = {}){
+    if (rho.size() != T.size() || molefracs.rows() != T.size() || out.size() != T.size()){
+        throw teqp::InvalidArgument("Lengths of batch inputs and outputs must all be equal to the length of T");
+    }
+    pool.parallel_for(T.size(), opt.chunk_size, [&](std::size_t begin, std::size_t end){
+        const auto n = static_cast<Eigen::Index>(end - begin), b = static_cast<Eigen::Index>(begin);
+        model.get_Arxy_many(NT, ND, T.segment(b, n), rho.segment(b, n), molefracs.middleRows(b, n), out.segment(b, n));
+    });
+}
+
+/// Parallel version of AbstractModel::get_Ar0n_many
+inline void get_Ar0n_many(WorkStealingPool& pool, const AbstractModel& model, const int Nderiv, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEMatrixd out, const BatchOptions& opt = {}){
+    if (rho.size() != T.size() || molefracs.rows() != T.size() || out.rows() != T.size()){
+        throw teqp::InvalidArgument("Lengths of batch inputs and outputs must all be equal to the length of T");
+    }
+    pool.parallel_for(T.size(), opt.chunk_size, [&](std::size_t begin, std::size_t end){
+        const auto n = static_cast<Eigen::Index>(end - begin), b = static_cast<Eigen::Index>(begin);
+        model.get_Ar0n_many(Nderiv, T.segment(b, n), rho.segment(b, n), molefracs.middleRows(b, n), out.middleRows(b, n));
+    });
+}
+
+/// Parallel version of AbstractModel::get_fugacity_coefficients_many
+inline void get_fugacity_coefficients_many(WorkStealingPool& pool, const AbstractModel& model, const REArrayd& T, const REMatrixd& rhovecs, WEMatrixd out, const BatchOptions& opt = {}){
+    if (rhovecs.rows() != T.size() || out.rows() != T.size()){
+        throw teqp::InvalidArgument("Lengths of batch inputs and outputs must all be equal to the length of T");
+    }
+    pool.parallel_for(T.size(), opt.chunk_size, [&](std::size_t begin, std::size_t end){
+        const auto n = static_cast<Eigen::Index>(end - begin), b = static_cast<Eigen::Index>(begin);
+        model.get_fugacity_coefficients_many(T.segment(b, n), rhovecs.middleRows(b, n), out.middleRows(b, n));
+    });
+}
+
+}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/algorithms/rho_Tp_types.hpp"
+
+namespace teqp {
+namespace rho_Tp {
+
+    using namespace cppinterface;
+
+    /**
+     The pressure and its first two derivatives with respect to molar density at constant temperature and composition, all from one evaluation of the
+     derivatives \f$\Lambda^{\rm r}_{0n}\f$ for \f$n \leq 3\f$:
+     \f[ p = \rho RT(1+\Lambda^{\rm r}_{01}),\quad \frac{\partial p}{\partial\rho} = RT(1+2\Lambda^{\rm r}_{01}+\Lambda^{\rm r}_{02}),\quad \frac{\partial^2 p}{\partial\rho^2} = \frac{RT}{\rho}(2\Lambda^{\rm r}_{01}+4\Lambda^{\rm r}_{02}+\Lambda^{\rm r}_{03}) \f]
+     All are NaN if \f$\alpha^{\rm r}\f$ itself is not finite
+     */
+    inline auto get_p_derivs(const AbstractModel& model, const double T, const double rho, const REArrayd& x, const double R){
+        auto Ar0n = model.get_Ar03n(T, rho, x);
+        if (!std::isfinite(Ar0n[0])){
+            return std::make_tuple(std::nan(""), std::nan(""), std::nan(""));
+        }
+        const double RT = R*T;
+        return std::make_tuple(rho*RT*(1.0 + Ar0n[1]), RT*(1.0 + 2.0*Ar0n[1] + Ar0n[2]), RT/rho*(2.0*Ar0n[1] + 4.0*Ar0n[2] + Ar0n[3]));
+    }
+
+    /**
+     \brief Solve for the molar density on the liquid-like or vapor-like branch at given temperature, pressure and composition
+     
+     The root is kept in a bracket that shrinks with each evaluation, and Halley steps are taken within the bracket (bisection if a step would leave it).
+     A density is on the high side of the root if it is beyond close packing or the pressure is too large, and mechanically unstable states are
+     on the low side for the liquid-like branch and on the high side for the vapor-like branch.
+     
+     Without a guess, the vapor-like root is approached from the ideal-gas density, and the liquid-like root from above, after
+     marching up in density (by 25% per step) until the pressure is larger than the specified one on a branch where \f$d\ln p/d\ln\rho > 1\f$.
+     Only mechanically stable roots are returned
+     \returns The density, or NaN if no root was found on the desired branch
+     */
+    inline double solve_rho_branch(const AbstractModel& model, const double T, const double p, const REArrayd& x, const bool liquid, const double R, const double rho_guess = -1, const int maxiter = 100){
+        auto is_high = [&](const double pr, const double dpdrho){
+            if (!std::isfinite(pr) || !std::isfinite(dpdrho)){ return true; }
+            if (dpdrho <= 0){ return !liquid; }
+            return pr > p;
+        };
+        double lo = 0, hi = -1; // hi < 0 until a density on the high side has been found
+        double rho = (rho_guess > 0) ? rho_guess : p/(R*T);
+        
+        if (liquid){
+            // Modest steps, so that the pole at close packing of models like the cubics is not jumped over. The stable vapor-like
+            // states with too large a pressure are passed over, and are not a lower bound for the liquid-like root
+            for (auto i = 0; i < 200; ++i){
+                auto [pr, dpdrho, d2pdrho2] = get_p_derivs(model, T, rho, x, R);
+                if (is_high(pr, dpdrho) && (!std::isfinite(pr) || dpdrho*rho > pr)){ hi = rho; break; }
+                if (!is_high(pr, dpdrho)){ lo = rho; }
+                rho *= 1.25;
+            }
+            if (hi < 0){ return std::nan(""); }
+        }
+        for (auto iter = 0; iter < maxiter; ++iter){
+            auto [pr, dpdrho, d2pdrho2] = get_p_derivs(model, T, rho, x, R);
+            if (is_high(pr, dpdrho)){ hi = rho; } else { lo = rho; }
+            
+            double rhonew = std::nan("");
+            const bool stable = std::isfinite(pr) && std::isfinite(dpdrho) && dpdrho > 0;
+            if (stable){
+                const double f = pr - p, den = 2*dpdrho*dpdrho - f*d2pdrho2;
+                rhonew = rho + ((std::isfinite(d2pdrho2) && den > 0) ? -2*f*dpdrho/den : -f/dpdrho);
+                if (std::abs(rhonew - rho) < 1e-13*rho){
+                    // For liquids at low pressure, the pressure is a small difference between terms of order rho*R*T
+                    return (std::abs(f) < 1e-8*std::max(p, rho*R*T)) ? rhonew : std::nan("");
+                }
+            }
+            if (hi < 0){
+                // No upper bound yet (vapor-like branch), so limit the growth
+                rho = (std::isfinite(rhonew) && rhonew > lo) ? std::min(rhonew, 2*rho) : 2*rho;
+            }
+            else {
+                rho = (std::isfinite(rhonew) && rhonew > lo && rhonew < hi) ? rhonew : (lo + hi)/2;
+                if (hi - lo < 1e-14*hi){
+                    return std::nan(""); // The bracket has collapsed without converging, e.g., at a spinodal
+                }
+            }
+        }
+        return std::nan("");
+    }
+
+    /**
+     Select between the largest and smallest mechanically stable densities (which may be the same root or NaN if it does not exist) for the given hint
+     \param gr_RT Callable returning the residual Gibbs energy over RT at a root, used to compare the roots in the stable case
+     */
+    template<typename GibbsFunction>
+    double select_root(const PhaseHint hint, const double rhoL, const double rhoV, const GibbsFunction& gr_RT){
+        const bool okL = std::isfinite(rhoL) && rhoL > 0, okV = std::isfinite(rhoV) && rhoV > 0;
+        if (!okL || !okV){
+            return (okL) ? rhoL : rhoV;
+        }
+        switch (hint){
+            case PhaseHint::liquid: return std::max(rhoL, rhoV);
+            case PhaseHint::vapor: return std::min(rhoL, rhoV);
+            default:
+                if (std::abs(rhoL - rhoV) <= 1e-12*rhoL){ return rhoL; }
+                return (gr_RT(rhoL) < gr_RT(rhoV)) ? rhoL : rhoV;
+        }
+    }
+
+    /// The residual Gibbs energy over RT at a root of the density at given temperature and pressure, \f$g^{\rm r}/(RT) = \alpha^{\rm r} + Z - 1 - \ln Z\f$
+    inline double get_gr_RT(const AbstractModel& model, const double T, const double rho, const double p, const REArrayd& x, const double R){
+        const double Z = p/(rho*R*T);
+        return model.get_Ar00(T, rho, x) + Z - 1.0 - log(Z);
+    }
+}
+
+/**
+ \brief Solve for the molar density at given temperature, pressure and composition, for any model
+ 
+ The liquid-like and vapor-like branches are each solved with rho_Tp::solve_rho_branch, as needed for the hint
+ \returns The molar density, or NaN if no root was found
+ */
+inline double solve_rho_Tp(const cppinterface::AbstractModel& model, const double T, const double p, const REArrayd& z, const PhaseHint hint){
+    if (!(p > 0)){
+        throw teqp::InvalidArgument("Pressure must be positive to solve for the density");
+    }
+    const double R = model.get_R(z);
+    const double nan = std::nan("");
+    double rhoL = (hint != PhaseHint::vapor) ? rho_Tp::solve_rho_branch(model, T, p, z, true, R) : nan;
+    double rhoV = (hint != PhaseHint::liquid || !std::isfinite(rhoL)) ? rho_Tp::solve_rho_branch(model, T, p, z, false, R) : nan;
+    if (hint == PhaseHint::vapor && !std::isfinite(rhoV)){
+        rhoL = rho_Tp::solve_rho_branch(model, T, p, z, true, R);
+    }
+    auto gr_RT = [&](const double rho){ return rho_Tp::get_gr_RT(model, T, rho, p, z, R); };
+    return rho_Tp::select_root(hint, rhoL, rhoV, gr_RT);
+}
+
+}
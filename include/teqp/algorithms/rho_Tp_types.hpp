@@ -0,0 +1,12 @@
+#pragma once
+
+namespace teqp{
+
+/// Which of the roots for the density at given temperature and pressure is desired
+enum class PhaseHint {
+    liquid, ///< The largest mechanically stable density (or the only root if there is only one)
+    vapor, ///< The smallest mechanically stable density (or the only root if there is only one)
+    stable ///< The root with the lowest Gibbs energy
+};
+
+}
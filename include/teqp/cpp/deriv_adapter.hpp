@@ -3,6 +3,7 @@
 #include "teqp/derivs.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/algorithms/rho_Tp.hpp"
 
 namespace teqp{
 namespace cppinterface{
@@ -33,6 +34,12 @@ public:
 
 namespace internal{
     template<class T>struct tag{using type=T;};
+    
+    /// True if the model provides the closed-form roots for the density at given temperature and pressure (as the cubics do)
+    template<typename Model, typename = void>
+    struct has_rho_Tp_roots : std::false_type {};
+    template<typename Model>
+    struct has_rho_Tp_roots<Model, std::void_t<decltype(std::declval<const Model&>().get_rho_Tp_roots(1.0, 1.0, std::declval<const EArrayd&>()))>> : std::true_type {};
 }
 
 /**
@@ -44,6 +51,14 @@ template<typename ModelPack>
 class DerivativeAdapter : public teqp::cppinterface::AbstractModel{
 private:
     ModelPack mp;
+    
+    /// Check that the inputs to the batched functions are all of a consistent length
+    static void check_batch_sizes(const REArrayd& T, const Eigen::Index Nrho, const REMatrixd& compositions, const Eigen::Index Nout){
+        const auto N = T.size();
+        if (Nrho != N || compositions.rows() != N || Nout != N){
+            throw teqp::InvalidArgument("Lengths of batch inputs and outputs must all be equal to the length of T: " + std::to_string(N));
+        }
+    }
 public:
     auto& get_ModelPack_ref(){ return mp; }
     const auto& get_ModelPack_cref() const { return mp; }
@@ -78,6 +93,66 @@ public:
     AR0N_args
 #undef X
     
+    // The batched functions resolve the runtime derivative orders once, and then the loop over
+    // the state points is carried out with the concrete model type
+    virtual void get_Arxy_many(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEArrayd out) const override {
+        check_batch_sizes(T, rho.size(), molefracs, out.size());
+        using tdx = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>;
+        const auto& model = mp.get_cref();
+        EArrayd z(molefracs.cols()); // Reused for each state point
+#define X(i,j) if (NT == i && ND == j){ for (auto k = 0; k < T.size(); ++k){ z = molefracs.row(k).transpose(); out[k] = tdx::template get_Arxy<i,j>(model, T[k], rho[k], z); } return; }
+        ARXY_args
+#undef X
+        throw teqp::InvalidArgument("Invalid combination of NT and ND: " + std::to_string(NT) + "," + std::to_string(ND));
+    };
+    virtual void get_Ar0n_many(const int Nderiv, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEMatrixd out) const override {
+        check_batch_sizes(T, rho.size(), molefracs, out.rows());
+        if (out.cols() < Nderiv+1){
+            throw teqp::InvalidArgument("Output buffer must have at least Nderiv+1 columns");
+        }
+        using tdx = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>;
+        const auto& model = mp.get_cref();
+        EArrayd z(molefracs.cols());
+#define X(i) if (Nderiv == i){ for (auto k = 0; k < T.size(); ++k){ z = molefracs.row(k).transpose(); auto vals = tdx::template get_Ar0n<i>(model, T[k], rho[k], z); for (auto n = 0; n <= i; ++n){ out(k, n) = vals[n]; } } return; }
+        AR0N_args
+#undef X
+        throw teqp::InvalidArgument("Invalid value for Nderiv: " + std::to_string(Nderiv));
+    };
+    virtual void get_fugacity_coefficients_many(const REArrayd& T, const REMatrixd& rhovecs, WEMatrixd out) const override {
+        check_batch_sizes(T, T.size(), rhovecs, out.rows());
+        if (out.cols() != rhovecs.cols()){
+            throw teqp::InvalidArgument("Output buffer must have one column per component");
+        }
+        using iso = IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>;
+        const auto& model = mp.get_cref();
+        EArrayd rhovec(rhovecs.cols());
+        for (auto k = 0; k < T.size(); ++k){
+            rhovec = rhovecs.row(k).transpose();
+            out.row(k) = iso::get_fugacity_coefficients(model, T[k], rhovec).transpose();
+        }
+    };
+    
+    virtual double solve_rho_Tp(const double T, const double p, const REArrayd& z, const PhaseHint hint) const override {
+        using Model = std::decay_t<decltype(mp.get_cref())>;
+        if constexpr (internal::has_rho_Tp_roots<Model>::value){
+            if (!(p > 0)){
+                throw teqp::InvalidArgument("Pressure must be positive to solve for the density");
+            }
+            const auto& model = mp.get_cref();
+            const EArrayd x = z;
+            const auto roots = model.get_rho_Tp_roots(T, p, x);
+            if (roots.empty()){
+                return std::nan("");
+            }
+            const double R = model.R(x);
+            auto gr_RT = [&](const double rho){ const double Z = p/(rho*R*T); return model.alphar(T, rho, x) + Z - 1.0 - log(Z); };
+            return rho_Tp::select_root(hint, roots.back(), roots.front(), gr_RT);
+        }
+        else{
+            return AbstractModel::solve_rho_Tp(T, p, z, hint);
+        }
+    };
+    
     // Virial derivatives
     virtual double get_B2vir(const double T, const EArrayd& z) const override {
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_B2vir(mp.get_cref(), T, z);
@@ -109,7 +184,18 @@ public:
         return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Psir_sigma_derivs(mp.get_cref(), T, rhovec, v);
     };
     
-    virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const override { throw teqp::NotImplementedError("Not available"); };
+    virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const override {
+        // Ideal-gas models also implement alphar (redirecting to alphaig), so the same residual derivatives serve for both
+        return DerivativeHolderSquare<2, AlphaWrapperOption::residual>(mp.get_cref(), T, rho, z).derivs;
+    };
+    virtual EMatrixd get_Ar_block(const int Nmax, const double T, const double rho, const REArrayd& molefrac) const override {
+        using tdx = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>;
+        switch(Nmax){
+            case 1: return tdx::template get_Ar_block<1,1>(mp.get_cref(), T, rho, molefrac);
+            case 2: return tdx::template get_Ar_block<2,2>(mp.get_cref(), T, rho, molefrac);
+            default: throw teqp::InvalidArgument("Nmax must be 1 or 2, was " + std::to_string(Nmax));
+        }
+    };
 };
 
 template<typename TemplatedModel> auto view(const TemplatedModel& tp){
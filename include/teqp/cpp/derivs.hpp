@@ -77,6 +77,23 @@ auto build_iteration_Jv(const std::vector<char>& vars, const Eigen::Array<double
                 J(i, 0) = (Trecip*Trecip*d2adTrecip2() + 2*Trecip*dadTrecip())*dTrecipdT;
                 J(i, 1) = Trecip*Trecip*d2adTrecipdrho();
                 break;
+            case 'U':
+            case 'H':{
+                // u = a + T*s, so du/dT = T*ds/dT and du/drho = da/drho + T*ds/drho
+                double a = R*alpha()/Trecip, s = Trecip*Trecip*dadTrecip();
+                double dsdT = (Trecip*Trecip*d2adTrecip2() + 2*Trecip*dadTrecip())*dTrecipdT, dsdrho = Trecip*Trecip*d2adTrecipdrho();
+                v(i) = a + T*s;
+                J(i, 0) = T*dsdT;
+                J(i, 1) = dadrho() + T*dsdrho;
+                if (vars[i] == 'H'){
+                    // h = u + p/rho
+                    double p = rho*R*T*(1 + Ar(0,1));
+                    v(i) += p/rho;
+                    J(i, 0) += R*(1 + Ar(0,1) - Ar(1,1));
+                    J(i, 1) += R*T*(1 + 2*Ar(0,1) + Ar(0,2))/rho - p/(rho*rho);
+                }
+                break;
+            }
             default:
                 throw std::invalid_argument("bad var: " + std::to_string(vars[i]));
         }
@@ -11,6 +11,8 @@
 #include "teqp/algorithms/critical_tracing_types.hpp"
 #include "teqp/algorithms/VLE_types.hpp"
 #include "teqp/algorithms/VLLE_types.hpp"
+#include "teqp/algorithms/flash_types.hpp"
+#include "teqp/algorithms/rho_Tp_types.hpp"
 
 using EArray2 = Eigen::Array<double, 2, 1>;
 using EArrayd = Eigen::ArrayX<double>;
@@ -18,6 +20,8 @@ using EArray33d = Eigen::Array<double, 3, 3>;
 using REArrayd = Eigen::Ref<const EArrayd>;
 using EMatrixd = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>;
 using REMatrixd = Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>>;
+using WEArrayd = Eigen::Ref<EArrayd>;
+using WEMatrixd = Eigen::Ref<EMatrixd>;
 
 #define ARXY_args \
     X(0,0) \
@@ -65,7 +69,8 @@ using REMatrixd = Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::D
     X(build_Psi_Hessian_autodiff)
 
 #define ISOCHORIC_multimatrix_args \
-    X(build_Psir_fgradHessian_autodiff)
+    X(build_Psir_fgradHessian_autodiff) \
+    X(build_Psi_fgradHessian_autodiff)
     
 namespace teqp {
     namespace cppinterface {
@@ -85,10 +90,18 @@ namespace teqp {
          
         */
         class AbstractModel {
+        private:
+            nlohmann::json spec; ///< The specification the model was built from, null if it was not built by make_model
         public:
             
             virtual ~AbstractModel() = default;
             
+            void set_spec(nlohmann::json j){ spec = std::move(j); }
+            /// The specification (with "kind" and "model" fields) the model was built from, as it was passed to make_model
+            const nlohmann::json& get_spec() const { return spec; }
+            /// Write the specification of the model in CBOR to file, with the data in the files it refers to pulled in, so that make_model_from_exported_spec can rebuild the model without those files
+            void export_spec(const std::string& path) const;
+            
             virtual const std::type_index& get_type_index() const = 0;
             
             virtual double get_R(const EArrayd&) const = 0;
@@ -105,6 +118,17 @@ namespace teqp {
                 AR0N_args
             #undef X
             
+            /**
+             Batched versions of the derivative functions. Each entry in T and rho (and each row in the matrix of mole fractions or molar concentrations)
+             defines one state point, and the results are written into the buffer provided by the caller, which must already be sized appropriately.
+             The loop over the state points is carried out inside the model wrapper, so the virtual function call and the lookup of the derivative
+             orders are only paid once per batch rather than once per state point.
+             */
+            virtual void get_Arxy_many(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEArrayd out) const = 0;
+            /// Batched version of get_Ar0Nn; the output matrix has one row per state point, and at least Nderiv+1 columns
+            virtual void get_Ar0n_many(const int Nderiv, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, WEMatrixd out) const = 0;
+            /// Batched version of get_fugacity_coefficients; each row of rhovecs and of the output matrix is a state point
+            virtual void get_fugacity_coefficients_many(const REArrayd& T, const REMatrixd& rhovecs, WEMatrixd out) const = 0;
             
             // Virial derivatives
             virtual double get_B2vir(const double T, const EArrayd& z) const = 0;
@@ -129,7 +153,10 @@ namespace teqp {
             
             double get_neff(const double, const double, const EArrayd&) const;
             
+            /// The derivatives Ar_{ij} for i+j <= 2 and Ar11, from the three passes of DerivativeHolderSquare; the other entries are zero
             virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const = 0;
+            /// All the residual derivatives Ar_{ij} for i,j <= Nmax (Nmax of 1 or 2) from one evaluation of alphar with nested dual numbers; element (i,j) of the matrix is Ar_{ij}
+            virtual EMatrixd get_Ar_block(const int Nmax, const double T, const double rho, const REArrayd& molefrac) const = 0;
             
             std::tuple<double, double> solve_pure_critical(const double T, const double rho, const std::optional<nlohmann::json>& = std::nullopt) const ;
             EArray2 extrapolate_from_critical(const double Tc, const double rhoc, const double Tgiven) const;
@@ -152,6 +179,23 @@ namespace teqp {
             std::vector<nlohmann::json> find_VLLE_p_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options = std::nullopt) const;
             nlohmann::json trace_VLLE_binary(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const;
             
+            /**
+             \brief Flash calculation for a pair of specified variables, see teqp::flash::flash for the details
+             \param aig The ideal-gas model, only needed for the specifications involving H, S or U
+             \param guess A previous solution at a nearby state point, used as a warm start
+             */
+            teqp::flash::FlashResult flash(const teqp::flash::FlashSpecification spec, const double val1, const double val2, const REArrayd& z, const AbstractModel* aig = nullptr, const std::optional<teqp::flash::FlashOptions>& options = std::nullopt, const std::optional<teqp::flash::FlashResult>& guess = std::nullopt) const;
+            
+            /**
+             \brief The molar density at given temperature, pressure and composition, see teqp::solve_rho_Tp
+             
+             Models with a closed-form solution for the roots (the cubics) override this method
+             \returns The molar density, or NaN if no root was found
+             */
+            virtual double solve_rho_Tp(const double T, const double p, const REArrayd& z, const PhaseHint hint = PhaseHint::stable) const;
+            /// Batched version of solve_rho_Tp; each entry in T and p (and each row of molefracs) is a state point
+            void solve_rho_Tp_many(const REArrayd& T, const REArrayd& p, const REMatrixd& molefracs, const PhaseHint hint, WEArrayd out) const;
+            
             virtual nlohmann::json trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& = std::nullopt, const std::optional<TCABOptions> & = std::nullopt) const;
             virtual EArrayd get_drhovec_dT_crit(const double T, const REArrayd& rhovec) const;
             virtual double get_dp_dT_crit(const double T, const REArrayd& rhovec) const;
@@ -163,6 +207,9 @@ namespace teqp {
         
         // Generic JSON-based interface where the model description is encoded as JSON
         std::unique_ptr<AbstractModel> make_model(const nlohmann::json &, bool validate = true);
+        
+        /// Build a model from a specification that was written by AbstractModel::export_spec
+        std::unique_ptr<AbstractModel> make_model_from_exported_spec(const std::string& path);
 
         // Expose specialized factory functions for different models
         // Mostly these are just adapter functions that prepare some
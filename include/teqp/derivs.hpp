@@ -7,6 +7,7 @@
 
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/math/hessian_dual.hpp"
 
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
 #include "MultiComplex/MultiComplex.hpp"
@@ -86,6 +87,35 @@ struct wrt_helper {
     }
 };
 
+/**
+ Build a nested dual number of N levels with value x whose derivative part is one at the levels (counted from the
+ outermost level) whose bits are set in mask, and zero at the other levels. Each level is a distinct infinitesimal, so
+ seeding two variables at disjoint sets of levels yields all the mixed partial derivatives from one evaluation
+ */
+template<int N, typename Scalar>
+auto make_nested_dual(const Scalar& x, unsigned int mask, int level = 0){
+    if constexpr (N == 0){
+        return x;
+    }
+    else{
+        autodiff::HigherOrderDual<N, Scalar> d;
+        d.val = make_nested_dual<N-1>(x, mask, level+1);
+        d.grad = (mask & (1u << level)) ? 1.0 : 0.0;
+        return d;
+    }
+}
+
+/// Extract the coefficient of a nested dual number that multiplies the infinitesimals of the levels whose bits are set in mask
+template<typename Dual>
+auto get_nested_dual_coeff(const Dual& d, unsigned int mask, int level = 0){
+    if constexpr (std::is_arithmetic_v<Dual>){
+        return d;
+    }
+    else{
+        return get_nested_dual_coeff((mask & (1u << level)) ? d.grad : d.val, mask, level+1);
+    }
+}
+
 enum class AlphaWrapperOption {residual, idealgas};
 /**
 * \brief This class is used to wrap a model that exposes the generic 
@@ -122,6 +152,48 @@ enum class ADBackends { autodiff
     ,complex_step
 };
 
+/**
+ * \brief Trait to determine whether a model supplies closed-form derivatives of the residual Helmholtz energy
+ *
+ * A model opts in by defining the member constant \c analytic_derivatives equal to true, along with the methods
+ *  - \c get_Ar0n_analytic<iD>(T, rho, molefrac), returning the same values as TDXDerivatives::get_Ar0n
+ *  - \c get_Psir_gradient_analytic(T, rhovec), returning the gradient of \f$\Psi^{\rm r}\f$ w.r.t. the molar concentrations
+ *
+ * Only the density and composition derivatives are taken from the model; derivatives w.r.t. temperature always go through the backend.
+ * See src/bench_cubic_derivs.cpp for the timings against autodiff.
+ */
+template<typename Model, typename = void>
+struct has_analytic_derivatives : std::false_type {};
+
+template<typename Model>
+struct has_analytic_derivatives<Model, std::enable_if_t<std::decay_t<Model>::analytic_derivatives>> : std::true_type {};
+
+template<typename VectorType, typename = void>
+struct has_double_elements : std::false_type {};
+
+template<typename VectorType>
+struct has_double_elements<VectorType, std::enable_if_t<std::is_same_v<std::decay_t<decltype(std::declval<const VectorType&>()[0])>, double>>> : std::true_type {};
+
+/// The closed-form derivatives are only used in place of the autodiff backend, and only for double precision arguments
+template<typename Model, typename Scalar, typename VectorType, ADBackends be>
+constexpr bool use_analytic_derivatives_v = has_analytic_derivatives<Model>::value
+    && be == ADBackends::autodiff
+    && std::is_same_v<Scalar, double>
+    && has_double_elements<VectorType>::value;
+
+/**
+ * \brief Trait to determine whether the residual Helmholtz energy of a model can be evaluated with HessianDual numbers
+ *
+ * A model opts in by defining the member constant \c hessian_dual_compatible equal to true, which requires that alphar only
+ * uses the operations that HessianDual supports (arithmetic, comparisons, exp, log, pow, sqrt and cbrt). Only then is
+ * IsochoricDerivatives::build_Psir_fgradHessian_hessiandual available; the autodiff routines never switch to these numbers on their own
+ */
+template<typename Model, typename = void>
+struct supports_hessian_dual : std::false_type {};
+
+template<typename Model>
+struct supports_hessian_dual<Model, std::enable_if_t<std::decay_t<Model>::hessian_dual_compatible>> : std::true_type {};
+
 template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
 struct TDXDerivatives {
 
@@ -221,6 +293,53 @@ struct TDXDerivatives {
         return static_cast<Scalar>(-999999999*T); // This will never hit, only to make compiler happy because it doesn't know the return type
     }
 
+    /**
+    * Calculate all the derivatives \f$\Lambda_{ij}\f$ for \f$i\leq iTmax\f$ and \f$j\leq iDmax\f$ in one sweep, where
+    * \f[
+    * \Lambda_{ij} = (1/T)^i\rho^j\left(\frac{\partial^{i+j}(\alpha^*)}{\partial(1/T)^i\partial\rho^j}\right)
+    * \f]
+    *
+    * The alpha function is evaluated once with nested dual numbers of iTmax+iDmax levels; 1/T is seeded at the outer iTmax levels
+    * and density at the inner iDmax levels, so every mixed derivative in the block is a coefficient of the one result. This replaces
+    * one evaluation per derivative (or per row or column of the block) when the whole block is needed.
+    *
+    * \returns An array of shape (iTmax+1, iDmax+1) where the element (i,j) is \f$\Lambda_{ij}\f$
+    */
+    template<int iTmax, int iDmax, class AlphaWrapper>
+    static auto get_Agen_block(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
+        static_assert(iTmax >= 0 && iDmax >= 0);
+        Eigen::Array<double, iTmax+1, iDmax+1> block;
+        if constexpr (iTmax + iDmax == 0) {
+            block(0, 0) = w.alpha(T, rho, molefrac);
+        }
+        else {
+            using adtype = autodiff::HigherOrderDual<iTmax + iDmax, double>;
+            const double Trecip = 1.0/T;
+            const unsigned int Tmask = (1u << iTmax) - 1, Dmask = ((1u << iDmax) - 1) << iTmax;
+            adtype Trecipad = make_nested_dual<iTmax + iDmax>(Trecip, Tmask), rhoad = make_nested_dual<iTmax + iDmax>(static_cast<double>(rho), Dmask);
+            adtype T_ = 1.0/Trecipad;
+            adtype val = eval(w.alpha(T_, rhoad, molefrac));
+            for (auto i = 0; i <= iTmax; ++i) {
+                for (auto j = 0; j <= iDmax; ++j) {
+                    const unsigned int mask = ((1u << i) - 1) | (((1u << j) - 1) << iTmax);
+                    block(i, j) = powi(Trecip, i)*powi(static_cast<double>(rho), j)*get_nested_dual_coeff(val, mask);
+                }
+            }
+        }
+        return block;
+    }
+
+    /**
+    * Calculate the block of residual derivatives \f$\Lambda^{\rm r}_{ij}\f$ for \f$i\leq iTmax\f$ and \f$j\leq iDmax\f$ in one sweep
+    *
+    * See get_Agen_block for the details
+    */
+    template<int iTmax, int iDmax>
+    static auto get_Ar_block(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
+        auto wrapper = AlphaCallWrapper<AlphaWrapperOption::residual, decltype(model)>(model);
+        return get_Agen_block<iTmax, iDmax>(wrapper, T, rho, molefrac);
+    }
+
     /**
     * Calculate the derivative \f$\Lambda^{\rm r}_{xy}\f$, where
     * \f[
@@ -232,7 +351,10 @@ struct TDXDerivatives {
     template<int iT, int iD, ADBackends be = ADBackends::autodiff>
     static auto get_Arxy(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
         auto wrapper = AlphaCallWrapper<AlphaWrapperOption::residual, decltype(model)>(model);
-        if constexpr (iT == 0 && iD == 0) {
+        if constexpr (iT == 0 && use_analytic_derivatives_v<Model, Scalar, VectorType, be>) {
+            return model.template get_Ar0n_analytic<iD>(T, rho, molefrac)[iD];
+        }
+        else if constexpr (iT == 0 && iD == 0) {
             return wrapper.alpha(T, rho, molefrac);
         }
         else {
@@ -390,8 +512,13 @@ struct TDXDerivatives {
     */
     template<int iD, ADBackends be = ADBackends::autodiff>
     static auto get_Ar0n(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
-        auto wrapper = AlphaCallWrapper<AlphaWrapperOption::residual, decltype(model)>(model);
-        return get_Agen0n<iD, be>(wrapper, T, rho, molefrac);
+        if constexpr (use_analytic_derivatives_v<Model, Scalar, VectorType, be>) {
+            return model.template get_Ar0n_analytic<iD>(T, rho, molefrac);
+        }
+        else {
+            auto wrapper = AlphaCallWrapper<AlphaWrapperOption::residual, decltype(model)>(model);
+            return get_Agen0n<iD, be>(wrapper, T, rho, molefrac);
+        }
     }
     
 
@@ -724,6 +851,22 @@ struct VirialDerivatives {
  \end{equation}
  
  */
+/**
+ * \brief Add the ideal-gas contribution \f$RT/\rho_i\f$ to the diagonal of the Hessian of \f$\Psi^{\rm r}\f$ w.r.t. the molar concentrations
+ *
+ * The contribution diverges for a zero concentration, so that diagonal entry is left with the residual part only. All the Hessians
+ * of \f$\Psi\f$ in teqp follow this convention and stay finite at infinite dilution; the routines that need the limit there
+ * handle those entries themselves, from the gradient of \f$\Psi^{\rm r}\f$
+ */
+template<typename MatrixType, typename VectorType>
+void add_ideal_gas_Psi_Hessian_diagonal(MatrixType& H, const double RT, const VectorType& rhovec) {
+    for (auto i = 0; i < rhovec.size(); ++i) {
+        if (rhovec[i] != 0) {
+            H(i, i) += RT / rhovec[i];
+        }
+    }
+}
+
 template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
 struct IsochoricDerivatives{
 
@@ -814,6 +957,47 @@ struct IsochoricDerivatives{
         return autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g).eval(); // evaluate the function value u, its gradient, and its Hessian matrix H
     }
 
+    /***
+    * \brief Calculate the function value, gradient, and Hessian of Psir = ar*rho w.r.t. the molar concentrations with HessianDual numbers
+    * holding the derivatives for at most Nmax components
+    */
+    template<int Nmax>
+    static auto get_Psir_fgradHessian_hessiandual(const Model& model, const Scalar& T, const VectorType& rho) {
+        using HD = HessianDual<Nmax>;
+        const auto N = static_cast<int>(rho.size());
+        Eigen::ArrayX<HD> rhovecc(N);
+        for (auto i = 0; i < N; ++i) { rhovecc[i] = HD::variable(rho[i], i, N); }
+        HD rhotot_ = rhovecc.sum();
+        auto molefrac = (rhovecc / rhotot_).eval();
+        HD Psir = model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_;
+        return std::make_tuple(Psir.val, Psir.gradient(), Psir.hessian());
+    }
+
+    /***
+    * \brief Calculate the function value, gradient, and Hessian of Psir = ar*rho w.r.t. the molar concentrations with one evaluation of the
+    * model with HessianDual numbers
+    *
+    * The model must support HessianDual numbers (see supports_hessian_dual). The numbers are sized for 4, 8, 16 or 32 components,
+    * whichever is the smallest that fits, and mixtures with more than 32 components are rejected. This is an alternative to
+    * build_Psir_fgradHessian_autodiff, not a replacement of it; each operation on the numbers costs \f$O(N^2)\f$
+    */
+    static std::tuple<double, Eigen::ArrayXd, Eigen::MatrixXd> build_Psir_fgradHessian_hessiandual(const Model& model, const Scalar& T, const VectorType& rho) {
+        static_assert(supports_hessian_dual<Model>::value, "The model does not support HessianDual numbers");
+        const auto N = rho.size();
+        if (N <= 4) { return get_Psir_fgradHessian_hessiandual<4>(model, T, rho); }
+        if (N <= 8) { return get_Psir_fgradHessian_hessiandual<8>(model, T, rho); }
+        if (N <= 16) { return get_Psir_fgradHessian_hessiandual<16>(model, T, rho); }
+        if (N <= 32) { return get_Psir_fgradHessian_hessiandual<32>(model, T, rho); }
+        throw teqp::InvalidArgument("HessianDual numbers are only available for up to 32 components, not " + std::to_string(N));
+    }
+
+    /***
+    * \brief Calculate the Hessian of Psir = ar*rho w.r.t. the molar concentrations with one evaluation of the model with HessianDual numbers
+    */
+    static Eigen::MatrixXd build_Psir_Hessian_hessiandual(const Model& model, const Scalar& T, const VectorType& rho) {
+        return std::get<2>(build_Psir_fgradHessian_hessiandual(model, T, rho));
+    }
+
     /***
     * \brief Calculate the function value, gradient, and Hessian of Psir = ar*rho w.r.t. the molar concentrations
     *
@@ -834,24 +1018,43 @@ struct IsochoricDerivatives{
         // Evaluate the function value u, its gradient, and its Hessian matrix H
         Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g); 
         // Remove autodiff stuff from the numerical values
-        auto f = getbaseval(u);
-        auto gg = g.cast<double>().eval();
+        double f = getbaseval(u);
+        Eigen::ArrayXd gg = g.cast<double>().eval();
         return std::make_tuple(f, gg, H);
     }
 
     /***
-    * \brief Calculate the Hessian of Psi = a*rho w.r.t. the molar concentrations
+    * \brief Calculate the function value, gradient, and Hessian of Psi = a*rho w.r.t. the molar concentrations
     *
-    * Uses autodiff derivatives to calculate second partial derivatives
+    * The ideal-gas contribution is taken as \f$RT\sum_i\rho_i(\ln\rho_i - 1)\f$, so the gradient is the vector of the
+    * \f$\partial\Psi^{\rm r}/\partial\rho_i + RT\ln\rho_i\f$ that are equated between phases in the phase equilibrium algorithms
+    * (the chemical potentials of get_chempotVLE_autodiff less \f$RT\f$), and the pressure is \f$p = \vec\rho\cdot\nabla\Psi - \Psi\f$.
+    * The residual part is obtained in one pass from build_Psir_fgradHessian_autodiff. The ideal-gas terms are skipped for a
+    * zero concentration, where they diverge (see add_ideal_gas_Psi_Hessian_diagonal), so those entries of the gradient and of
+    * the diagonal of the Hessian are the residual ones.
     */
-    static auto build_Psi_Hessian_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
+    static auto build_Psi_fgradHessian_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
+        auto [Psi, grad, H] = build_Psir_fgradHessian_autodiff(model, T, rho);
         auto rhotot_ = rho.sum();
         auto molefrac = (rho / rhotot_).eval();
-        auto H = build_Psir_Hessian_autodiff(model, T, rho).eval();
-        for (auto i = 0; i < 2; ++i) {
-            H(i, i) += model.R(molefrac) * T / rho[i];
+        auto RT = model.R(molefrac) * T;
+        for (auto i = 0; i < rho.size(); ++i) {
+            if (rho[i] != 0) {
+                Psi += RT * rho[i] * (log(rho[i]) - 1.0);
+                grad[i] += RT * log(rho[i]);
+            }
         }
-        return H;
+        add_ideal_gas_Psi_Hessian_diagonal(H, RT, rho);
+        return std::make_tuple(Psi, grad, H);
+    }
+
+    /***
+    * \brief Calculate the Hessian of Psi = a*rho w.r.t. the molar concentrations
+    *
+    * Uses autodiff derivatives to calculate second partial derivatives; see build_Psi_fgradHessian_autodiff
+    */
+    static auto build_Psi_Hessian_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
+        return std::get<2>(build_Psi_fgradHessian_autodiff(model, T, rho));
     }
 
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
@@ -942,7 +1145,10 @@ struct IsochoricDerivatives{
     /* Convenience function to select the correct implementation at compile-time */
     template<ADBackends be = ADBackends::autodiff>
     static auto build_Psir_gradient(const Model& model, const Scalar& T, const VectorType& rho) {
-        if constexpr (be == ADBackends::autodiff) {
+        if constexpr (use_analytic_derivatives_v<Model, Scalar, VectorType, be>) {
+            return model.get_Psir_gradient_analytic(T, rho);
+        }
+        else if constexpr (be == ADBackends::autodiff) {
             return build_Psir_gradient_autodiff(model, T, rho);
         }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
@@ -1252,6 +1458,7 @@ public:
     DerivativeHolderSquare(const Model& model, const Scalar& T, const Scalar& rho, const VecType& z) {
         using tdx = TDXDerivatives<decltype(model), Scalar, VecType>;
         static_assert(Nderivsmax == 2, "It's gotta be 2 for now");
+        derivs.setZero(); // The entries with both indices non-zero, other than (1,1), are not calculated
         AlphaCallWrapper<opt, Model> wrapper(model);
         
         auto AX02 = tdx::template get_Agen0n<2>(wrapper, T, rho, z);
@@ -0,0 +1,279 @@
+/**
+ Chebyshev expansions of functions of one variable, fit at the Chebyshev-Lobatto nodes and evaluated with Clenshaw's method
+
+ The evaluation is templated on the type of the argument, so the derivatives of the expansion propagate analytically through
+ any of the numerical types used for automatic differentiation
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <tuple>
+#include <array>
+#include <type_traits>
+#include <limits>
+#include <string>
+
+#include "teqp/exceptions.hpp"
+
+namespace teqp{
+
+namespace internal{
+    constexpr double Chebyshev_pi = 3.14159265358979323846;
+
+    /// Clenshaw's method for the value of the expansion of degree N and its derivative with respect to the scaled variable t in [-1,1]
+    inline std::tuple<double, double> Chebyshev_eval_and_derivative(const double* coeff, int N, double t){
+        double u_k = 0.0, u_kp1 = 0.0, u_kp2 = 0.0, du_k = 0.0, du_kp1 = 0.0, du_kp2 = 0.0;
+        for (int k = N; k > 0; --k){ // k must be signed!
+            u_k = 2.0*t*u_kp1 - u_kp2 + coeff[k];
+            du_k = 2.0*u_kp1 + 2.0*t*du_kp1 - du_kp2;
+            u_kp2 = u_kp1; u_kp1 = u_k;
+            du_kp2 = du_kp1; du_kp1 = du_k;
+        }
+        return {coeff[0] + t*u_kp1 - u_kp2, u_kp1 + t*du_kp1 - du_kp2};
+    }
+
+    /**
+     Solve for the x in [xmin, xmax] at which the expansion of degree N is equal to y, for an expansion that is monotonic over the interval
+
+     Newton steps in the scaled variable, falling back to bisection whenever a step would leave the bracket of the root. If y is not
+     bracketed by the values at the ends of the interval, which happens at the level of round-off at the boundaries between piecewise
+     expansions, the closest end of the interval is returned; checking that y is in range is left to the caller.
+     */
+    inline double Chebyshev_solve_monotonic(const double* coeff, int N, double xmin, double xmax, double y){
+        // At the ends of the interval, T_k(-1) = (-1)^k and T_k(1) = 1
+        double fL = -y, fR = -y;
+        for (int k = 0; k <= N; ++k){
+            fL += (k % 2 == 0) ? coeff[k] : -coeff[k];
+            fR += coeff[k];
+        }
+        if (fL*fR > 0){
+            return (std::abs(fL) < std::abs(fR)) ? xmin : xmax;
+        }
+        double tL = -1.0, tR = 1.0, t = (fL == fR) ? 0.0 : -1.0 - 2.0*fL/(fR - fL);
+        for (auto iter = 0; iter < 100; ++iter){
+            auto [f, dfdt] = Chebyshev_eval_and_derivative(coeff, N, t);
+            f -= y;
+            if (f == 0){ break; }
+            // Shrink the bracket
+            if ((f < 0) == (fL < 0)){ tL = t; } else { tR = t; }
+            double tnew = t - f/dfdt;
+            if (!(tnew > tL && tnew < tR)){
+                tnew = (tL + tR)/2.0;
+            }
+            if (std::abs(tnew - t) < 4*std::numeric_limits<double>::epsilon()){
+                t = tnew; break;
+            }
+            t = tnew;
+        }
+        return std::clamp(((xmax - xmin)*t + (xmax + xmin))/2.0, xmin, xmax);
+    }
+
+    /**
+     The index of the interval containing y, given the values ybounds of a monotonic function at the boundaries of the intervals
+     (so one more value than there are intervals)
+     */
+    inline std::size_t get_monotonic_interval(const std::vector<double>& ybounds, double y){
+        auto n = ybounds.size() - 1;
+        bool increasing = ybounds.back() > ybounds.front();
+        double ylo = (increasing) ? ybounds.front() : ybounds.back(), yhi = (increasing) ? ybounds.back() : ybounds.front();
+        if (!(y >= ylo && y <= yhi)){
+            throw teqp::InvalidArgument("The value of " + std::to_string(y) + " is outside the range [" + std::to_string(ylo) + ", " + std::to_string(yhi) + "]");
+        }
+        std::size_t iL = 0, iR = n;
+        while (iR - iL > 1){
+            auto iM = iL + (iR - iL)/2;
+            if ((y >= ybounds[iM]) == increasing){ iL = iM; } else { iR = iM; }
+        }
+        return iL;
+    }
+
+    /// The values of the piecewise expansions at the boundaries of their intervals, for use with get_monotonic_interval
+    template<typename Expansions, typename Evaluator>
+    auto get_interval_bounds(const Expansions& exps, const Evaluator& eval){
+        std::vector<double> ybounds;
+        for (const auto& e : exps){
+            ybounds.push_back(eval(e, e.xmin));
+        }
+        ybounds.push_back(eval(exps.back(), exps.back().xmax));
+        return ybounds;
+    }
+
+    /// True if the values at the boundaries of the intervals are strictly increasing or strictly decreasing
+    inline bool is_strictly_monotonic(const std::vector<double>& ybounds){
+        bool increasing = ybounds.back() > ybounds.front();
+        for (auto i = 0U; i + 1 < ybounds.size(); ++i){
+            if ((ybounds[i+1] > ybounds[i]) != increasing || ybounds[i+1] == ybounds[i]){
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ The expansion \f$\sum_{k=0}^{N} c_kT_k(x')\f$ with \f$x'=(2x-(x_{\min}+x_{\max}))/(x_{\max}-x_{\min})\f$ in [-1,1]
+*/
+struct ChebyshevExpansion{
+    std::vector<double> coeff;
+    double xmin, xmax;
+
+    /// Evaluate the expansion with Clenshaw's method
+    template<typename XType>
+    XType eval(const XType& x) const {
+        XType xscaled = (2.0*x - (xmax + xmin))/(xmax - xmin);
+        auto Norder = static_cast<int>(coeff.size()) - 1;
+        XType u_k = 0.0, u_kp1 = 0.0, u_kp2 = 0.0;
+        for (int k = Norder; k > 0; --k){ // k must be signed!
+            u_k = 2.0*xscaled*u_kp1 - u_kp2 + coeff[k];
+            u_kp2 = u_kp1; u_kp1 = u_k;
+        }
+        return coeff[0] + xscaled*u_kp1 - u_kp2;
+    }
+
+    /// Solve for the x at which the expansion, assumed to be monotonic over its interval, is equal to y (see internal::Chebyshev_solve_monotonic)
+    double solve_for_x(double y) const {
+        return internal::Chebyshev_solve_monotonic(&(coeff[0]), static_cast<int>(coeff.size()) - 1, xmin, xmax, y);
+    }
+};
+
+/// The N+1 Chebyshev-Lobatto nodes \f$\cos(\pi j/N)\f$ for j=0,...,N, in [-1,1]
+inline auto get_Chebyshev_Lobatto_nodes(int N){
+    std::vector<double> nodes(N+1);
+    for (auto j = 0; j <= N; ++j){
+        nodes[j] = cos(internal::Chebyshev_pi*j/N);
+    }
+    return nodes;
+}
+
+/**
+ The expansion of degree N over [xmin, xmax] that interpolates the N+1 values of the function at the Chebyshev-Lobatto nodes,
+ in the order of the nodes given by get_Chebyshev_Lobatto_nodes
+ */
+inline auto Chebyshev_from_nodes(const std::vector<double>& fnodes, double xmin, double xmax){
+    auto N = static_cast<int>(fnodes.size()) - 1;
+    if (N < 1){
+        throw teqp::InvalidArgument("The degree of the Chebyshev expansion must be at least 1");
+    }
+    // Discrete cosine transform (of type I), halving the first and last terms of the sums
+    std::vector<double> c(N+1);
+    for (auto k = 0; k <= N; ++k){
+        double summer = 0.0;
+        for (auto j = 0; j <= N; ++j){
+            double w = (j == 0 || j == N) ? 0.5 : 1.0;
+            summer += w*fnodes[j]*cos(internal::Chebyshev_pi*j*k/N);
+        }
+        c[k] = summer*2.0/N*((k == 0 || k == N) ? 0.5 : 1.0);
+    }
+    return ChebyshevExpansion{c, xmin, xmax};
+}
+
+/**
+ Fit the expansion of degree N to the function f over [xmin, xmax] by interpolation at the N+1 Chebyshev-Lobatto nodes
+
+ \param f The callable, taking and returning a double
+ */
+template<typename Function>
+auto fit_Chebyshev(const Function& f, double xmin, double xmax, int N){
+    if (N < 1){
+        throw teqp::InvalidArgument("The degree of the Chebyshev expansion must be at least 1");
+    }
+    std::vector<double> fnodes(N+1);
+    auto nodes = get_Chebyshev_Lobatto_nodes(N);
+    for (auto j = 0; j <= N; ++j){
+        fnodes[j] = f((xmax - xmin)/2.0*nodes[j] + (xmax + xmin)/2.0);
+    }
+    return Chebyshev_from_nodes(fnodes, xmin, xmax);
+}
+
+/**
+ A set of Chebyshev expansions of the same function over contiguous intervals, built by splitting the domain in halves until the
+ last two coefficients of each expansion are negligible
+*/
+struct PiecewiseChebyshev{
+    std::vector<ChebyshevExpansion> expansions;
+
+    double get_xmin() const { return expansions.front().xmin; }
+    double get_xmax() const { return expansions.back().xmax; }
+    bool contains(double x) const { return x >= get_xmin() && x <= get_xmax(); }
+
+    /// The index of the expansion whose interval contains x, by bisection
+    std::size_t get_index(double x) const {
+        std::size_t iL = 0, iR = expansions.size() - 1;
+        while (iR - iL > 1){
+            auto iM = iL + (iR - iL)/2;
+            if (x >= expansions[iM].xmin){ iL = iM; } else { iR = iM; }
+        }
+        return (x < expansions[iL].xmax) ? iL : iR;
+    }
+
+    /// Evaluate the expansion covering the double value of x
+    template<typename XType>
+    XType eval(const XType& x, double xbase) const {
+        return expansions[get_index(xbase)].eval(x);
+    }
+};
+
+/**
+ Build the piecewise expansions of degree N of the M outputs of f over [xmin, xmax], where f returns a std::array<double, M>
+
+ All the outputs share the same intervals so that each node costs only one call to f, which matters when the evaluation of
+ f requires an iterative calculation. An interval is accepted when, for each output, the magnitude of the last two coefficients
+ is below rtol times that of the largest one. If the accuracy cannot be reached (e.g., because the function is itself noisy at
+ the level of rtol), the intervals are not split more than max_refine times. Within an interval, f is called in increasing
+ order of x, and the intervals are visited from left to right
+*/
+template<typename Function>
+auto fit_piecewise_Chebyshev_multi(const Function& f, double xmin, double xmax, int N, double rtol, int max_refine = 10){
+    if (!(xmax > xmin)){
+        throw teqp::InvalidArgument("The interval of the Chebyshev expansions must be non-empty");
+    }
+    using Values = std::decay_t<decltype(f(xmin))>;
+    constexpr std::size_t M = std::tuple_size_v<Values>;
+    std::array<PiecewiseChebyshev, M> pws;
+    auto nodes = get_Chebyshev_Lobatto_nodes(N);
+    std::vector<Values> fnodes(N+1);
+    std::vector<double> fnodesm(N+1);
+    std::vector<std::tuple<double, double, int>> stack = {{xmin, xmax, 0}};
+    while (!stack.empty()){
+        auto [a, b, depth] = stack.back(); stack.pop_back();
+        for (auto j = N; j >= 0; --j){
+            fnodes[j] = f((b - a)/2.0*nodes[j] + (b + a)/2.0);
+        }
+        std::array<ChebyshevExpansion, M> ces;
+        bool converged = true;
+        for (auto m = 0U; m < M; ++m){
+            for (auto j = 0; j <= N; ++j){ fnodesm[j] = fnodes[j][m]; }
+            ces[m] = Chebyshev_from_nodes(fnodesm, a, b);
+            double cmax = 0.0;
+            for (auto c : ces[m].coeff){ cmax = std::max(cmax, std::abs(c)); }
+            double tail = std::max(std::abs(ces[m].coeff[N]), std::abs(ces[m].coeff[N-1]));
+            converged = converged && (tail <= rtol*cmax);
+        }
+        if (converged || depth >= max_refine){
+            for (auto m = 0U; m < M; ++m){ pws[m].expansions.push_back(ces[m]); }
+        }
+        else{
+            // The right half is pushed first so that the expansions come out in increasing order of x
+            double mid = (a + b)/2.0;
+            stack.emplace_back(mid, b, depth+1);
+            stack.emplace_back(a, mid, depth+1);
+        }
+    }
+    return pws;
+}
+
+/**
+ Build the piecewise expansions of degree N of f over [xmin, xmax], with f taking and returning a double
+
+ See fit_piecewise_Chebyshev_multi for the meaning of the arguments
+*/
+template<typename Function>
+auto fit_piecewise_Chebyshev(const Function& f, double xmin, double xmax, int N, double rtol, int max_refine = 10){
+    auto f1 = [&f](double x){ return std::array<double, 1>{f(x)}; };
+    return fit_piecewise_Chebyshev_multi(f1, xmin, xmax, N, rtol, max_refine)[0];
+}
+
+}
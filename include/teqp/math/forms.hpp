@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ Quadratic and cubic forms of constant coefficient tensors with a vector (e.g., of mole fractions), as appear in the mixing rules of many models
+*/
+
+#include <type_traits>
+#include <utility>
+#include <Eigen/Dense>
+
+namespace teqp{
+
+namespace internal{
+    /// True if the vector is an Eigen object holding doubles, for which the inner sums can be Eigen dot products
+    template<typename VecType, typename = void>
+    struct is_eigen_double : std::false_type {};
+    template<typename VecType>
+    struct is_eigen_double<VecType, std::void_t<typename VecType::Scalar, decltype(std::declval<const VecType&>().matrix())>> : std::is_same<typename VecType::Scalar, double> {};
+    template<typename VecType>
+    constexpr bool is_eigen_double_v = is_eigen_double<std::decay_t<VecType>>::value;
+}
+
+/**
+ The quadratic form \f$\sum_i\sum_j A_{ij}x_ix_j\f$ of a constant matrix with a vector whose elements can be of any numerical type
+ 
+ For an Eigen vector of doubles, each inner sum is a dot product with a column of the matrix, so nothing is allocated
+ */
+template<typename VecType>
+auto quadratic_form(const Eigen::ArrayXXd& A, const VecType& x){
+    using X = std::decay_t<decltype(x[0])>;
+    const auto N = A.rows();
+    if constexpr (internal::is_eigen_double_v<VecType>){
+        double s = 0.0;
+        for (auto j = 0; j < N; ++j){
+            s += x[j]*A.col(j).matrix().dot(x.matrix());
+        }
+        return s;
+    }
+    else{
+        X s = 0.0;
+        for (auto j = 0; j < N; ++j){
+            X row = 0.0;
+            for (auto i = 0; i < N; ++i){
+                row = row + A(i,j)*x[i];
+            }
+            s = s + x[j]*row;
+        }
+        return s;
+    }
+}
+
+/**
+ The cubic form \f$\sum_i\sum_j\sum_k D_{ijk}x_ix_jx_k\f$ of a constant tensor with a vector whose elements can be of any numerical type
+ 
+ The tensor is stored as a matrix of \f$N^2\f$ rows and \f$N\f$ columns, with \f$D_{ijk}\f$ in row \f$i+Nj\f$ and column \f$k\f$, so that the innermost sums are over contiguous memory
+ */
+template<typename VecType>
+auto cubic_form(const Eigen::ArrayXXd& D, const VecType& x){
+    using X = std::decay_t<decltype(x[0])>;
+    const auto N = D.cols();
+    if constexpr (internal::is_eigen_double_v<VecType>){
+        double s = 0.0;
+        for (auto k = 0; k < N; ++k){
+            double sk = 0.0;
+            for (auto j = 0; j < N; ++j){
+                sk += x[j]*D.col(k).segment(N*j, N).matrix().dot(x.matrix());
+            }
+            s += x[k]*sk;
+        }
+        return s;
+    }
+    else{
+        X s = 0.0;
+        for (auto k = 0; k < N; ++k){
+            X sk = 0.0;
+            for (auto j = 0; j < N; ++j){
+                X row = 0.0;
+                for (auto i = 0; i < N; ++i){
+                    row = row + D(i + N*j, k)*x[i];
+                }
+                sk = sk + x[j]*row;
+            }
+            s = s + x[k]*sk;
+        }
+        return s;
+    }
+}
+
+}
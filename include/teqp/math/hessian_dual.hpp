@@ -0,0 +1,221 @@
+#pragma once
+
+/**
+ Numbers that carry their gradient and Hessian with respect to a set of independent variables, so that the complete Hessian
+ of a function is obtained from one evaluation of the function (second-order forward mode of automatic differentiation)
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <Eigen/Dense>
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp{
+
+/**
+ A number with its value, its gradient with respect to N independent variables, and the upper triangle of its Hessian packed by rows
+
+ Only the \f$N(N+1)/2\f$ entries on and above the diagonal of the Hessian are propagated, so each elementary operation costs \f$O(N^2)\f$
+ (the product of two numbers that both depend on the variables touches all \f$N+N(N+1)/2\f$ entries), but the operation, and the
+ transcendental function in it, is done once rather than once for each entry of the Hessian as with second-order dual numbers.
+
+ The derivatives live in a fixed array sized for at most Nmax variables, so temporaries never allocate; only the entries in use are copied.
+ Constants have no derivatives at all, so mixing them into an expression costs about as much as it does for doubles.
+ */
+template<int Nmax>
+class HessianDual{
+public:
+    static constexpr int capacity = Nmax + Nmax*(Nmax+1)/2;
+
+    double val = 0.0;
+    int N = 0; ///< The number of independent variables, zero for a constant
+
+    HessianDual() = default;
+    HessianDual(double val) : val(val) {};
+    HessianDual(const HessianDual& o) : val(o.val), N(o.N) { std::copy_n(o.d, o.size(), d); }
+    HessianDual& operator=(const HessianDual& o){
+        val = o.val; N = o.N;
+        std::copy_n(o.d, o.size(), d);
+        return *this;
+    }
+
+    /// The i-th of N independent variables, with the value x
+    static HessianDual variable(double x, int i, int N){
+        if (N > Nmax){
+            throw teqp::InvalidArgument("HessianDual<" + std::to_string(Nmax) + "> cannot hold the derivatives for " + std::to_string(N) + " variables");
+        }
+        HessianDual o(x);
+        o.N = N;
+        std::fill_n(o.d, o.size(), 0.0);
+        o.d[i] = 1.0;
+        return o;
+    }
+
+    bool is_constant() const { return N == 0; }
+
+    /// The gradient with respect to the independent variables
+    Eigen::ArrayXd gradient() const {
+        return Eigen::Map<const Eigen::ArrayXd>(d, N);
+    }
+
+    /// The Hessian with respect to the independent variables, with the lower triangle filled in by symmetry
+    Eigen::MatrixXd hessian() const {
+        Eigen::MatrixXd H(N, N);
+        const double* h = d + N;
+        for (int i = 0; i < N; ++i){
+            for (int j = i; j < N; ++j, ++h){
+                H(i, j) = *h;
+                H(j, i) = *h;
+            }
+        }
+        return H;
+    }
+
+    /**
+     Replace the number u with f(u), given the value and the first and second derivatives of f at u:
+     \f$\nabla f = f'\nabla u\f$ and \f$H_f = f' H_u + f''\nabla u\nabla u^T\f$
+     */
+    HessianDual& chain(double f0, double f1, double f2){
+        val = f0;
+        const double* g = d;
+        double* h = d + N;
+        for (int i = 0; i < N; ++i){
+            const double f2gi = f2*g[i];
+            for (int j = i; j < N; ++j, ++h){
+                *h = f1*(*h) + f2gi*g[j];
+            }
+        }
+        for (int i = 0; i < N; ++i){ d[i] *= f1; }
+        return *this;
+    }
+
+    HessianDual& operator+=(double b){ val += b; return *this; }
+    HessianDual& operator-=(double b){ val -= b; return *this; }
+    HessianDual& operator*=(double b){
+        val *= b;
+        for (int k = 0; k < size(); ++k){ d[k] *= b; }
+        return *this;
+    }
+    HessianDual& operator/=(double b){ return (*this) *= (1.0/b); }
+
+    HessianDual& operator+=(const HessianDual& b){
+        val += b.val;
+        if (b.is_constant()){ return *this; }
+        if (is_constant()){ N = b.N; std::copy_n(b.d, size(), d); return *this; }
+        check_size(b);
+        for (int k = 0; k < size(); ++k){ d[k] += b.d[k]; }
+        return *this;
+    }
+    HessianDual& operator-=(const HessianDual& b){
+        val -= b.val;
+        if (b.is_constant()){ return *this; }
+        if (is_constant()){ N = b.N; for (int k = 0; k < size(); ++k){ d[k] = -b.d[k]; } return *this; }
+        check_size(b);
+        for (int k = 0; k < size(); ++k){ d[k] -= b.d[k]; }
+        return *this;
+    }
+    /// \f$H_{ab} = bH_a + aH_b + \nabla a\nabla b^T + \nabla b\nabla a^T\f$
+    HessianDual& operator*=(const HessianDual& b){
+        if (b.is_constant()){ return (*this) *= b.val; }
+        if (is_constant()){ double a = val; *this = b; return (*this) *= a; }
+        check_size(b);
+        const double av = val, bv = b.val;
+        const double* ga = d;
+        const double* gb = b.d;
+        double* h = d + N;
+        const double* hb = b.d + N;
+        for (int i = 0; i < N; ++i){
+            for (int j = i; j < N; ++j, ++h, ++hb){
+                *h = bv*(*h) + av*(*hb) + ga[i]*gb[j] + gb[i]*ga[j];
+            }
+        }
+        for (int i = 0; i < N; ++i){ d[i] = bv*d[i] + av*gb[i]; }
+        val = av*bv;
+        return *this;
+    }
+    HessianDual& operator/=(const HessianDual& b){
+        if (b.is_constant()){ return (*this) /= b.val; }
+        return (*this) *= inverse(b);
+    }
+
+    friend HessianDual inverse(HessianDual u){ const double r = 1.0/u.val; return u.chain(r, -r*r, 2.0*r*r*r); }
+
+    friend HessianDual operator-(HessianDual a){ return a *= -1.0; }
+
+    friend HessianDual operator+(HessianDual a, const HessianDual& b){ return a += b; }
+    friend HessianDual operator+(HessianDual a, double b){ return a += b; }
+    friend HessianDual operator+(double a, HessianDual b){ return b += a; }
+    friend HessianDual operator-(HessianDual a, const HessianDual& b){ return a -= b; }
+    friend HessianDual operator-(HessianDual a, double b){ return a -= b; }
+    friend HessianDual operator-(double a, HessianDual b){ return (b *= -1.0) += a; }
+    friend HessianDual operator*(HessianDual a, const HessianDual& b){ return a *= b; }
+    friend HessianDual operator*(HessianDual a, double b){ return a *= b; }
+    friend HessianDual operator*(double a, HessianDual b){ return b *= a; }
+    friend HessianDual operator/(HessianDual a, const HessianDual& b){ return a /= b; }
+    friend HessianDual operator/(HessianDual a, double b){ return a /= b; }
+    friend HessianDual operator/(double a, HessianDual b){ return inverse(std::move(b)) *= a; }
+
+    friend bool operator==(const HessianDual& a, const HessianDual& b){ return a.val == b.val; }
+    friend bool operator!=(const HessianDual& a, const HessianDual& b){ return a.val != b.val; }
+    friend bool operator<(const HessianDual& a, const HessianDual& b){ return a.val < b.val; }
+    friend bool operator>(const HessianDual& a, const HessianDual& b){ return a.val > b.val; }
+    friend bool operator<=(const HessianDual& a, const HessianDual& b){ return a.val <= b.val; }
+    friend bool operator>=(const HessianDual& a, const HessianDual& b){ return a.val >= b.val; }
+
+    friend HessianDual exp(HessianDual u){ const double e = std::exp(u.val); return u.chain(e, e, e); }
+    friend HessianDual log(HessianDual u){ const double r = 1.0/u.val; return u.chain(std::log(u.val), r, -r*r); }
+    friend HessianDual sqrt(HessianDual u){ const double s = std::sqrt(u.val); return u.chain(s, 0.5/s, -0.25/(s*u.val)); }
+    friend HessianDual cbrt(HessianDual u){ const double c = std::cbrt(u.val), f1 = c/(3.0*u.val); return u.chain(c, f1, -2.0*f1/(3.0*u.val)); }
+    friend HessianDual pow(HessianDual u, double e){
+        const double f0 = std::pow(u.val, e);
+        if (u.val != 0){
+            const double f1 = e*f0/u.val;
+            return u.chain(f0, f1, (e-1.0)*f1/u.val);
+        }
+        return u.chain(f0, e*std::pow(u.val, e-1.0), e*(e-1.0)*std::pow(u.val, e-2.0));
+    }
+    friend HessianDual pow(HessianDual u, int e){ return pow(std::move(u), static_cast<double>(e)); }
+    friend HessianDual pow(const HessianDual& u, const HessianDual& e){ return exp(e*log(u)); }
+    friend HessianDual pow(double u, HessianDual e){ return exp(std::move(e) *= std::log(u)); }
+
+private:
+    double d[capacity]; ///< The gradient (N entries) followed by the packed upper triangle of the Hessian (N(N+1)/2 entries); the rest is unused
+
+    /// The number of entries of d in use
+    int size() const { return N + N*(N+1)/2; }
+
+    void check_size(const HessianDual& b) const {
+        if (b.N != N){
+            throw teqp::InvalidArgument("HessianDual numbers with different numbers of independent variables: " + std::to_string(N) + " and " + std::to_string(b.N));
+        }
+    }
+};
+
+template<int Nmax> struct is_hessian_dual_t<HessianDual<Nmax>> : public std::true_type {};
+
+}
+
+// See https://eigen.tuxfamily.org/dox/TopicCustomizing_CustomScalar.html
+namespace Eigen {
+    template<int Nmax> struct NumTraits<teqp::HessianDual<Nmax>> : NumTraits<double>
+    {
+        using Real = teqp::HessianDual<Nmax>;
+        using NonInteger = teqp::HessianDual<Nmax>;
+        using Nested = teqp::HessianDual<Nmax>;
+        using Literal = teqp::HessianDual<Nmax>;
+        enum {
+            IsComplex = 0,
+            IsInteger = 0,
+            IsSigned = 1,
+            RequireInitialization = 1,
+            ReadCost = 1,
+            AddCost = 3,
+            MulCost = 3
+        };
+    };
+    template<int Nmax, typename BinaryOp> struct ScalarBinaryOpTraits<teqp::HessianDual<Nmax>, double, BinaryOp> { using ReturnType = teqp::HessianDual<Nmax>; };
+    template<int Nmax, typename BinaryOp> struct ScalarBinaryOpTraits<double, teqp::HessianDual<Nmax>, BinaryOp> { using ReturnType = teqp::HessianDual<Nmax>; };
+}
@@ -5,61 +5,63 @@
 
 #pragma once
 
+#include <array>
+#include <Eigen/Dense>
+
 namespace teqp{
 
+namespace internal{
+
+/**
+ Locations x in [-1,1] where the function is to be evaluated, and the corresponding weights, for the Gauss-Legendre rule with N points
+
+ The values are stored in increasing order of x as compile-time constants, so that nothing needs to be looked up or allocated
+ when the quadrature is carried out. More coefficients here if needed: https://pomax.github.io/bezierinfo/legendre-gauss.html
+*/
+template<int N> struct GaussLegendre{
+    static_assert(N < 0, "This number of points for Gauss-Legendre quadrature is not available");
+};
+template<> struct GaussLegendre<3>{
+    static constexpr std::array<double, 3> x = {-0.7745966692414834, 0.0, 0.7745966692414834};
+    static constexpr std::array<double, 3> w = {0.5555555555555556, 0.8888888888888888, 0.5555555555555556};
+};
+template<> struct GaussLegendre<4>{
+    static constexpr std::array<double, 4> x = {-0.8611363115940526, -0.33998104358485626, 0.33998104358485626, 0.8611363115940526};
+    static constexpr std::array<double, 4> w = {0.34785484513745385, 0.6521451548625461, 0.6521451548625461, 0.34785484513745385};
+};
+template<> struct GaussLegendre<5>{
+    static constexpr std::array<double, 5> x = {-0.906179845938664, -0.5384693101056831, 0.0, 0.5384693101056831, 0.906179845938664};
+    static constexpr std::array<double, 5> w = {0.23692688505618908, 0.47862867049936647, 0.5688888888888889, 0.47862867049936647, 0.23692688505618908};
+};
+template<> struct GaussLegendre<7>{
+    static constexpr std::array<double, 7> x = {-0.9491079123427585, -0.7415311855993945, -0.4058451513773972, 0.0, 0.4058451513773972, 0.7415311855993945, 0.9491079123427585};
+    static constexpr std::array<double, 7> w = {0.1294849661688697, 0.27970539148927664, 0.3818300505051189, 0.4179591836734694, 0.3818300505051189, 0.27970539148927664, 0.1294849661688697};
+};
+template<> struct GaussLegendre<10>{
+    static constexpr std::array<double, 10> x = {-0.9739065285171717, -0.8650633666889845, -0.6794095682990244, -0.4333953941292472, -0.14887433898163122, 0.14887433898163122, 0.4333953941292472, 0.6794095682990244, 0.8650633666889845, 0.9739065285171717};
+    static constexpr std::array<double, 10> w = {0.06667134430868814, 0.1494513491505806, 0.21908636251598204, 0.26926671930999635, 0.29552422471475287, 0.29552422471475287, 0.26926671930999635, 0.21908636251598204, 0.1494513491505806, 0.06667134430868814};
+};
+template<> struct GaussLegendre<15>{
+    static constexpr std::array<double, 15> x = {-0.9879925180204854, -0.937273392400706, -0.8482065834104272, -0.7244177313601701, -0.5709721726085388, -0.3941513470775634, -0.20119409399743451, 0.0, 0.20119409399743451, 0.3941513470775634, 0.5709721726085388, 0.7244177313601701, 0.8482065834104272, 0.937273392400706, 0.9879925180204854};
+    static constexpr std::array<double, 15> w = {0.03075324199611727, 0.07036604748810812, 0.10715922046717194, 0.13957067792615432, 0.16626920581699392, 0.1861610000155622, 0.19843148532711158, 0.2025782419255613, 0.19843148532711158, 0.1861610000155622, 0.16626920581699392, 0.13957067792615432, 0.10715922046717194, 0.07036604748810812, 0.03075324199611727};
+};
+template<> struct GaussLegendre<30>{
+    static constexpr std::array<double, 30> x = {-0.9968934840746495, -0.9836681232797472, -0.9600218649683075, -0.9262000474292743, -0.8825605357920527, -0.8295657623827684, -0.7677774321048262, -0.6978504947933158, -0.6205261829892429, -0.5366241481420199, -0.44703376953808915, -0.3527047255308781, -0.25463692616788985, -0.15386991360858354, -0.0514718425553177, 0.0514718425553177, 0.15386991360858354, 0.25463692616788985, 0.3527047255308781, 0.44703376953808915, 0.5366241481420199, 0.6205261829892429, 0.6978504947933158, 0.7677774321048262, 0.8295657623827684, 0.8825605357920527, 0.9262000474292743, 0.9600218649683075, 0.9836681232797472, 0.9968934840746495};
+    static constexpr std::array<double, 30> w = {0.007968192496166605, 0.01846646831109096, 0.02878470788332337, 0.03879919256962705, 0.04840267283059405, 0.057493156217619065, 0.06597422988218049, 0.0737559747377052, 0.08075589522942021, 0.08689978720108298, 0.09212252223778612, 0.09636873717464425, 0.09959342058679527, 0.1017623897484055, 0.10285265289355884, 0.10285265289355884, 0.1017623897484055, 0.09959342058679527, 0.09636873717464425, 0.09212252223778612, 0.08689978720108298, 0.08075589522942021, 0.0737559747377052, 0.06597422988218049, 0.057493156217619065, 0.04840267283059405, 0.03879919256962705, 0.02878470788332337, 0.01846646831109096, 0.007968192496166605};
+};
+
+}
+
 /**
  Gauss-Legendre quadrature for a function f(x) in the interval [a,b]
  
- More coefficients here if needed: https://pomax.github.io/bezierinfo/legendre-gauss.html
+ The callable is a template argument, so lambdas are passed without type erasure and can be inlined
 */
-template<int N, typename T, typename Double=double>
-inline auto quad(const std::function<T(Double)>& F, const Double& a, const Double& b){
-    
-    // Locations x in [-1,1] where the function is to be evaluated, and the corresponding weight
-    static const std::map<int, std::tuple<std::vector<Double>, std::vector<Double>>> xw = {
-        {
-            3,
-            {{ 0, sqrt(3.0/5), -sqrt(3.0/5) },
-            {8.0/9.0, 5.0/9.0, 5.0/9.0}}
-        },
-        {
-            4,
-            {{sqrt(3.0/7.0-2.0/7.0*sqrt(6.0/5)), -sqrt(3.0/7.0-2.0/7.0*sqrt(6.0/5)), sqrt(3.0/7.0+2.0/7.0*sqrt(6.0/5)), -sqrt(3.0/7.0+2.0/7.0*sqrt(6.0/5))},
-            {(18.0+sqrt(30.0))/36.0, (18.0+sqrt(30.0))/36.0, (18.0-sqrt(30.0))/36.0, (18.0-sqrt(30.0))/36.0}}
-        },
-        {
-            5,
-            {{0, 1.0/3.0*sqrt(5-2*sqrt(10.0/7.0)), -1.0/3.0*sqrt(5-2*sqrt(10.0/7.0)), 1.0/3.0*sqrt(5+2*sqrt(10.0/7.0)), -1.0/3.0*sqrt(5+2*sqrt(10.0/7.0))},
-            {128/225.0, (322.0+13*sqrt(70))/900.0, (322.0+13*sqrt(70))/900.0, (322.0-13*sqrt(70))/900.0, (322.0-13*sqrt(70))/900.0}}
-        },
-        {
-            7,
-            {{0.0000000000000000,0.4058451513773972,-0.4058451513773972,-0.7415311855993945,0.7415311855993945,-0.9491079123427585,0.9491079123427585},
-            { 0.4179591836734694,0.3818300505051189,0.3818300505051189,0.2797053914892766,0.2797053914892766,0.1294849661688697,0.1294849661688697}}
-        },
-        {
-            10,
-            {{-0.1488743389816312,0.1488743389816312,-0.4333953941292472,0.4333953941292472,-0.6794095682990244,0.6794095682990244,-0.8650633666889845,0.8650633666889845,-0.9739065285171717,0.9739065285171717},
-            { 0.2955242247147529,0.2955242247147529,0.2692667193099963,0.2692667193099963,0.2190863625159820,0.2190863625159820,0.1494513491505806,0.1494513491505806,0.0666713443086881,0.0666713443086881}}
-        },
-        {
-            15,
-            {{0.0000000000000000,-0.2011940939974345,0.2011940939974345,-0.3941513470775634,0.3941513470775634,-0.5709721726085388,0.5709721726085388,-0.7244177313601701,0.7244177313601701,-0.8482065834104272,0.8482065834104272,-0.9372733924007060,0.9372733924007060,-0.9879925180204854,0.9879925180204854},
-            {0.2025782419255613,0.1984314853271116,0.1984314853271116,0.1861610000155622,0.1861610000155622,0.1662692058169939,0.1662692058169939,0.1395706779261543,0.1395706779261543,0.1071592204671719,0.1071592204671719,0.0703660474881081,0.0703660474881081,0.0307532419961173,0.0307532419961173}}
-        },
-        {
-            30,
-            {{-0.0514718425553177,0.0514718425553177,-0.1538699136085835,0.1538699136085835,-0.2546369261678899,0.2546369261678899,-0.3527047255308781,0.3527047255308781,-0.4470337695380892,0.4470337695380892,-0.5366241481420199,0.5366241481420199,-0.6205261829892429,0.6205261829892429,-0.6978504947933158,0.6978504947933158,-0.7677774321048262,0.7677774321048262,-0.8295657623827684,0.8295657623827684,-0.8825605357920527,0.8825605357920527,-0.9262000474292743,0.9262000474292743,-0.9600218649683075,0.9600218649683075,-0.9836681232797472,0.9836681232797472,-0.9968934840746495,0.9968934840746495
-            },
-            {0.1028526528935588,0.1028526528935588,0.1017623897484055,0.1017623897484055,0.0995934205867953,0.0995934205867953,0.0963687371746443,0.0963687371746443,0.0921225222377861,0.0921225222377861,0.0868997872010830,0.0868997872010830,0.0807558952294202,0.0807558952294202,0.0737559747377052,0.0737559747377052,0.0659742298821805,0.0659742298821805,0.0574931562176191,0.0574931562176191,0.0484026728305941,0.0484026728305941,0.0387991925696271,0.0387991925696271,0.0287847078833234,0.0287847078833234,0.0184664683110910,0.0184664683110910,0.0079681924961666,0.0079681924961666}}
-        }
-    };
-    
+template<int N, typename T, typename Double=double, typename Function>
+inline auto quad(const Function& F, const Double& a, const Double& b){
+    const auto& x = internal::GaussLegendre<N>::x;
+    const auto& w = internal::GaussLegendre<N>::w;
     T summer = 0.0;
-    // Lookup the coefficients without making a copy or re-allocating
-    const std::tuple<std::vector<Double>, std::vector<Double>> &pair = xw.at(N);
-    const std::vector<Double> &x = std::get<0>(pair);
-    const std::vector<Double> &w = std::get<1>(pair);
     for (auto i = 0; i < N; ++i){
         Double arg = (b-a)/2.0*x[i] + (a+b)/2.0;
         summer += w[i]*F(arg);
@@ -67,4 +69,27 @@ inline auto quad(const std::function<T(Double)>& F, const Double& a, const Doubl
     T retval = (b-a)/2.0*summer; // Forces a flattening if T is an autodiff type
     return retval;
 }
+
+/**
+ Gauss-Legendre quadrature for a function f(x) in the interval [a,b], in which the function is evaluated at all the N points in one call
+ 
+ The callable takes an Eigen::Array of the N locations and returns an array expression of the N values of the function, which allows
+ Eigen to vectorize the evaluations of the integrand
+*/
+template<int N, typename T, typename Double=double, typename Function>
+inline auto quad_batched(const Function& F, const Double& a, const Double& b){
+    const auto& x = internal::GaussLegendre<N>::x;
+    const auto& w = internal::GaussLegendre<N>::w;
+    Eigen::Array<Double, N, 1> args;
+    for (auto i = 0; i < N; ++i){
+        args[i] = (b-a)/2.0*x[i] + (a+b)/2.0;
+    }
+    Eigen::Array<T, N, 1> vals = F(args);
+    T summer = 0.0;
+    for (auto i = 0; i < N; ++i){
+        summer += w[i]*vals[i];
+    }
+    T retval = (b-a)/2.0*summer; // Forces a flattening if T is an autodiff type
+    return retval;
+}
 }
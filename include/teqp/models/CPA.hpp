@@ -3,6 +3,7 @@
 #include "nlohmann/json.hpp"
 #include <Eigen/Dense>
 #include "teqp/types.hpp"
+#include "teqp/models/association/association.hpp"
 
 namespace teqp {
 
@@ -11,18 +12,8 @@ namespace CPA {
 template<typename X> auto POW2(X x) { return x * x; };
 template<typename X> auto POW3(X x) { return x * POW2(x); };
 
-enum class association_classes {not_set, a1A, a2B, a3B, a4C, not_associating};
-
-inline auto get_association_classes(const std::string& s) {
-    if (s == "1A") { return association_classes::a1A; }
-    else if (s == "2B") { return association_classes::a2B; }
-    else if (s == "2B") { return association_classes::a2B; }
-    else if (s == "3B") { return association_classes::a3B; }
-    else if (s == "4C") { return association_classes::a4C; }
-    else {
-        throw std::invalid_argument("bad association flag:" + s);
-    }
-}
+using association::association_classes;
+using association::get_association_classes;
 
 enum class radial_dist { CS, KG, OT };
 
@@ -35,9 +26,9 @@ inline auto get_radial_dist(const std::string& s) {
     }
 }
 
-/// Function that calculates the association binding strength between site A of molecule i and site B on molecule j
-template<typename BType, typename TType, typename RhoType, typename VecType>
-inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BType b_cubic, TType RT, RhoType rhomolar, const VecType& molefrac) {
+/// Function that calculates the contact value of the radial distribution function, the same for all pairs of components
+template<typename BType, typename RhoType>
+inline auto get_g_vm_ref(radial_dist dist, BType b_cubic, RhoType rhomolar) {
 
     using eta_type = std::common_type_t<decltype(rhomolar), decltype(b_cubic)>;
     eta_type eta;
@@ -65,6 +56,14 @@ inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BT
             throw std::invalid_argument("Bad radial_dist");
         }
     }
+    return g_vm_ref;
+}
+
+/// Function that calculates the association binding strength between site A of molecule i and site B on molecule j
+template<typename BType, typename TType, typename RhoType, typename VecType>
+inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BType b_cubic, TType RT, RhoType rhomolar, const VecType& molefrac) {
+
+    auto g_vm_ref = get_g_vm_ref(dist, b_cubic, rhomolar);
 
     // Calculate the association strength between site Ai and Bi for a pure compent
     auto DeltaAiBj = forceeval(g_vm_ref*(exp(epsABi/RT) - 1.0)*b_cubic* betaABi);
@@ -157,6 +156,8 @@ public:
     template<typename VecType>
     auto R(const VecType& molefrac) const { return R_gas; }
 
+    const auto& get_bi() const { return bi; }
+
     template<typename TType>
     auto get_ai(TType T, int i) const {
         return forceeval(a0[i] * POW2(1.0 + c1[i]*(1.0 - sqrt(T / Tc[i]))));
@@ -188,6 +189,12 @@ public:
     }
 };
 
+/**
+ The association contribution of CPA, for any number of (associating or not) components
+
+ The combining rules are CR1 of Kontogeorgis et al., Ind. Eng. Chem. Res. 2006, 45, 4855 - 4868:
+ \f$\epsilon_{ij} = (\epsilon_i+\epsilon_j)/2\f$, \f$\beta_{ij} = \sqrt{\beta_i\beta_j}\f$, and the co-volume of the pair is \f$b_{ij} = (b_i+b_j)/2\f$
+ */
 template<typename Cubic>
 class CPAAssociation {
 private:
@@ -195,49 +202,36 @@ private:
     const std::vector<association_classes> classes;
     const radial_dist dist;
     const std::valarray<double> epsABi, betaABi;
-    const std::vector<int> N_sites; 
     const double R_gas;
+    const association::Association assoc;
 
-    auto get_N_sites(const std::vector<association_classes> &the_classes) {
-        std::vector<int> N_sites_out;
-        auto get_N = [](auto cl) {
-            switch (cl) {
-            case association_classes::a1A: return 1;
-            case association_classes::a2B: return 2;
-            case association_classes::a3B: return 3;
-            case association_classes::a4C: return 4;
-            default: throw std::invalid_argument("Bad association class");
-            }
-        };
-        for (auto cl : the_classes) {  
-            N_sites_out.push_back(get_N(cl));
+    auto build_association() const {
+        const auto& bi = cubic.get_bi();
+        if (classes.size() != bi.size() || epsABi.size() != bi.size() || betaABi.size() != bi.size()) {
+            throw teqp::InvalidArgument("The association parameters must be of the same length as the number of components");
         }
-        return N_sites_out;
+        auto combine = [&](std::size_t i, std::size_t j) {
+            double epsij_over_R = (epsABi[i] + epsABi[j]) / 2.0 / R_gas;
+            double volij = (bi[i] + bi[j]) / 2.0 * sqrt(betaABi[i] * betaABi[j]);
+            return std::make_tuple(epsij_over_R, volij);
+        };
+        return association::Association(association::build_site_matrices(classes, combine));
     }
 
 public:
     CPAAssociation(const Cubic &&cubic, const std::vector<association_classes>& classes, const radial_dist dist, const std::valarray<double> &epsABi, const std::valarray<double> &betaABi, double R_gas)
-        : cubic(cubic), classes(classes), dist(dist), epsABi(epsABi), betaABi(betaABi), N_sites(get_N_sites(classes)), R_gas(R_gas) {};
+        : cubic(cubic), classes(classes), dist(dist), epsABi(epsABi), betaABi(betaABi), R_gas(R_gas), assoc(build_association()) {};
+
+    const auto& get_association() const { return assoc; }
 
     template<typename TType, typename RhoType, typename VecType>
     auto alphar(const TType& T, const RhoType& rhomolar, const VecType& molefrac) const {
-        // Calculate a and b of the mixture
+        // Calculate b of the mixture, and from it the radial distribution function at contact
         auto [a_cubic, b_cubic] = cubic.get_ab(T, molefrac);
+        auto g_vm_ref = forceeval(get_g_vm_ref(dist, b_cubic, rhomolar));
 
-        // Calculate the fraction of sites not bonded with other active sites
-        auto RT = forceeval(R_gas * T); // R times T
-        auto XA = XA_calc_pure(N_sites[0], classes[0], dist, epsABi[0], betaABi[0], b_cubic, RT, rhomolar, molefrac);
-
-        using return_type = std::common_type_t<decltype(T), decltype(rhomolar), decltype(molefrac[0])>;
-        return_type alpha_r_asso = 0.0;
-        auto i = 0;
-        for (auto xi : molefrac){ // loop over all components
-            auto XAi = XA.col(i);
-            alpha_r_asso += forceeval(xi * (log(XAi) - XAi / 2).sum());
-            alpha_r_asso += xi*static_cast<double>(N_sites[i])/2;
-            i++;
-        }
-        return forceeval(alpha_r_asso);
+        // The same contact value applies to all pairs of components
+        return assoc.alphar(T, rhomolar, molefrac, [&g_vm_ref](std::size_t, std::size_t) { return g_vm_ref; });
     }
 };
 
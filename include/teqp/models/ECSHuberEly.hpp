@@ -19,8 +19,16 @@ private:
     double acentric_fluid, Z_crit_fluid, T_crit_fluid, rhomolar_crit_fluid;
     std::vector<double> f_T_coeffs, h_T_coeffs;
     
+    /// The reference fluid is built from its resolved multifluid specification if it has one (see resolve_ECSHuberEly1994_spec), otherwise from the file given by its name
+    static multifluid_t build_reference_model(const nlohmann::json& ref){
+        if (ref.contains("model")){
+            return multifluidfactory(ref.at("model"));
+        }
+        return build_multifluid_model({ref.at("name")}, "");
+    }
+    
 public:
-    ECSHuberEly1994(const nlohmann::json& j): reference_model(build_multifluid_model({j.at("reference_fluid").at("name")}, "")) {
+    ECSHuberEly1994(const nlohmann::json& j): reference_model(build_reference_model(j.at("reference_fluid"))) {
         const auto& ref = j.at("reference_fluid");
         acentric_reference = ref.at("acentric");
         Z_crit_reference = ref.at("Z_crit");
@@ -61,6 +69,15 @@ public:
     }
 };
 
+/// Pull the data of the reference fluid into the specification, so that the model can be rebuilt without the file given by its name
+inline nlohmann::json resolve_ECSHuberEly1994_spec(const nlohmann::json& spec){
+    auto resolved = spec;
+    auto& ref = resolved.at("reference_fluid");
+    if (!ref.contains("model")){
+        ref["model"] = resolve_multifluid_spec({{"components", nlohmann::json::array({ref.at("name")})}, {"root", ""}});
+    }
+    return resolved;
+}
 
 }
 }
@@ -0,0 +1,464 @@
+#pragma once
+
+/**
+ This header contains a general treatment of association in the framework of Wertheim's first-order
+ perturbation theory, to be shared by the models (CPA, PC-SAFT, ...) that add association to a non-associating
+ base model.
+
+ The model supplies the contact value of the radial distribution function for each pair of components and
+ the parameters of each pair of sites (after applying its combining rules); the site bookkeeping, the solution of the
+ mass-action equations, and the derivatives of the site fractions are handled here.
+ */
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/small_buffer.hpp"
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <complex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace teqp {
+
+namespace association {
+
+enum class association_classes {not_set, a1A, a2B, a3B, a4C, not_associating};
+
+inline auto get_association_classes(const std::string& s) {
+    if (s == "1A") { return association_classes::a1A; }
+    else if (s == "2B") { return association_classes::a2B; }
+    else if (s == "3B") { return association_classes::a3B; }
+    else if (s == "4C") { return association_classes::a4C; }
+    else if (s == "not_associating") { return association_classes::not_associating; }
+    else {
+        throw std::invalid_argument("bad association flag:" + s);
+    }
+}
+
+/// The kinds of sites. Sites bond with sites of the opposite sign, and a site of kind both (the only site of the 1A scheme) bonds with any site
+enum class site_kinds { positive, negative, both };
+
+inline bool can_bond(site_kinds a, site_kinds b) {
+    if (a == site_kinds::both || b == site_kinds::both) { return true; }
+    return a != b;
+}
+
+/// The distinct kinds of sites on one molecule, and how many sites of each kind there are
+struct SiteScheme {
+    std::vector<site_kinds> kinds;
+    std::vector<int> multiplicities;
+};
+
+/// The site schemes of Huang and Radosz, Ind. Eng. Chem. Res., 29 (11), 1990, with identical sites lumped together. For instance
+/// a 4C molecule (water) has two negative sites (lone pairs) and two positive sites (hydrogens), so only two site fractions are needed
+inline SiteScheme get_scheme(association_classes cl) {
+    switch (cl) {
+    case association_classes::a1A: return {{site_kinds::both}, {1}};
+    case association_classes::a2B: return {{site_kinds::negative, site_kinds::positive}, {1, 1}};
+    case association_classes::a3B: return {{site_kinds::negative, site_kinds::positive}, {2, 1}};
+    case association_classes::a4C: return {{site_kinds::negative, site_kinds::positive}, {2, 2}};
+    case association_classes::not_associating: return {{}, {}};
+    default: throw std::invalid_argument("Bad association class");
+    }
+}
+
+/**
+ The sites of a mixture, stored as flat arrays with one entry per distinct kind of site on each component, and the
+ parameters of the bond between each pair of sites. A pair of sites with a volume of zero does not bond.
+ */
+struct SiteMatrices {
+    Eigen::ArrayXi comp; ///< The index of the component that carries the site
+    Eigen::ArrayXd mult; ///< The number of sites of this kind on the molecule
+    Eigen::ArrayXXd epsilon_over_k, ///< [K] The association energy of the bond between two sites, divided by Boltzmann's constant
+        volume; ///< The association volume, in the units of the reciprocal of the density passed to the solver
+};
+
+/**
+ Build the site matrices from the association classes of the components, and a callable combine(i, j) returning the tuple
+ (epsilon_ij/k, volume_ij) of the bond between a site on component i and a site on component j, once the combining rules have been applied
+ */
+template<typename Combiner>
+inline SiteMatrices build_site_matrices(const std::vector<association_classes>& classes, const Combiner& combine) {
+    std::vector<int> comp, mult;
+    std::vector<site_kinds> kinds;
+    for (auto i = 0U; i < classes.size(); ++i) {
+        auto scheme = get_scheme(classes[i]);
+        for (auto k = 0U; k < scheme.kinds.size(); ++k) {
+            comp.push_back(static_cast<int>(i));
+            kinds.push_back(scheme.kinds[k]);
+            mult.push_back(scheme.multiplicities[k]);
+        }
+    }
+    const auto Nsites = static_cast<Eigen::Index>(comp.size());
+    SiteMatrices m;
+    m.comp.resize(Nsites); m.mult.resize(Nsites);
+    m.epsilon_over_k.resize(Nsites, Nsites); m.epsilon_over_k.setZero();
+    m.volume.resize(Nsites, Nsites); m.volume.setZero();
+    for (auto s = 0; s < Nsites; ++s) {
+        m.comp[s] = comp[s];
+        m.mult[s] = mult[s];
+        for (auto t = 0; t < Nsites; ++t) {
+            if (can_bond(kinds[s], kinds[t])) {
+                std::tie(m.epsilon_over_k(s, t), m.volume(s, t)) = combine(comp[s], comp[t]);
+            }
+        }
+    }
+    return m;
+}
+
+struct AssociationOptions {
+    double rtol = 1e-12; ///< Convergence is reached when no residual \f$X_s(1+\sum_t K_{st}X_t)-1\f$ of the mass-action equations exceeds this value
+    int max_iters = 100; ///< The maximum number of Newton steps on the mass-action equations
+};
+
+namespace internal {
+    /// The double value underneath a numerical type, peeling off as many layers as needed
+    template<typename T>
+    double get_double(const T& x) {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<double>(x);
+        }
+        else {
+            using B = std::decay_t<decltype(getbaseval(x))>;
+            if constexpr (std::is_same_v<B, T>) {
+                return static_cast<double>(x);
+            }
+            else {
+                return get_double(getbaseval(x));
+            }
+        }
+    }
+
+    /// The highest order of the derivatives carried by a numerical type. Types not listed (multicomplex, multiprecision, ...) get a generous
+    /// value, which also gives enough Newton steps to refine values in up to 256 bits
+    template<typename T> struct deriv_order { static constexpr int value = 15; };
+    template<> struct deriv_order<double> { static constexpr int value = 0; };
+    template<typename T> struct deriv_order<std::complex<T>> { static constexpr int value = 1; };
+    template<std::size_t N, typename T> struct deriv_order<autodiff::detail::Real<N, T>> { static constexpr int value = static_cast<int>(N) + deriv_order<T>::value; };
+    template<typename T, typename G> struct deriv_order<autodiff::detail::Dual<T, G>> { static constexpr int value = 1 + deriv_order<T>::value; };
+
+    /// The number of Newton steps in type T needed to get all the orders of the derivatives right, each step doubling the number of correct orders
+    template<typename T>
+    constexpr int get_ift_steps() {
+        int steps = 0;
+        while ((1 << steps) - 1 < deriv_order<T>::value) { ++steps; }
+        return steps;
+    }
+
+    /// Solve J*delta = r in place (r is overwritten with delta) by Gaussian elimination, with J an N x N matrix stored by rows.
+    /// The Jacobian of the mass-action equations, for site fractions in (0,1], is a diagonal similarity transformation of a strictly
+    /// diagonally dominant matrix (see Michelsen, Ind. Eng. Chem. Res., 2006 for the symmetric form), so pivoting is not needed, and only
+    /// arithmetic operations are required of the numerical type
+    template<typename T>
+    void solve_nopivot(T* J, T* r, Eigen::Index N) {
+        // The reciprocals of the pivots are kept on the diagonal
+        for (auto k = 0; k < N; ++k) {
+            J[k*N + k] = 1.0 / J[k*N + k];
+            for (auto i = k + 1; i < N; ++i) {
+                if constexpr (std::is_arithmetic_v<T>) {
+                    if (J[i*N + k] == 0.0) { continue; }
+                }
+                T f = J[i*N + k] * J[k*N + k];
+                for (auto j = k + 1; j < N; ++j) {
+                    J[i*N + j] = J[i*N + j] - f * J[k*N + j];
+                }
+                r[i] = r[i] - f * r[k];
+            }
+        }
+        for (auto k = N - 1; k >= 0; --k) {
+            T s = r[k];
+            for (auto j = k + 1; j < N; ++j) {
+                s = s - J[k*N + j] * r[j];
+            }
+            r[k] = s * J[k*N + k];
+        }
+    }
+}
+
+/**
+ The association contribution of Wertheim's theory for an arbitrary set of sites
+
+ The site fractions \f$X_s\f$ are the solution of the mass-action equations
+ \f[
+ X_s = \frac{1}{1+\rho\sum_t x_{c(t)} n_t \Delta_{st} X_t}
+ \f]
+ where \f$c(t)\f$ is the component carrying site \f$t\f$, \f$n_t\f$ the multiplicity of the site, and
+ \f$\Delta_{st} = g_{c(s)c(t)}\kappa_{st}[\exp(\epsilon_{st}/(kT))-1]\f$.
+
+ The mass-action equations are solved on doubles only, from the exact solution of a single self-associating site as initial guess.
+ The fractions of a set of sites that do not bond with each other (for the usual schemes, all the negative sites) are explicit
+ functions of the others, so they are updated by substitution, and Newton steps (limited as in Michelsen, Ind. Eng. Chem. Res., 2006)
+ are taken on the remaining fractions only, which halves the size of the linear systems for the usual schemes.
+
+ The derivatives with respect to temperature, density and composition are then obtained from the implicit function theorem,
+ rather than by differentiating through the iterations: starting from the converged site fractions, Newton steps are taken
+ in the numerical type of the arguments. Each such step doubles the number of correct orders of the derivatives
+ (the first one yields \f$\partial X/\partial p = -J^{-1}\partial F/\partial p\f$), and it also refines the values when the type
+ carries more precision than a double.
+ */
+class Association {
+private:
+    const SiteMatrices sites;
+    const AssociationOptions options;
+
+    // Flattened description of the pairs of sites that bond (s <= t)
+    std::vector<Eigen::Index> pair_s, pair_t, pair_comp, pair_eps;
+    std::vector<double> pair_volume;
+    std::vector<std::tuple<int, int>> comp_pairs; ///< The distinct pairs of components whose sites bond
+    std::vector<double> epsilons; ///< The distinct values of epsilon/k of the bonds
+    // The bonds of each site, in compressed sparse row form: site s bonds with bond_sites[e] for bond_offsets[s] <= e < bond_offsets[s+1]
+    std::vector<Eigen::Index> bond_offsets, bond_sites, bond_pair;
+    std::vector<Eigen::Index> iU, ///< The sites whose fractions are iterated upon
+        iV; ///< The sites, no two of which bond, whose fractions are eliminated from the Newton steps
+    std::vector<Eigen::Index> reduced_index; ///< The position of each site in iU or iV
+    std::vector<bool> eliminated; ///< Whether each site is in iV
+
+    void build_pairs() {
+        const auto Nsites = sites.comp.size();
+        if (sites.mult.size() != Nsites || sites.volume.rows() != Nsites || sites.volume.cols() != Nsites || sites.epsilon_over_k.rows() != Nsites || sites.epsilon_over_k.cols() != Nsites) {
+            throw teqp::InvalidArgument("The site matrices must all be sized for " + std::to_string(Nsites) + " sites");
+        }
+        if (((sites.volume - sites.volume.transpose()).abs() > 0).any() || ((sites.epsilon_over_k - sites.epsilon_over_k.transpose()).abs() > 0).any()) {
+            throw teqp::InvalidArgument("The site matrices must be symmetric");
+        }
+        auto index_of = [](auto& v, const auto& val) {
+            for (auto i = 0U; i < v.size(); ++i) { if (v[i] == val) { return static_cast<Eigen::Index>(i); } }
+            v.push_back(val); return static_cast<Eigen::Index>(v.size() - 1);
+        };
+        for (auto s = 0; s < Nsites; ++s) {
+            for (auto t = s; t < Nsites; ++t) {
+                if (sites.volume(s, t) == 0) { continue; }
+                auto ci = std::min(sites.comp[s], sites.comp[t]), cj = std::max(sites.comp[s], sites.comp[t]);
+                pair_s.push_back(s);
+                pair_t.push_back(t);
+                pair_comp.push_back(index_of(comp_pairs, std::make_tuple(ci, cj)));
+                pair_eps.push_back(index_of(epsilons, sites.epsilon_over_k(s, t)));
+                pair_volume.push_back(sites.volume(s, t));
+            }
+        }
+        // Greedily collect the sites that bond with none of the sites already collected; for the usual schemes these are all the negative sites
+        for (auto s = 0; s < Nsites; ++s) {
+            bool independent = (sites.volume(s, s) == 0);
+            for (auto v : iV) {
+                if (sites.volume(s, v) != 0) { independent = false; break; }
+            }
+            auto& group = (independent ? iV : iU);
+            reduced_index.push_back(static_cast<Eigen::Index>(group.size()));
+            eliminated.push_back(independent);
+            group.push_back(s);
+        }
+        bond_offsets.push_back(0);
+        for (auto s = 0; s < Nsites; ++s) {
+            for (auto p = 0U; p < pair_s.size(); ++p) {
+                if (pair_s[p] == s || pair_t[p] == s) {
+                    bond_sites.push_back(pair_s[p] == s ? pair_t[p] : pair_s[p]);
+                    bond_pair.push_back(p);
+                }
+            }
+            bond_offsets.push_back(static_cast<Eigen::Index>(bond_sites.size()));
+        }
+    }
+
+    /// The association strengths of the pairs of sites that bond
+    template<typename TType, typename GFunc, typename DType>
+    void fill_Delta_pairs(const TType& T, const GFunc& g, DType* Delta) const {
+        using g_t = std::decay_t<decltype(g(0, 0))>;
+        SmallBuffer<g_t> gvals(comp_pairs.size());
+        for (auto k = 0U; k < comp_pairs.size(); ++k) {
+            gvals[k] = g(std::get<0>(comp_pairs[k]), std::get<1>(comp_pairs[k]));
+        }
+        SmallBuffer<TType> Fvals(epsilons.size());
+        for (auto k = 0U; k < epsilons.size(); ++k) {
+            Fvals[k] = forceeval(exp(epsilons[k] / T) - 1.0);
+        }
+        for (auto p = 0U; p < pair_s.size(); ++p) {
+            Delta[p] = gvals[pair_comp[p]] * pair_volume[p] * Fvals[pair_eps[p]];
+        }
+    }
+
+    /// The fractions of the sites in V, which depend explicitly on those of the sites in U as no two sites in V bond
+    template<typename T>
+    void update_V(const T* K, T* X) const {
+        for (auto v : iV) {
+            T KXv = 0.0;
+            for (auto e = bond_offsets[v]; e < bond_offsets[v + 1]; ++e) {
+                KXv = KXv + K[e] * X[bond_sites[e]];
+            }
+            X[v] = 1.0 / (1.0 + KXv);
+        }
+    }
+
+    /// Update the fractions of the sites in V, evaluate the residuals of the mass-action equations of the sites in U, and return the largest of them
+    template<typename T>
+    double get_residuals(const T* K, T* X, T* KX, T* r) const {
+        update_V(K, X);
+        double maxresid = 0.0;
+        for (auto a = 0U; a < iU.size(); ++a) {
+            auto u = iU[a];
+            T KXu = 0.0;
+            for (auto e = bond_offsets[u]; e < bond_offsets[u + 1]; ++e) {
+                KXu = KXu + K[e] * X[bond_sites[e]];
+            }
+            KX[a] = KXu;
+            r[a] = X[u] * (1.0 + KXu) - 1.0;
+            const double absr = std::abs(internal::get_double(r[a]));
+            // std::max would silently drop a NaN, and the iteration would be taken as converged
+            if (!std::isfinite(absr)) {
+                throw teqp::IterationFailure("A residual of the mass-action equations for the site fractions is not finite");
+            }
+            maxresid = std::max(maxresid, absr);
+        }
+        return maxresid;
+    }
+
+    /// Overwrite the residuals with the Newton step for the fractions of the sites in U. The Jacobian is that of the equations with the
+    /// fractions of the sites in V eliminated, i.e., the Schur complement of the Jacobian of the full set of equations
+    template<typename T>
+    void get_newton_step(const T* K, const T* X, const T* KX, T* r, T* J) const {
+        const auto nU = static_cast<Eigen::Index>(iU.size());
+        for (auto k = 0; k < nU*nU; ++k) { J[k] = 0.0; }
+        for (auto a = 0; a < nU; ++a) {
+            auto u = iU[a];
+            T* Ja = J + a*nU;
+            for (auto e = bond_offsets[u]; e < bond_offsets[u + 1]; ++e) {
+                auto t = bond_sites[e];
+                if (!eliminated[t]) {
+                    Ja[reduced_index[t]] = Ja[reduced_index[t]] + X[u] * K[e];
+                    continue;
+                }
+                // Through dX_t/dX_u' = -X_t^2*K_tu'
+                T coeff = X[u] * K[e] * X[t] * X[t];
+                for (auto f = bond_offsets[t]; f < bond_offsets[t + 1]; ++f) {
+                    auto uprime = reduced_index[bond_sites[f]];
+                    Ja[uprime] = Ja[uprime] - coeff * K[f];
+                }
+            }
+            Ja[a] = Ja[a] + 1.0 + KX[a];
+        }
+        internal::solve_nopivot(J, r, nU);
+    }
+
+    /// Solve the mass-action equations for the site fractions, given the association strengths of the pairs of sites that bond
+    template<typename RhoType, typename VecType, typename DType, typename XType>
+    void solve_X(const RhoType& rhoN, const VecType& molefracs, const DType* Delta, XType* Xout) const {
+        using K_t = std::decay_t<XType>;
+        const auto Nsites = get_Nsites();
+        const auto nU = static_cast<Eigen::Index>(iU.size());
+        const auto Nbonds = bond_sites.size();
+
+        // K_st = rho*x_c(t)*n_t*Delta_st for each bond, so that the mass-action equations read X_s*(1 + sum_t K_st*X_t) = 1
+        SmallBuffer<double, 64> K(Nbonds), J(nU*nU);
+        for (auto e = 0U; e < Nbonds; ++e) {
+            auto t = bond_sites[e];
+            K[e] = internal::get_double(rhoN * molefracs[sites.comp[t]]) * sites.mult[t] * internal::get_double(Delta[bond_pair[e]]);
+        }
+
+        // Newton's method in double precision, from the solution of a single self-associating site with the total strength of all its bonds
+        SmallBuffer<double> X(Nsites), KX(nU), r(nU);
+        for (auto s = 0; s < Nsites; ++s) {
+            double Ksum = 0.0;
+            for (auto e = bond_offsets[s]; e < bond_offsets[s + 1]; ++e) { Ksum += K[e]; }
+            X[s] = 2.0 / (1.0 + sqrt(1.0 + 4.0 * Ksum));
+        }
+        bool converged = false;
+        for (auto iter = 0; iter <= options.max_iters; ++iter) {
+            if (get_residuals(K.data(), X.data(), KX.data(), r.data()) <= options.rtol) {
+                converged = true; break;
+            }
+            if (iter == options.max_iters) { break; }
+            get_newton_step(K.data(), X.data(), KX.data(), r.data(), J.data());
+            for (auto a = 0; a < nU; ++a) {
+                // Limit the step to keep the site fractions in (0, 1], Michelsen, Ind. Eng. Chem. Res., 2006
+                auto u = iU[a];
+                double Xnew = X[u] - r[a];
+                X[u] = (Xnew <= 0) ? 0.2 * X[u] : std::min(Xnew, 1.0);
+            }
+        }
+        if (!converged) {
+            throw teqp::IterationFailure("Solution of the mass-action equations for the site fractions did not converge");
+        }
+        for (auto s = 0; s < Nsites; ++s) { Xout[s] = X[s]; }
+
+        constexpr int ift_steps = internal::get_ift_steps<K_t>();
+        if constexpr (ift_steps > 0) {
+            // Implicit function theorem, by Newton steps in the numerical type of the arguments
+            Eigen::Array<K_t, Eigen::Dynamic, 1> Kad(Nbonds), Jad(nU*nU), KXad(nU), rad(nU);
+            for (auto e = 0U; e < Nbonds; ++e) {
+                auto t = bond_sites[e];
+                Kad[e] = rhoN * molefracs[sites.comp[t]] * sites.mult[t] * Delta[bond_pair[e]];
+            }
+            for (auto step = 0; step < ift_steps; ++step) {
+                get_residuals(Kad.data(), Xout, KXad.data(), rad.data());
+                get_newton_step(Kad.data(), Xout, KXad.data(), rad.data(), Jad.data());
+                for (auto a = 0; a < nU; ++a) {
+                    Xout[iU[a]] = Xout[iU[a]] - rad[a];
+                }
+            }
+            update_V(Kad.data(), Xout);
+        }
+    }
+
+public:
+    Association(const SiteMatrices& sites, const AssociationOptions& options = {}) : sites(sites), options(options) {
+        build_pairs();
+    }
+
+    auto get_Nsites() const { return sites.comp.size(); }
+    const auto& get_site_matrices() const { return sites; }
+
+    /// The matrix of association strengths \f$\Delta_{st}\f$, given a callable g(i, j) returning the contact value of the radial distribution function of components i and j
+    template<typename TType, typename GFunc>
+    auto get_Delta(const TType& T, const GFunc& g) const {
+        using D_t = std::common_type_t<TType, std::decay_t<decltype(g(0, 0))>>;
+        Eigen::Array<D_t, Eigen::Dynamic, 1> Dpairs(pair_s.size());
+        fill_Delta_pairs(T, g, Dpairs.data());
+        Eigen::Array<D_t, Eigen::Dynamic, Eigen::Dynamic> Delta(get_Nsites(), get_Nsites());
+        Delta.setZero();
+        for (auto p = 0U; p < pair_s.size(); ++p) {
+            Delta(pair_s[p], pair_t[p]) = Dpairs[p];
+            Delta(pair_t[p], pair_s[p]) = Dpairs[p];
+        }
+        return Delta;
+    }
+
+    /// The fractions of sites not bonded, one per distinct kind of site, given the number density (in the units consistent with the volumes) and the matrix of association strengths
+    template<typename RhoType, typename VecType, typename DeltaType>
+    auto get_X(const RhoType& rhoN, const VecType& molefracs, const DeltaType& Delta) const {
+        using D_t = typename DeltaType::Scalar;
+        using K_t = std::common_type_t<RhoType, std::decay_t<decltype(molefracs[0])>, D_t>;
+        Eigen::Array<D_t, Eigen::Dynamic, 1> Dpairs(pair_s.size());
+        for (auto p = 0U; p < pair_s.size(); ++p) {
+            Dpairs[p] = Delta(pair_s[p], pair_t[p]);
+        }
+        Eigen::Array<K_t, Eigen::Dynamic, 1> X(get_Nsites());
+        solve_X(rhoN, molefracs, Dpairs.data(), X.data());
+        return X;
+    }
+
+    /// The contribution of association to \f$\alpha^{\rm r}\f$, given the number density and a callable g(i, j) as in get_Delta
+    template<typename TType, typename RhoType, typename VecType, typename GFunc>
+    auto alphar(const TType& T, const RhoType& rhoN, const VecType& molefracs, const GFunc& g) const {
+        using x_t = std::decay_t<decltype(molefracs[0])>;
+        using D_t = std::common_type_t<TType, std::decay_t<decltype(g(0, 0))>>;
+        using X_t = std::common_type_t<RhoType, x_t, D_t>;
+        const auto Nsites = get_Nsites();
+        SmallBuffer<D_t, 64> Delta(pair_s.size());
+        fill_Delta_pairs(T, g, Delta.data());
+        SmallBuffer<X_t> X(Nsites);
+        solve_X(rhoN, molefracs, Delta.data(), X.data());
+
+        std::common_type_t<X_t, x_t> alpha_r_asso = 0.0;
+        for (auto s = 0; s < Nsites; ++s) {
+            alpha_r_asso += molefracs[sites.comp[s]] * sites.mult[s] * (log(X[s]) - X[s] / 2.0 + 0.5);
+        }
+        return forceeval(alpha_r_asso);
+    }
+};
+
+}; /* namespace association */
+
+}; // namespace teqp
@@ -5,8 +5,12 @@ Implementations of the canonical cubic equations of state
 */
 
 #include <vector>
+#include <cmath>
+#include <algorithm>
 #include <variant>
 #include <valarray>
+#include <array>
+#include <tuple>
 #include <optional>
 
 #include "teqp/types.hpp"
@@ -140,6 +144,7 @@ protected:
     int superanc_index;
     const AlphaFunctions alphas;
     Eigen::ArrayXXd kmat;
+    bool kmat_is_zero; ///< If all k_ij are zero, a is the square of a linear combination of the sqrt(a_i*alpha_i)
     
     nlohmann::json meta;
     
@@ -173,6 +178,7 @@ public:
             bi[i] = OmegaB * Ru * Tc_K[i] / pc_Pa[i];
         }
         check_kmat(ai.size());
+        kmat_is_zero = (kmat == 0.0).all();
     };
     
     void set_meta(const nlohmann::json& j) { meta = j; }
@@ -215,18 +221,48 @@ public:
         return Ru;
     }
     
+    /// The values of \f$\sqrt{a_i\alpha_i(T)}\f$, in terms of which \f$a_{ij} = (1-k_{ij})\sqrt{a_i\alpha_ia_j\alpha_j}\f$; each alpha function is evaluated once
+    template<typename TType>
+    auto get_sqrt_aialpha(const TType& T) const {
+        std::vector<std::common_type_t<TType, NumType>> s(ai.size());
+        for (auto i = 0U; i < s.size(); ++i) {
+            s[i] = forceeval(sqrt(ai[i]*std::visit([&](auto& t) { return t(T); }, alphas[i])));
+        }
+        return s;
+    }
+    
+    /**
+     * \brief The matrix of \f$a_{ij} = (1-k_{ij})\sqrt{a_i\alpha_ia_j\alpha_j}\f$ at the given temperature
+     *
+     * The matrix can be retained by the caller to evaluate \f$a = \mathbf{z}^{\rm T}\mathbf{A}\mathbf{z}\f$ for many compositions at the same temperature
+     */
+    auto get_aij(const double T) const {
+        const auto s = get_sqrt_aialpha(T);
+        Eigen::ArrayXXd aij(s.size(), s.size());
+        for (auto i = 0U; i < s.size(); ++i) {
+            for (auto j = 0U; j < s.size(); ++j) {
+                aij(i,j) = (1.0 - kmat(i,j)) * s[i] * s[j];
+            }
+        }
+        return aij;
+    }
+    
     template<typename TType, typename CompType>
     auto get_a(TType T, const CompType& molefracs) const {
+        const auto s = get_sqrt_aialpha(T);
         std::common_type_t<TType, decltype(molefracs[0])> a_ = 0.0;
+        if (kmat_is_zero) {
+            for (auto i = 0; i < molefracs.size(); ++i) {
+                a_ = a_ + molefracs[i] * s[i];
+            }
+            return forceeval(a_ * a_);
+        }
         for (auto i = 0; i < molefracs.size(); ++i) {
-            auto alphai = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[i]));
-            auto ai_ = forceeval(this->ai[i] * alphai);
+            std::common_type_t<TType, decltype(molefracs[0])> row = 0.0;
             for (auto j = 0; j < molefracs.size(); ++j) {
-                auto alphaj = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[j]));
-                auto aj_ = this->ai[j] * alphaj;
-                auto aij = forceeval((1 - kmat(i,j)) * sqrt(ai_ * aj_));
-                a_ = a_ + molefracs[i] * molefracs[j] * aij;
+                row = row + (1 - kmat(i,j)) * molefracs[j] * s[j];
             }
+            a_ = a_ + molefracs[i] * s[i] * row;
         }
         return forceeval(a_);
     }
@@ -254,6 +290,137 @@ public:
         auto val = Psiminus - get_a(T, molefrac) / (Ru * T) * Psiplus;
         return forceeval(val);
     }
+
+    /// Closed-form density and composition derivatives are provided for double precision parameters, see has_analytic_derivatives
+    static constexpr bool analytic_derivatives = std::is_same_v<NumType, double>;
+
+    /**
+     * \brief Density derivatives of the repulsive and attractive parts of alphar
+     *
+     * With \f$\beta = b\rho\f$, \f$\Psi^- = -\ln(1-\beta)\f$, and \f$\Psi^+ = \ln\left(\frac{1+\Delta_1\beta}{1+\Delta_2\beta}\right)/(b(\Delta_1-\Delta_2))\f$,
+     * returns the arrays of \f$\rho^n(\partial^n\Psi^-/\partial\rho^n)\f$ and \f$\rho^n(\partial^n\Psi^+/\partial\rho^n)\f$ for \f$n=0,\ldots,N\f$,
+     * which follow from \f$\rho^n\frac{\partial^n\ln(1+\Delta b\rho)}{\partial\rho^n} = (-1)^{n-1}(n-1)!\left(\frac{\Delta\beta}{1+\Delta\beta}\right)^n\f$
+     */
+    template<int Nderiv>
+    auto get_Psi_rhoderivs(const double b, const double rho) const {
+        std::array<double, Nderiv+1> minus, plus;
+        const double beta = b*rho, denom = b*(Delta1 - Delta2);
+        minus[0] = -log(1.0 - beta);
+        plus[0] = log((Delta1*beta + 1.0)/(Delta2*beta + 1.0))/denom;
+        const double u = beta/(1.0 - beta), v1 = Delta1*beta/(1.0 + Delta1*beta), v2 = Delta2*beta/(1.0 + Delta2*beta);
+        double un = 1.0, v1n = 1.0, v2n = 1.0, factorial = 1.0;
+        for (auto n = 1; n <= Nderiv; ++n) {
+            un *= u; v1n *= v1; v2n *= v2;
+            if (n > 1) { factorial *= (n - 1); }
+            minus[n] = factorial*un;
+            plus[n] = ((n % 2 == 1) ? 1.0 : -1.0)*factorial*(v1n - v2n)/denom;
+        }
+        return std::make_tuple(minus, plus);
+    }
+
+    /// The values of \f$\rho^n(\partial^n\alpha^r/\partial\rho^n)\f$ for \f$n=0,\ldots,iD\f$, equivalent to TDXDerivatives::get_Ar0n
+    template<int iD, typename MoleFracType>
+    auto get_Ar0n_analytic(const double T, const double rho, const MoleFracType& molefrac) const {
+        if (molefrac.size() != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        const double aRT = get_a(T, molefrac)/(Ru*T);
+        const auto [minus, plus] = get_Psi_rhoderivs<iD>(get_b(T, molefrac), rho);
+        std::valarray<double> o(iD + 1);
+        for (auto n = 0; n <= iD; ++n) {
+            o[n] = minus[n] - aRT*plus[n];
+        }
+        return o;
+    }
+
+    /**
+     * \brief Gradient of \f$\Psi^{\rm r}=\alpha^{\rm r}\rho RT\f$ w.r.t. the molar concentrations, equivalent to IsochoricDerivatives::build_Psir_gradient
+     *
+     * With \f$\beta = \sum_i\rho_ib_i\f$ and \f$A = a\rho^2 = \sum_i\sum_j\rho_i\rho_ja_{ij}\f$,
+     * \f[
+     * \frac{\Psi^{\rm r}}{RT} = -\rho\ln(1-\beta) - \frac{A}{RT(\Delta_1-\Delta_2)}\frac{L(\beta)}{\beta}, \quad L(\beta) = \ln\left(\frac{1+\Delta_1\beta}{1+\Delta_2\beta}\right)
+     * \f]
+     * which is differentiated term by term
+     */
+    template<typename RhoVecType>
+    auto get_Psir_gradient_analytic(const double T, const RhoVecType& rhovec) const {
+        const auto N = rhovec.size();
+        if (static_cast<std::size_t>(N) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        const auto s = get_sqrt_aialpha(T);
+        // dA/drho_i as well as A itself, and beta
+        Eigen::ArrayXd dAdrhoi(N);
+        double A = 0.0, beta = 0.0, rhotot = 0.0;
+        for (auto i = 0; i < N; ++i) {
+            double row = 0.0, sym = 0.0;
+            for (auto j = 0; j < N; ++j) {
+                row += (1.0 - kmat(i,j))*s[j]*rhovec[j];
+                sym += (2.0 - kmat(i,j) - kmat(j,i))*s[j]*rhovec[j];
+            }
+            A += rhovec[i]*s[i]*row;
+            dAdrhoi[i] = s[i]*sym;
+            beta += rhovec[i]*bi[i];
+            rhotot += rhovec[i];
+        }
+        // L/beta and its derivative w.r.t. beta, with their limits as beta goes to zero
+        double L_beta = Delta1 - Delta2, dL_beta = -(Delta1*Delta1 - Delta2*Delta2)/2.0;
+        if (beta != 0.0) {
+            const double L = log((1.0 + Delta1*beta)/(1.0 + Delta2*beta));
+            const double dLdbeta = Delta1/(1.0 + Delta1*beta) - Delta2/(1.0 + Delta2*beta);
+            L_beta = L/beta;
+            dL_beta = (dLdbeta - L_beta)/beta;
+        }
+        const double RT = Ru*T, D = Delta1 - Delta2, lnrep = -log(1.0 - beta);
+        Eigen::ArrayXd o(N);
+        for (auto i = 0; i < N; ++i) {
+            o[i] = RT*(lnrep + rhotot*bi[i]/(1.0 - beta)) - (dAdrhoi[i]*L_beta + A*dL_beta*bi[i])/D;
+        }
+        return o;
+    }
+    
+    /**
+     * \brief The molar densities at given temperature and pressure, from the closed-form roots of the cubic in the compressibility factor
+     *
+     * With \f$A = ap/(RT)^2\f$ and \f$B = bp/(RT)\f$, the EOS is
+     * \f[
+     * Z^3 + ((\Delta_1+\Delta_2-1)B-1)Z^2 + (A+\Delta_1\Delta_2B^2-(\Delta_1+\Delta_2)(B^2+B))Z - (AB+\Delta_1\Delta_2B^2(B+1)) = 0
+     * \f]
+     * The real roots are obtained with the trigonometric method (three real roots) or Cardano's formula (one real root), and each is polished with a Newton step
+     * \returns The physical densities (positive, and less than \f$1/b\f$), in increasing order; the middle one of three is mechanically unstable
+     */
+    template<typename MoleFracType>
+    std::vector<double> get_rho_Tp_roots(const double T, const double p, const MoleFracType& molefrac) const {
+        const double RT = Ru*T, a = get_a(T, molefrac), b = get_b(T, molefrac);
+        const double A = a*p/(RT*RT), B = b*p/RT, S = Delta1 + Delta2, P = Delta1*Delta2;
+        // Monic cubic Z^3 + c2*Z^2 + c1*Z + c0
+        const double c2 = (S - 1.0)*B - 1.0, c1 = A + P*B*B - S*(B*B + B), c0 = -(A*B + P*B*B*(B + 1.0));
+        // Depressed cubic t^3 + q1*t + q0 = 0 with Z = t - c2/3
+        const double shift = -c2/3.0, q1 = c1 - c2*c2/3.0, q0 = 2.0*c2*c2*c2/27.0 - c2*c1/3.0 + c0;
+        const double disc = q0*q0/4.0 + q1*q1*q1/27.0;
+        std::vector<double> Zs;
+        if (disc < 0) {
+            const double r = 2.0*sqrt(-q1/3.0), phi = acos(std::clamp(3.0*q0/(q1*r), -1.0, 1.0))/3.0;
+            for (auto k = 0; k < 3; ++k) {
+                Zs.push_back(shift + r*cos(phi - 2.0*EIGEN_PI*k/3.0));
+            }
+        }
+        else {
+            const double sq = sqrt(disc);
+            Zs.push_back(shift + std::cbrt(-q0/2.0 + sq) + std::cbrt(-q0/2.0 - sq));
+        }
+        std::vector<double> rhos;
+        for (auto Z : Zs) {
+            const double f = ((Z + c2)*Z + c1)*Z + c0, dfdZ = (3.0*Z + 2.0*c2)*Z + c1;
+            if (dfdZ != 0.0) { Z -= f/dfdZ; }
+            const double rho = p/(Z*RT);
+            if (Z > 0 && rho*b < 1.0) {
+                rhos.push_back(rho);
+            }
+        }
+        std::sort(rhos.begin(), rhos.end());
+        return rhos;
+    }
 };
 
 template <typename TCType, typename PCType, typename AcentricType>
@@ -576,6 +743,7 @@ protected:
     const AlphaFunctions alphas;
     const ResidualHelmholtzOverRTVariant ares;
     Eigen::ArrayXXd lmat;
+    Eigen::ArrayXXd bij; ///< The cross covolumes of the quadratic mixing rule, which are independent of temperature
     
     const AdvancedPRaEMixingRules brule;
     const double s;
@@ -616,6 +784,12 @@ public:
             bi[i] = OmegaB * Ru * Tc_K[i] / pc_Pa[i];
         }
         check_lmat(ai.size());
+        bij.resize(ai.size(), ai.size());
+        for (auto i = 0; i < bij.rows(); ++i) {
+            for (auto j = 0; j < bij.cols(); ++j) {
+                bij(i,j) = (1 - lmat(i,j)) * pow((pow(bi[i], 1.0/s) + pow(bi[j], 1.0/s))/2.0, s);
+            }
+        }
     };
     
     void set_meta(const nlohmann::json& j) { meta = j; }
@@ -688,12 +862,8 @@ public:
         switch (brule){
             case AdvancedPRaEMixingRules::kQuadratic:
                 for (auto i = 0; i < molefracs.size(); ++i) {
-                    auto bi_ = get_bi(T, i);
                     for (auto j = 0; j < molefracs.size(); ++j) {
-                        auto bj_ = get_bi(T, j);
-                        
-                        auto bij = (1 - lmat(i,j)) * pow((pow(bi_, 1.0/s) + pow(bj_, 1.0/s))/2.0, s);
-                        b_ += molefracs[i] * molefracs[j] * bij;
+                        b_ += molefracs[i] * molefracs[j] * bij(i,j);
                     }
                 }
                 break;
@@ -824,14 +994,17 @@ public:
         numtype b = 0.0;
         numtype a = 0.0;
         std::size_t N = alphas.size();
+        // The pure-component parameters are evaluated once each, outside the double loop
+        std::vector<std::decay_t<decltype(get_bi(0, T))>> bis(N);
+        std::vector<std::decay_t<decltype(forceeval(sqrt(get_ai(0, T))))>> sqrtais(N);
+        for (auto i = 0; i < N; ++i){
+            bis[i] = get_bi(i, T);
+            sqrtais[i] = forceeval(sqrt(get_ai(i, T)));
+        }
         for (auto i = 0; i < N; ++i){
-            auto bi = get_bi(i, T);
-            auto ai = get_ai(i, T);
             for (auto j = 0; j < N; ++j){
-                auto bj = get_bi(j, T);
-                auto aj = get_ai(j, T);
-                b += z[i]*z[j]*(bi + bj)/2.0*(1.0 - lmat(i,j));
-                a += z[i]*z[j]*sqrt(ai*aj)*(1.0 - kmat(i,j));
+                b += z[i]*z[j]*(bis[i] + bis[j])/2.0*(1.0 - lmat(i,j));
+                a += z[i]*z[j]*sqrtais[i]*sqrtais[j]*(1.0 - kmat(i,j));
             }
         }
         return std::make_tuple(a, b);
@@ -959,16 +1132,15 @@ public:
         numtype b = 0.0;
         numtype a = 0.0;
         std::size_t N = delta_1.size();
+        // The temperature-dependent a_i are evaluated once each, outside the double loop
+        std::vector<std::decay_t<decltype(forceeval(sqrt(get_ai(0, T))))>> sqrtais(N);
+        for (auto i = 0; i < N; ++i){
+            sqrtais[i] = forceeval(sqrt(get_ai(i, T)));
+        }
         for (auto i = 0; i < N; ++i){
-            auto bi = get_bi(i, T);
-            auto ai = get_ai(i, T);
             for (auto j = 0; j < N; ++j){
-                auto aj = get_ai(j, T);
-                auto bj = get_bi(j, T);
-                
-                a += z[i]*z[j]*sqrt(ai*aj)*(1.0 - kmat(i,j));
-                b += z[i]*z[j]*(bi + bj)/2.0*(1.0 - lmat(i,j));
-                
+                a += z[i]*z[j]*sqrtais[i]*sqrtais[j]*(1.0 - kmat(i,j));
+                b += z[i]*z[j]*(b_c[i] + b_c[j])/2.0*(1.0 - lmat(i,j));
             }
         }
         return std::make_tuple(a, b);
@@ -1,69 +1,170 @@
 #pragma once 
 #include <vector>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include "teqp/math/chebyshev.hpp"
 
 namespace teqp {
 
 namespace CubicSuperAncillary {
 
-struct Chebyshev{
-public:
-    const std::vector<double> coeff;
-    const double xmin, xmax;
-    // Evaluate the expansion with Clenshaw's method
-    double y(double x) const{
-        // Scale to (-1, 1)
-        double xscaled = (2*x - (xmax + xmin)) / (xmax - xmin);
-        int Norder = static_cast<int>(coeff.size()) - 1;
-        double u_k = 0, u_kp1 = coeff[Norder], u_kp2 = 0;
-        for (int k = Norder-1; k > 0; k--){ // k must be signed!
-            // Do the recurrent calculation
-            u_k = 2.0*xscaled*u_kp1 - u_kp2 + coeff[k];
-            // Update the values
-            u_kp2 = u_kp1; u_kp1 = u_k;
-        }
-        return coeff[0] + xscaled*u_kp1 - u_kp2;
-    };
-};
+/// The expansions of the superancillaries are the general ones from teqp/math/chebyshev.hpp
+using Chebyshev = teqp::ChebyshevExpansion;
 
-// https://proquest.safaribooksonline.com/9780321637413
-// https://web.stanford.edu/class/archive/cs/cs107/cs107.1202/lab1/
-static int midpoint_Knuth(int x, int y) {
-    return (x & y) + ((x ^ y) >> 1);
-};
+/**
+ A set of Chebyshev expansions over contiguous intervals in Ttilde
 
+ The coefficients of all the expansions are flattened into one contiguous buffer, padded with zeros to a fixed number of
+ coefficients per expansion. The expansion containing x is found without bisection from a lookup table over a uniform grid
+ in x: each cell stores the index of the expansion containing its left edge, and the few expansions that begin within the
+ cell (only close to the critical point, where the intervals are very small) are skipped over with a linear scan.
+ */
 struct SuperAncillary{
 public:
+    const std::size_t Nexps; ///< The number of expansions
+    const int Ncoeff; ///< The number of coefficients of each expansion
+    const std::vector<double> coeffs; ///< The coefficients of expansion i are in positions [i*Ncoeff, (i+1)*Ncoeff)
+    const std::vector<double> xmins, xmaxs;
+    /// The values of the expansions at the boundaries of the intervals, for the inverse lookup
+    const std::vector<double> ybounds;
+private:
+    const std::size_t Ncells;
+    const double inv_cell_width;
+    const std::vector<std::size_t> cell_index;
 
-    const std::vector<Chebyshev> exps;
-
-    int get_index(double x) const{
-        int iL = 0, iR = static_cast<int>(exps.size()) - 1, iM;
-        while (iR - iL > 1) {
-            iM = midpoint_Knuth(iL, iR);
-            if (x >= exps[iM].xmin) {
-                iL = iM;
-            }
-            else {
-                iR = iM;
-            }
+    static std::size_t get_Ncoeff(const std::vector<Chebyshev>& exps){
+        std::size_t N = 0;
+        for (const auto& e : exps){ N = std::max(N, e.coeff.size()); }
+        return N;
+    }
+    static std::vector<double> flatten(const std::vector<Chebyshev>& exps){
+        auto N = get_Ncoeff(exps);
+        std::vector<double> o(N*exps.size(), 0.0);
+        for (auto i = 0U; i < exps.size(); ++i){
+            std::copy(exps[i].coeff.begin(), exps[i].coeff.end(), o.begin() + i*N);
+        }
+        return o;
+    }
+    template<typename Getter>
+    static std::vector<double> collect(const std::vector<Chebyshev>& exps, Getter g){
+        std::vector<double> o;
+        for (const auto& e : exps){ o.push_back(g(e)); }
+        return o;
+    }
+    /// One cell per smallest interval, as a power of two, but not more than 1024 cells
+    static std::size_t get_Ncells(const std::vector<Chebyshev>& exps){
+        double wmin = exps[0].xmax - exps[0].xmin;
+        for (const auto& e : exps){ wmin = std::min(wmin, e.xmax - e.xmin); }
+        std::size_t N = 1;
+        while (N < 1024 && N*wmin < exps.back().xmax - exps[0].xmin){ N *= 2; }
+        return N;
+    }
+    std::vector<std::size_t> build_cell_index() const {
+        std::vector<std::size_t> o(Ncells);
+        std::size_t i = 0;
+        for (auto c = 0U; c < Ncells; ++c){
+            double xleft = xmins[0] + c/inv_cell_width;
+            while (i + 1 < Nexps && xleft >= xmins[i+1]){ ++i; }
+            o[c] = i;
         }
-        return (x < exps[iL].xmax) ? iL : iR;
+        return o;
+    }
+public:
+    SuperAncillary(const std::vector<Chebyshev>& exps) :
+        Nexps(exps.size()),
+        Ncoeff(static_cast<int>(get_Ncoeff(exps))),
+        coeffs(flatten(exps)),
+        xmins(collect(exps, [](const Chebyshev& e){ return e.xmin; })),
+        xmaxs(collect(exps, [](const Chebyshev& e){ return e.xmax; })),
+        ybounds(internal::get_interval_bounds(exps, [](const Chebyshev& e, double x){ return e.eval(x); })),
+        Ncells(get_Ncells(exps)),
+        inv_cell_width(Ncells/(exps.back().xmax - exps[0].xmin)),
+        cell_index(build_cell_index()){};
+
+    double get_xmin() const { return xmins[0]; }
+    double get_xmax() const { return xmaxs.back(); }
+
+    std::size_t get_index(double x) const{
+        auto c = std::min(static_cast<std::size_t>((x - xmins[0])*inv_cell_width), Ncells - 1);
+        auto i = cell_index[c];
+        // Round-off in the location of the cell can put x just before the expansion stored for the cell
+        while (i > 0 && x < xmins[i]){ --i; }
+        while (i + 1 < Nexps && x >= xmins[i+1]){ ++i; }
+        return i;
     };
 
+    void check_range(double x) const{
+        if (x < get_xmin()) {
+            throw std::invalid_argument("Ttilde (" + std::to_string(x) + ") is below the minimum of " + std::to_string(get_xmin()));
+        }
+        if (x > get_xmax()) {
+            throw std::invalid_argument("Ttilde (" + std::to_string(x) + ") is above the maximum of " + std::to_string(get_xmax()));
+        }
+    }
+
     /// Evaluate the SuperAncillary
     double y(double x) const{
         // First check whether the input is possible
-        if (x < exps[0].xmin) {
-            throw std::invalid_argument("Ttilde (" + std::to_string(x) + ") is below the minimum of " + std::to_string(exps[0].xmin));
+        check_range(x);
+        auto i = get_index(x);
+        // Evaluate the expansion with Clenshaw's method, after scaling to (-1, 1)
+        double xscaled = (2*x - (xmaxs[i] + xmins[i])) / (xmaxs[i] - xmins[i]);
+        const double* c = &(coeffs[i*Ncoeff]);
+        double u_k = 0, u_kp1 = 0, u_kp2 = 0;
+        for (int k = Ncoeff-1; k > 0; k--){ // k must be signed!
+            u_k = 2.0*xscaled*u_kp1 - u_kp2 + c[k];
+            u_kp2 = u_kp1; u_kp1 = u_k;
         }
-        if (x > exps.back().xmax) {
-            throw std::invalid_argument("Ttilde (" + std::to_string(x) + ") is above the maximum of " + std::to_string(exps.back().xmax));
+        return c[0] + xscaled*u_kp1 - u_kp2;
+    }
+
+    /**
+     Evaluate the SuperAncillary at the N values of x, into y
+
+     The points are processed in blocks, and the Clenshaw recurrences of the points of a block are carried out together, so that
+     they are independent of each other and the compiler can vectorize them
+     */
+    void y_many(const double* x, double* y, std::size_t N) const{
+        constexpr std::size_t B = 8;
+        for (std::size_t i0 = 0; i0 < N; i0 += B){
+            auto Nb = std::min(B, N - i0);
+            const double* c[B];
+            double xscaled[B], u_kp1[B], u_kp2[B];
+            for (auto j = 0U; j < B; ++j){
+                // Extra points in the last block repeat the first point of the block
+                double xj = x[i0 + ((j < Nb) ? j : 0)];
+                check_range(xj);
+                auto i = get_index(xj);
+                c[j] = &(coeffs[i*Ncoeff]);
+                xscaled[j] = (2*xj - (xmaxs[i] + xmins[i])) / (xmaxs[i] - xmins[i]);
+                u_kp1[j] = 0; u_kp2[j] = 0;
+            }
+            for (int k = Ncoeff-1; k > 0; k--){
+                for (auto j = 0U; j < B; ++j){
+                    double u_k = 2.0*xscaled[j]*u_kp1[j] - u_kp2[j] + c[j][k];
+                    u_kp2[j] = u_kp1[j]; u_kp1[j] = u_k;
+                }
+            }
+            for (auto j = 0U; j < Nb; ++j){
+                y[i0 + j] = c[j][0] + xscaled[j]*u_kp1[j] - u_kp2[j];
+            }
         }
-        // Bisection to find the expansion
-        // we need
-        auto i = get_index(x);
-        // Evaluate the expansion
-        return exps[i].y(x);
+    }
+
+    /// Evaluate the SuperAncillary at each of the values of x
+    std::vector<double> y_many(const std::vector<double>& x) const{
+        std::vector<double> y(x.size());
+        y_many(x.data(), y.data(), x.size());
+        return y;
+    }
+
+    /// Solve for the value of x at which the SuperAncillary is equal to y; all the superancillaries are monotonic in Ttilde
+    double solve_for_x(double y) const{
+        // Lookup of the expansion from the values at the boundaries of the intervals, by bisection
+        auto i = internal::get_monotonic_interval(ybounds, y);
+        // Root finding within the expansion
+        return internal::Chebyshev_solve_monotonic(&(coeffs[i*Ncoeff]), Ncoeff - 1, xmins[i], xmaxs[i], y);
     }
 };
 
@@ -3849,6 +3950,34 @@ static inline double supercubic(int EOS, int prop, double Ttilde){
     }
 }
 
+/// The superancillary of the given property for the given EOS, or nullptr if the combination is invalid
+static inline const SuperAncillary* get_superancillary(int EOS, int prop){
+    switch(EOS){
+        case 0: return (prop == 100) ? &vdW_p : (prop == 101) ? &vdW_rhoL : (prop == 102) ? &vdW_rhoV : nullptr;
+        case 1: return (prop == 100) ? &SRK_p : (prop == 101) ? &SRK_rhoL : (prop == 102) ? &SRK_rhoV : nullptr;
+        case 2: return (prop == 100) ? &PR_p : (prop == 101) ? &PR_rhoL : (prop == 102) ? &PR_rhoV : nullptr;
+        default: return nullptr;
+    }
+}
+
+static inline const SuperAncillary& get_superancillary_or_throw(int EOS, int prop){
+    auto anc = get_superancillary(EOS, prop);
+    if (anc == nullptr){
+        throw std::invalid_argument("Invalid combination of EOS (" + std::to_string(EOS) + ") and property (" + std::to_string(prop) + ")");
+    }
+    return *anc;
+}
+
+/// The value of Ttilde at which the superancillary of the given property is equal to ytilde; the inverse of supercubic
+static inline double supercubic_Ttilde(int EOS, int prop, double ytilde){
+    return get_superancillary_or_throw(EOS, prop).solve_for_x(ytilde);
+}
+
+/// Evaluate the superancillary of the given property at each of the values of Ttilde; the vectorized form of supercubic
+static inline std::vector<double> supercubic_many(int EOS, int prop, const std::vector<double>& Ttilde){
+    return get_superancillary_or_throw(EOS, prop).y_many(Ttilde);
+}
+
 const int VDW_CODE = 0, SRK_CODE = 1, PR_CODE = 2, UNKNOWN_CODE = -1;
 const int P_CODE = 100, RHOL_CODE = 101, RHOV_CODE = 102;
 
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <optional>
 #include <variant>
+#include <set>
 
 #include "teqp/types.hpp"
 #include "teqp/constants.hpp"
@@ -23,6 +24,7 @@
 #include "multifluid_eosterms.hpp"
 #include "multifluid_reducing.hpp"
 #include "multifluid_gas_constant.hpp"
+#include "multifluid_library.hpp"
 
 #include <boost/algorithm/string/join.hpp>
 
@@ -51,22 +53,34 @@ class CorrespondingStatesContribution {
 
 private:
     const EOSCollection EOSs;
+    int lmax = 0; ///< The largest exponent of delta in the exponentials of all the fluids
 public:
-    CorrespondingStatesContribution(EOSCollection&& EOSs) : EOSs(EOSs) {};
+    CorrespondingStatesContribution(EOSCollection&& EOSs) : EOSs(EOSs) {
+        for (const auto& eos : this->EOSs) {
+            lmax = std::max(lmax, eos.get_lmax());
+        }
+    };
     
     auto size() const { return EOSs.size(); }
+    auto get_lmax() const { return lmax; }
 
+    /// Evaluate the contribution with the values of tau and delta shared with the other contributions in the context
     template<typename TauType, typename DeltaType, typename MoleFractions>
-    auto alphar(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
-        using resulttype = std::common_type_t<decltype(tau), decltype(molefracs[0]), decltype(delta)>; // Type promotion, without the const-ness
+    auto alphar(const EOSTermContext<TauType, DeltaType>& ctx, const MoleFractions& molefracs) const {
+        using resulttype = std::common_type_t<TauType, decltype(molefracs[0]), DeltaType>; // Type promotion, without the const-ness
         resulttype alphar = 0.0;
         auto N = molefracs.size();
         for (auto i = 0; i < N; ++i) {
-            alphar = alphar + molefracs[i] * EOSs[i].alphar(tau, delta);
+            alphar = alphar + molefracs[i] * EOSs[i].alphar(ctx);
         }
         return forceeval(alphar);
     }
 
+    template<typename TauType, typename DeltaType, typename MoleFractions>
+    auto alphar(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
+        return alphar(EOSTermContext<TauType, DeltaType>(tau, delta, lmax), molefracs);
+    }
+
     template<typename TauType, typename DeltaType>
     auto alphari(const TauType& tau, const DeltaType& delta, std::size_t i) const {
         return EOSs[i].alphar(tau, delta);
@@ -83,24 +97,58 @@ class DepartureContribution {
 private:
     const FCollection F;
     const DepartureFunctionCollection funcs;
+    int lmax = 0; ///< The largest exponent of delta in the exponentials of all the departure functions
+
+    using DepartureFunction = std::decay_t<decltype(std::declval<DepartureFunctionCollection>()[0][0])>;
+    /// A pair of components i < j that contributes to the departure term
+    struct DeparturePair {
+        int i, j;
+        double Fij;
+    };
+    std::vector<DeparturePair> pairs; ///< Only the pairs with a non-zero F and a departure function that is not null
+    std::vector<DepartureFunction> pair_funcs; ///< The departure functions of the pairs, in the same order as pairs
 public:
-    DepartureContribution(FCollection&& F, DepartureFunctionCollection&& funcs) : F(F), funcs(funcs) {};
+    DepartureContribution(FCollection&& F, DepartureFunctionCollection&& funcs) : F(F), funcs(funcs) {
+        const auto N = static_cast<int>(this->funcs.size());
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i+1; j < N; ++j) {
+                const auto& func = this->funcs[i][j];
+                if (this->F(i, j) == 0.0 || func.is_null()) {
+                    continue;
+                }
+                pairs.push_back(DeparturePair{i, j, this->F(i, j)});
+                pair_funcs.push_back(func);
+                lmax = std::max(lmax, func.get_lmax());
+            }
+        }
+    };
     
     const auto& get_F() const { return F; }
+    auto get_lmax() const { return lmax; }
+    /// The number of pairs of components that contribute to the departure term
+    auto get_Npairs() const { return pairs.size(); }
 
+    /// Evaluate the contribution with the values of tau and delta shared with the other contributions in the context
     template<typename TauType, typename DeltaType, typename MoleFractions>
-    auto alphar(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
-        using resulttype = std::common_type_t<decltype(tau), decltype(molefracs[0]), decltype(delta)>; // Type promotion, without the const-ness
+    auto alphar(const EOSTermContext<TauType, DeltaType>& ctx, const MoleFractions& molefracs) const {
+        using resulttype = std::common_type_t<TauType, decltype(molefracs[0]), DeltaType>; // Type promotion, without the const-ness
         resulttype alphar = 0.0;
-        auto N = molefracs.size();
-        for (auto i = 0; i < N; ++i) {
-            for (auto j = i+1; j < N; ++j) {
-                alphar = alphar + molefracs[i] * molefracs[j] * F(i, j) * funcs[i][j].alphar(tau, delta);
-            }
+        if (static_cast<std::size_t>(molefracs.size()) != funcs.size()) {
+            throw teqp::InvalidArgument("Wrong size of mole fractions; " + std::to_string(funcs.size()) + " are loaded but " + std::to_string(molefracs.size()) + " were provided");
+        }
+        // Only the pairs that can contribute are visited
+        for (auto k = 0U; k < pairs.size(); ++k) {
+            const auto& pair = pairs[k];
+            alphar = alphar + molefracs[pair.i] * molefracs[pair.j] * pair.Fij * pair_funcs[k].alphar(ctx);
         }
         return forceeval(alphar);
     }
 
+    template<typename TauType, typename DeltaType, typename MoleFractions>
+    auto alphar(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
+        return alphar(EOSTermContext<TauType, DeltaType>(tau, delta, lmax), molefracs);
+    }
+
     /// Call a single departure term at i,j 
     template<typename TauType, typename DeltaType>
     auto get_alpharij(const int i, const int j,     const TauType& tau, const DeltaType& delta) const {
@@ -127,6 +175,9 @@ public:
     using GasConstantCalculator = multifluid::gasconstant::GasConstantCalculator;
     const GasConstantCalculator Rcalc;
 
+    /// The terms only use operations that HessianDual supports, so the Hessian w.r.t. the molar concentrations can be obtained in one evaluation
+    static constexpr bool hessian_dual_compatible = true;
+
     template<class VecType>
     auto R(const VecType& molefracs) const {
         return std::visit([&molefracs](const auto& el){ return el.get_R(molefracs); }, Rcalc);
@@ -171,7 +222,9 @@ public:
         auto rhored = forceeval(redfunc.get_rhor(molefrac));
         auto delta = forceeval(rho / rhored);
         auto tau = forceeval(Tred / T);
-        auto val = corr.alphar(tau, delta, molefrac) + dep.alphar(tau, delta, molefrac);
+        // The logarithms and powers of tau and delta are evaluated once for all the fluids and departure functions
+        EOSTermContext<decltype(tau), decltype(delta)> ctx(tau, delta, std::max(corr.get_lmax(), dep.get_lmax()));
+        auto val = corr.alphar(ctx, molefrac) + dep.alphar(ctx, molefrac);
         return forceeval(val);
     }
 };
@@ -750,7 +803,7 @@ inline auto collect_component_json(const std::vector<std::string>& components, c
             }
         }
         if (selected_path != "") {
-            out.push_back(load_a_JSON_file(selected_path.string()));
+            out.push_back(*FluidLibrary::get(root).get_fluid_JSON(selected_path.string()));
         }
         else {
             throw std::invalid_argument("Could not load any of the candidates:" + c);
@@ -804,47 +857,6 @@ inline auto select_identifier(const nlohmann::json& BIPcollection, const mapvecs
     throw std::invalid_argument("Unable to match any of the identifier options");
 }
 
-/// Build a reverse-lookup map for finding a fluid JSON structure given a backup identifier
-inline auto build_alias_map(const std::string& root) {
-    std::map<std::string, std::string> aliasmap;
-    for (auto path : get_files_in_folder(root + "/dev/fluids", ".json")) {
-        auto j = load_a_JSON_file(path.string());
-        std::string REFPROP_name = j.at("INFO").at("REFPROP_NAME"); 
-        std::string name = j.at("INFO").at("NAME");
-        for (std::string k : {"NAME", "CAS", "REFPROP_NAME"}) {
-            std::string val = j.at("INFO").at(k);
-            // Skip REFPROP names that match the fluid itself
-            if (k == "REFPROP_NAME" && val == name) {
-                continue;
-            }
-            // Skip invalid REFPROP names
-            if (k == "REFPROP_NAME" && val == "N/A") {
-                continue;
-            }
-            if (aliasmap.count(val) > 0) {
-                throw std::invalid_argument("Duplicated reverse lookup identifier ["+k+"] found in file:" + path.string());
-            }
-            else {
-                aliasmap[val] = std::filesystem::absolute(path).string();
-            }
-        }
-        std::vector<std::string> aliases = j.at("INFO").at("ALIASES");
-        
-        for (std::string alias : aliases) {
-            if (alias != REFPROP_name && alias != name) { // Don't add REFPROP name or base name, were already above to list of aliases
-                if (aliasmap.count(alias) > 0) {
-                    throw std::invalid_argument("Duplicated alias [" + alias + "] found in file:" + path.string());
-                }
-                else {
-                    aliasmap[alias] = std::filesystem::absolute(path).string();
-                }
-            }
-        }
-    }
-    return aliasmap;
-}
-
-
 /// Internal method for actually constructing the model with the provided JSON data structures
 inline auto _build_multifluid_model(const std::vector<nlohmann::json> &pureJSON, const nlohmann::json& BIPcollection, const nlohmann::json& depcollection, const nlohmann::json& flags = {}) {
     
@@ -963,7 +975,7 @@ inline auto make_pure_components_JSON(const nlohmann::json& components, const st
     }
     else{
         // Lookup the absolute paths for each component
-        auto aliasmap = build_alias_map(root);
+        auto& library = FluidLibrary::get(root);
         std::vector<std::string> abspaths;
         for (auto c : components) {
             auto cstr = c.get<std::string>();
@@ -972,7 +984,7 @@ inline auto make_pure_components_JSON(const nlohmann::json& components, const st
                 abspaths.push_back(cstr);
             }
             else {
-                abspaths.push_back(aliasmap[cstr]);
+                abspaths.push_back(library.get_path(cstr).value_or(cstr));
             }
         }
         // Backup lookup with absolute paths resolved for each component
@@ -995,6 +1007,77 @@ inline auto build_multifluid_model(const std::vector<std::string>& components, c
     return _build_multifluid_model(make_pure_components_JSON(components, root), BIPcollection, depcollection, flags);
 }
 
+/**
+ * \brief Resolve all the data that the specification of a multifluid model refers to
+ *
+ * The returned specification has the data of the pure fluids in JSON format, and only the entries of the binary interaction parameters
+ * and departure functions that are used by the pairs in this mixture, so a model can be built from it without reading any files. It is
+ * marked with "resolved" so that resolving it again is a no-op
+ */
+inline nlohmann::json resolve_multifluid_spec(const nlohmann::json& spec) {
+    
+    if (spec.value("resolved", false)){
+        return spec;
+    }
+    nlohmann::json flags = (spec.contains("flags")) ? spec.at("flags") : nlohmann::json();
+    
+    std::vector<nlohmann::json> pureJSON;
+    nlohmann::json BIPcollection = nlohmann::json::array();
+    nlohmann::json depcollection = nlohmann::json::array();
+    
+    // We are in the interop logical branch in which we will be invoking the REFPROP-interop code
+    if (spec.contains("HMX.BNC")){
+        for (auto comp : spec.at("components")){
+            pureJSON.push_back(RPinterop::FLDfile(comp).make_json(""));
+        }
+        std::tie(BIPcollection, depcollection) = RPinterop::HMXBNCfile(spec.at("HMX.BNC")).make_jsons();
+    }
+    else{
+        std::string root = (spec.contains("root")) ? spec.at("root") : "";
+        auto components = spec.at("components");
+        if (components.size() > 1){
+            BIPcollection = multilevel_JSON_load(spec.at("BIP"), root + "/dev/mixtures/mixture_binary_pairs.json");
+            depcollection = multilevel_JSON_load(spec.at("departure"), root + "/dev/mixtures/mixture_departure_functions.json");
+        }
+        pureJSON = make_pure_components_JSON(components, root);
+    }
+    
+    // Retain only the entries that are used, in their original order so the same entries are matched when the model is built
+    nlohmann::json BIPs = nlohmann::json::array(), deps = nlohmann::json::array();
+    if (pureJSON.size() > 1){
+        auto identifierset = collect_identifiers(pureJSON);
+        auto identifiers = identifierset[select_identifier(BIPcollection, identifierset, flags)];
+        // Pairs that match no entry are estimated, which needs no data; with "force-estimate" no entries are used at all
+        std::set<std::size_t> used;
+        if (!flags.contains("force-estimate")){
+            for (auto i = 0U; i < identifiers.size(); ++i){
+                for (auto j = i + 1; j < identifiers.size(); ++j){
+                    auto [index, swap_needed] = reducing::get_BIPdep_index(BIPcollection, { identifiers[i], identifiers[j] });
+                    if (index){ used.insert(index.value()); }
+                }
+            }
+        }
+        std::set<std::string> depnames;
+        for (auto index : used){
+            const auto& el = BIPcollection[index];
+            BIPs.push_back(el);
+            if (el.contains("function")){ depnames.insert(el.at("function").get<std::string>()); }
+        }
+        for (const auto& el : depcollection){
+            if (el.contains("Name") && depnames.count(el.at("Name").get<std::string>()) > 0){
+                deps.push_back(el);
+            }
+        }
+    }
+    return {
+        {"components", pureJSON},
+        {"BIP", BIPs},
+        {"departure", deps},
+        {"flags", flags},
+        {"resolved", true}
+    };
+}
+
 /**
 * \brief Load a model from a JSON data structure
 * 
@@ -1002,11 +1085,18 @@ inline auto build_multifluid_model(const std::vector<std::string>& components, c
 * 
 * BIP and departure can be either the data in JSON format, or a path to file with those contents
 * components is an array, which either contains the paths to the JSON data, or the file path
+* 
+* A specification that has been resolved with resolve_multifluid_spec is also accepted, in which case no files are read
 */
 inline auto multifluidfactory(const nlohmann::json& spec) {
     
     nlohmann::json flags = (spec.contains("flags")) ? spec.at("flags") : nlohmann::json();
     
+    // The data are all in the specification already, and only the entries that are used are retained (the collections may be empty)
+    if (spec.value("resolved", false)){
+        return _build_multifluid_model(spec.at("components").get<std::vector<nlohmann::json>>(), spec.at("BIP"), spec.at("departure"), flags);
+    }
+    
     // We are in the interop logical branch in which we will be invoking the REFPROP-interop code
     if (spec.contains("HMX.BNC")){
         std::vector<nlohmann::json> componentJSON;
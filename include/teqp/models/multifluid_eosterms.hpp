@@ -1,9 +1,71 @@
 #pragma once
 
+#include <variant>
+#include <array>
+#include <vector>
+
 #include "teqp/types.hpp"
 
 namespace teqp {
 
+/**
+\brief The integer powers \f$\delta^k\f$ for k from 0 to lmax
+
+They are stored in a fixed-capacity array on the stack for exponents up to max_l_fast, which covers all the multifluid terms in the
+fluid library, so the evaluation does not allocate; only for larger exponents are they stored on the heap.
+*/
+template<typename DeltaType>
+class DeltaPowers {
+public:
+    static constexpr int max_l_fast = 16; ///< The largest exponent for which the powers are stored on the stack
+private:
+    int lmax;
+    std::array<DeltaType, max_l_fast+1> fixed;
+    std::vector<DeltaType> heap;
+    DeltaType* data() { return (lmax <= max_l_fast) ? fixed.data() : heap.data(); }
+public:
+    DeltaPowers(const DeltaType& delta, const int lmax_) : lmax(std::max(lmax_, 0)) {
+        if (lmax > max_l_fast) {
+            heap.resize(lmax + 1);
+        }
+        DeltaType* p = data();
+        p[0] = 1.0;
+        for (auto k = 1; k <= lmax; ++k) {
+            p[k] = p[k-1]*delta;
+        }
+    }
+    const DeltaType& operator[](const std::size_t k) const { return (lmax <= max_l_fast) ? fixed[k] : heap[k]; }
+    int get_lmax() const { return lmax; }
+};
+
+/**
+\brief The values that depend only on \f$\tau\f$ and \f$\delta\f$, computed once and shared by all the terms of all the fluids and departure functions of a mixture
+
+These are the logarithms of \f$\tau\f$ and \f$\delta\f$ and the integer powers of \f$\delta\f$ up to the largest exponent
+in the exponentials of the terms, which would otherwise be recalculated for each term.
+*/
+template<typename TauType, typename DeltaType>
+struct EOSTermContext {
+    TauType tau, lntau;
+    DeltaType delta, lndelta;
+    bool delta_zero; ///< True if the base value of delta is zero, in which case lndelta is not defined and is set to zero
+    DeltaPowers<DeltaType> deltapow; ///< The powers \f$\delta^k\f$ for k from 0 to the largest exponent requested
+
+    EOSTermContext(const TauType& tau, const DeltaType& delta, const int lmax) : tau(tau), lntau(log(tau)), delta(delta), lndelta(0.0), delta_zero(getbaseval(delta) == 0), deltapow(delta, lmax) {
+        if (!delta_zero) {
+            lndelta = log(delta);
+        }
+    }
+    /// The largest exponent of delta for which the power is stored
+    int get_lmax() const { return deltapow.get_lmax(); }
+};
+
+/// True if the term class can be evaluated directly from an EOSTermContext
+template<typename Term, typename Context, typename = void>
+struct accepts_context : std::false_type {};
+template<typename Term, typename Context>
+struct accepts_context<Term, Context, std::void_t<decltype(std::declval<const Term&>().alphar(std::declval<const Context&>()))>> : std::true_type {};
+
 /**
 \f$ \alpha^{\rm r}=\displaystyle\sum_i n_i \delta^{d_i} \tau^{t_i}\f$
 */
@@ -208,24 +270,29 @@ public:
     Eigen::ArrayXd n, t, d, eta, beta, gamma, epsilon, b;
 
     template<typename TauType, typename DeltaType>
-    auto alphar(const TauType& tau, const DeltaType& delta) const {
-
+    auto alphar(const EOSTermContext<TauType, DeltaType>& ctx) const {
         using result = std::common_type_t<TauType, DeltaType>;
-        result r = 0.0, lntau = log(tau);
+        const auto& tau = ctx.tau;
+        const auto& delta = ctx.delta;
+        result r = 0.0;
         auto square = [](auto x) { return x * x; };
-        if (getbaseval(delta) == 0) {
+        if (ctx.delta_zero) {
             for (auto i = 0; i < n.size(); ++i) {
-                r = r + n[i] * exp(t[i] * lntau - eta[i] * square(delta - epsilon[i]) + 1.0 / (beta[i] * square(tau - gamma[i]) + b[i]))*powi(delta, static_cast<int>(d[i]));
+                r = r + n[i] * exp(t[i] * ctx.lntau - eta[i] * square(delta - epsilon[i]) + 1.0 / (beta[i] * square(tau - gamma[i]) + b[i]))*powi(delta, static_cast<int>(d[i]));
             }
         }
         else {
-            result lndelta = log(delta);
             for (auto i = 0; i < n.size(); ++i) {
-                r = r + n[i] * exp(t[i] * lntau + d[i] * lndelta - eta[i] * square(delta - epsilon[i]) + 1.0 / (beta[i] * square(tau - gamma[i]) + b[i]));
+                r = r + n[i] * exp(t[i] * ctx.lntau + d[i] * ctx.lndelta - eta[i] * square(delta - epsilon[i]) + 1.0 / (beta[i] * square(tau - gamma[i]) + b[i]));
             }
         }
         return forceeval(r);
     }
+
+    template<typename TauType, typename DeltaType>
+    auto alphar(const TauType& tau, const DeltaType& delta) const {
+        return alphar(EOSTermContext<TauType, DeltaType>(tau, delta, 0));
+    }
 };
 
 /**
@@ -342,29 +409,247 @@ public:
 };
 
 
+/**
+\brief A flattened table of all the terms that can be written in the generalized form
+
+\f$ \alpha^{\rm r}=\displaystyle\sum_i n_i \tau^{t_i}\delta^{d_i} \exp(-c_i\delta^{l_i}-\omega_i\tau^{m_i}-\eta_i(\delta-\epsilon_i)^2-\beta_i(\tau-\gamma_i)^2-b_i(\delta-g_i))\f$
+
+The coefficients of the power, exponential, double exponential, Gaussian, GERG-2004 and Lemmon2005 terms are stored
+contiguously, one array per coefficient, so that the terms of a fluid are all evaluated in one loop rather than by visiting
+each term class in turn. For double arguments (and positive \f$\tau\f$ and \f$\delta\f$) the arguments of the exponentials
+are built in blocks with array expressions and then exponentiated with the vectorized exp of Eigen when AVX is enabled
+(and in one fused scalar loop otherwise); for all other
+numerical types (autodiff, multicomplex, etc.) the terms are summed one at a time, skipping the parts whose coefficients are zero.
+*/
+class CompiledEOSTermTable {
+public:
+    Eigen::ArrayXd n, t, d, c, omega, m, eta, epsilon, beta, gamma, b, g;
+    Eigen::ArrayXi d_i, l_i;
+
+    /// True if the term class can be absorbed into the table
+    template<typename T>
+    static constexpr bool accepts = std::is_same_v<T, JustPowerEOSTerm> || std::is_same_v<T, PowerEOSTerm> || std::is_same_v<T, ExponentialEOSTerm>
+        || std::is_same_v<T, DoubleExponentialEOSTerm> || std::is_same_v<T, GaussianEOSTerm> || std::is_same_v<T, GERG2004EOSTerm> || std::is_same_v<T, Lemmon2005EOSTerm>;
+
+private:
+    static constexpr Eigen::Index block_size = 32; ///< The number of terms whose exponential arguments are built at once in the double evaluation
+    using Block = Eigen::Array<double, Eigen::Dynamic, 1, 0, block_size, 1>;
+    bool has_c = false, has_omega = false, has_eta = false, has_beta = false, has_b = false;
+    int lmax = 0;
+
+    static void cat(Eigen::ArrayXd& a, const Eigen::ArrayXd& b){
+        Eigen::ArrayXd o(a.size() + b.size()); o << a, b; a = o;
+    }
+    static void cat(Eigen::ArrayXi& a, const Eigen::ArrayXi& b){
+        Eigen::ArrayXi o(a.size() + b.size()); o << a, b; a = o;
+    }
+
+    /// Append a set of terms to the table; coefficients that are not used by a term family are passed as zero
+    void append(const Eigen::ArrayXd& n_, const Eigen::ArrayXd& t_, const Eigen::ArrayXd& d_, const Eigen::ArrayXd& c_, const Eigen::ArrayXi& l_, const Eigen::ArrayXd& omega_, const Eigen::ArrayXd& m_, const Eigen::ArrayXd& eta_, const Eigen::ArrayXd& epsilon_, const Eigen::ArrayXd& beta_, const Eigen::ArrayXd& gamma_, const Eigen::ArrayXd& b_, const Eigen::ArrayXd& g_){
+        const auto N = n_.size();
+        for (auto s : {t_.size(), d_.size(), c_.size(), l_.size(), omega_.size(), m_.size(), eta_.size(), epsilon_.size(), beta_.size(), gamma_.size(), b_.size(), g_.size()}){
+            if (s != N){
+                throw std::invalid_argument("Lengths are not all identical in the coefficients of the term");
+            }
+        }
+        cat(n, n_); cat(t, t_); cat(d, d_); cat(c, c_); cat(l_i, l_); cat(omega, omega_); cat(m, m_);
+        cat(eta, eta_); cat(epsilon, epsilon_); cat(beta, beta_); cat(gamma, gamma_); cat(b, b_); cat(g, g_);
+        cat(d_i, d_.cast<int>());
+        has_c = has_c || (c_ != 0).any();
+        has_omega = has_omega || (omega_ != 0).any();
+        has_eta = has_eta || (eta_ != 0).any();
+        has_beta = has_beta || (beta_ != 0).any();
+        has_b = has_b || (b_ != 0).any();
+        if (N > 0){
+            lmax = std::max(lmax, l_.maxCoeff());
+        }
+    }
+
+    /// The vectorized evaluation for double arguments, valid for tau > 0 and delta > 0
+    double alphar_double(const EOSTermContext<double, double>& ctx) const {
+        const double tau = ctx.tau, delta = ctx.delta, lntau = ctx.lntau, lndelta = ctx.lndelta;
+        const auto& deltapow = ctx.deltapow;
+
+        double r = 0.0;
+        const Eigen::Index N = n.size();
+#if defined(EIGEN_VECTORIZE_AVX)
+        Block arg, dl;
+        for (Eigen::Index i0 = 0; i0 < N; i0 += block_size){
+            const Eigen::Index len = std::min(block_size, N - i0);
+            arg = t.segment(i0, len)*lntau + d.segment(i0, len)*lndelta;
+            if (has_c){
+                dl.resize(len);
+                for (Eigen::Index k = 0; k < len; ++k){ dl[k] = deltapow[l_i[i0+k]]; }
+                arg -= c.segment(i0, len)*dl;
+            }
+            if (has_omega){ arg -= omega.segment(i0, len)*(m.segment(i0, len)*lntau).exp(); }
+            if (has_eta){ arg -= eta.segment(i0, len)*(delta - epsilon.segment(i0, len)).square(); }
+            if (has_beta){ arg -= beta.segment(i0, len)*(tau - gamma.segment(i0, len)).square(); }
+            if (has_b){ arg -= b.segment(i0, len)*(delta - g.segment(i0, len)); }
+            r += (n.segment(i0, len)*arg.exp()).sum();
+        }
+#else
+        // Without AVX the packet exp of Eigen is no faster than std::exp, so the terms are summed in one fused loop
+        for (Eigen::Index i = 0; i < N; ++i){
+            double arg = t[i]*lntau + d[i]*lndelta - c[i]*deltapow[l_i[i]];
+            if (has_omega && omega[i] != 0){ arg -= omega[i]*std::exp(m[i]*lntau); }
+            if (has_eta){ const double dd = delta - epsilon[i]; arg -= eta[i]*dd*dd; }
+            if (has_beta){ const double dt = tau - gamma[i]; arg -= beta[i]*dt*dt; }
+            if (has_b){ arg -= b[i]*(delta - g[i]); }
+            r += n[i]*std::exp(arg);
+        }
+#endif
+        return r;
+    }
+
+public:
+    auto size() const { return n.size(); }
+
+    void add(const JustPowerEOSTerm& e){
+        const auto N = e.n.size(); const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(N);
+        append(e.n, e.t, e.d, z, Eigen::ArrayXi::Zero(N), z, z, z, z, z, z, z, z);
+    }
+    void add(const PowerEOSTerm& e){
+        if (e.l_i.size() == 0 && e.n.size() > 0) {
+            throw std::invalid_argument("l_i cannot be zero length if some terms are provided");
+        }
+        const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(e.n.size());
+        append(e.n, e.t, e.d, e.c, e.l_i, z, z, z, z, z, z, z, z);
+    }
+    void add(const ExponentialEOSTerm& e){
+        const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(e.n.size());
+        append(e.n, e.t, e.d, e.g, e.l_i, z, z, z, z, z, z, z, z);
+    }
+    void add(const DoubleExponentialEOSTerm& e){
+        if (e.ld_i.size() == 0 && e.n.size() > 0) {
+            throw std::invalid_argument("ld_i cannot be zero length if some terms are provided");
+        }
+        const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(e.n.size());
+        append(e.n, e.t, e.d, e.gd, e.ld_i, e.gt, e.lt, z, z, z, z, z, z);
+    }
+    void add(const GaussianEOSTerm& e){
+        const auto N = e.n.size(); const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(N);
+        append(e.n, e.t, e.d, z, Eigen::ArrayXi::Zero(N), z, z, e.eta, e.epsilon, e.beta, e.gamma, z, z);
+    }
+    void add(const GERG2004EOSTerm& e){
+        const auto N = e.n.size(); const Eigen::ArrayXd z = Eigen::ArrayXd::Zero(N);
+        append(e.n, e.t, e.d, z, Eigen::ArrayXi::Zero(N), z, z, e.eta, e.epsilon, z, z, e.beta, e.gamma);
+    }
+    void add(const Lemmon2005EOSTerm& e){
+        const auto N = e.n.size(); const Eigen::ArrayXd one = Eigen::ArrayXd::Ones(N), z = Eigen::ArrayXd::Zero(N);
+        append(e.n, e.t, e.d, one, e.l_i, one, e.m, z, z, z, z, z, z);
+    }
+
+    /// The largest exponent of delta in the exponentials of the terms
+    int get_lmax() const { return lmax; }
+
+    template<typename TauType, typename DeltaType>
+    auto alphar(const EOSTermContext<TauType, DeltaType>& ctx) const {
+        using result = std::common_type_t<TauType, DeltaType>;
+        if (n.size() == 0){
+            return static_cast<result>(0.0);
+        }
+        if (ctx.get_lmax() < lmax){
+            throw std::invalid_argument("The context does not hold the powers of delta needed by the terms");
+        }
+        if constexpr (std::is_same_v<result, double>){
+            if (ctx.tau > 0 && ctx.delta > 0){
+                return alphar_double(ctx);
+            }
+        }
+        auto square = [](auto x) { return x * x; };
+        const auto& tau = ctx.tau;
+        const auto& delta = ctx.delta;
+        result r = 0.0;
+        for (auto i = 0; i < n.size(); ++i) {
+            result arg = t[i]*ctx.lntau;
+            if (!ctx.delta_zero){ arg = arg + d[i]*ctx.lndelta; }
+            if (c[i] != 0){ arg = arg - c[i]*ctx.deltapow[l_i[i]]; }
+            if (omega[i] != 0){ arg = arg - omega[i]*pow(tau, m[i]); }
+            if (eta[i] != 0){ arg = arg - eta[i]*square(delta - epsilon[i]); }
+            if (beta[i] != 0){ arg = arg - beta[i]*square(tau - gamma[i]); }
+            if (b[i] != 0){ arg = arg - b[i]*(delta - g[i]); }
+            if (ctx.delta_zero){
+                r = r + n[i]*exp(arg)*powi(delta, d_i[i]);
+            }
+            else{
+                r = r + n[i]*exp(arg);
+            }
+        }
+        return forceeval(r);
+    }
+
+    template<typename TauType, typename DeltaType>
+    auto alphar(const TauType& tau, const DeltaType& delta) const {
+        return alphar(EOSTermContext<TauType, DeltaType>(tau, delta, lmax));
+    }
+};
+
+/**
+A collection of terms; the terms that can be written in the generalized form of CompiledEOSTermTable are absorbed into a single
+table, and the remaining ones are stored as variants and visited one at a time
+*/
 template<typename... Args>
 class EOSTermContainer {  
 private:
     using varEOSTerms = std::variant<Args...>;
     std::vector<varEOSTerms> coll;
+    CompiledEOSTermTable table;
+    std::size_t Ntable = 0; ///< The number of term instances that were absorbed into the table
 public:
 
-    auto size() const { return coll.size(); }
+    auto size() const { return coll.size() + Ntable; }
 
     template<typename Instance>
     auto add_term(Instance&& instance) {
-        coll.emplace_back(instance);
+        using T = std::decay_t<Instance>;
+        static_assert((std::is_same_v<T, Args> || ...), "This term type is not allowed in this container");
+        if constexpr (CompiledEOSTermTable::accepts<T>) {
+            table.add(instance);
+            Ntable++;
+        }
+        else {
+            coll.emplace_back(instance);
+        }
+    }
+
+    /// The largest exponent of delta in the exponentials of the terms, used to size the EOSTermContext
+    int get_lmax() const { return table.get_lmax(); }
+
+    /// True if the container has no terms, or only NullEOSTerm, so that it always evaluates to zero
+    bool is_null() const {
+        if (table.size() > 0) {
+            return false;
+        }
+        for (const auto& term : coll) {
+            if (!std::visit([](const auto& t) { return std::is_same_v<std::decay_t<decltype(t)>, NullEOSTerm>; }, term)) {
+                return false;
+            }
+        }
+        return true;
     }
 
     template <class Tau, class Delta>
-    auto alphar(const Tau& tau, const Delta& delta) const {
-        std::common_type_t <Tau, Delta> ar = 0.0;
+    auto alphar(const EOSTermContext<Tau, Delta>& ctx) const {
+        std::common_type_t <Tau, Delta> ar = table.alphar(ctx);
         for (const auto& term : coll) {
-            auto contrib = std::visit([&](auto& t) { return t.alphar(tau, delta); }, term);
+            auto contrib = std::visit([&](auto& t) {
+                if constexpr (accepts_context<std::decay_t<decltype(t)>, EOSTermContext<Tau, Delta>>::value) {
+                    return t.alphar(ctx);
+                }
+                else {
+                    return t.alphar(ctx.tau, ctx.delta);
+                }
+            }, term);
             ar = ar + contrib;
         }
         return ar;
     }
+
+    template <class Tau, class Delta>
+    auto alphar(const Tau& tau, const Delta& delta) const {
+        return alphar(EOSTermContext<Tau, Delta>(tau, delta, get_lmax()));
+    }
 };
 
 using EOSTerms = EOSTermContainer<JustPowerEOSTerm, PowerEOSTerm, GaussianEOSTerm, NonAnalyticEOSTerm, Lemmon2005EOSTerm, GaoBEOSTerm, ExponentialEOSTerm, DoubleExponentialEOSTerm>;
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <unordered_map>
+#include <fstream>
+#include <tuple>
+#include <set>
+
+#include "nlohmann/json.hpp"
+#include "teqp/json_tools.hpp"
+#include "teqp/filesystem.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+
+/// Build a reverse-lookup map for finding a fluid JSON structure given a backup identifier
+inline auto build_alias_map(const std::string& root) {
+    std::map<std::string, std::string> aliasmap;
+    for (auto path : get_files_in_folder(root + "/dev/fluids", ".json")) {
+        auto j = load_a_JSON_file(path.string());
+        std::string REFPROP_name = j.at("INFO").at("REFPROP_NAME");
+        std::string name = j.at("INFO").at("NAME");
+        for (std::string k : {"NAME", "CAS", "REFPROP_NAME"}) {
+            std::string val = j.at("INFO").at(k);
+            // Skip REFPROP names that match the fluid itself
+            if (k == "REFPROP_NAME" && val == name) {
+                continue;
+            }
+            // Skip invalid REFPROP names
+            if (k == "REFPROP_NAME" && val == "N/A") {
+                continue;
+            }
+            if (aliasmap.count(val) > 0) {
+                throw std::invalid_argument("Duplicated reverse lookup identifier ["+k+"] found in file:" + path.string());
+            }
+            else {
+                aliasmap[val] = std::filesystem::absolute(path).string();
+            }
+        }
+        std::vector<std::string> aliases = j.at("INFO").at("ALIASES");
+
+        for (std::string alias : aliases) {
+            if (alias != REFPROP_name && alias != name) { // Don't add REFPROP name or base name, were already above to list of aliases
+                if (aliasmap.count(alias) > 0) {
+                    throw std::invalid_argument("Duplicated alias [" + alias + "] found in file:" + path.string());
+                }
+                else {
+                    aliasmap[alias] = std::filesystem::absolute(path).string();
+                }
+            }
+        }
+    }
+    return aliasmap;
+}
+
+/**
+ The library of pure fluid files in the dev/fluids folder of a root, loaded once per process and shared between threads (see FluidLibrary::get)
+
+ The index of identifiers (names, CAS numbers, REFPROP names and aliases) is built the first time an identifier is looked up, either by parsing
+ all the fluid files as in build_alias_map, or from the index file written by write_index, which is much faster. Each identifier refers to one
+ entry in the list of files, so the paths are only stored once. The contents of the fluid files are parsed the first time they are needed and
+ cached along with the modification time and size of the file, so building many models from the same fluids only reads each file once, and a
+ file that is rewritten is read again.
+
+ The index file is not checked against the contents of the fluid files, so it should be written again if the fluid files are edited. If the
+ fluid files in the folder are not the ones listed in the index file, or the index file is invalid, the index is rebuilt from the fluid files.
+ */
+class FluidLibrary {
+private:
+    const std::string root;
+
+    std::once_flag index_flag;
+    std::vector<std::string> paths; ///< The absolute paths of the fluid files
+    std::unordered_map<std::string, std::size_t> index; ///< From identifier to the index in paths
+
+    /// The parsed contents of a fluid file, and the modification time and size of the file when it was parsed
+    struct CacheEntry{
+        std::filesystem::file_time_type write_time;
+        std::uintmax_t size;
+        std::shared_ptr<const nlohmann::json> contents;
+    };
+    mutable std::shared_mutex cache_mutex;
+    std::unordered_map<std::string, CacheEntry> cache; ///< From absolute path to the parsed contents
+
+    /// Parse all the fluid files to get the list of paths and the index of identifiers
+    auto scan_files() const {
+        std::vector<std::string> paths;
+        std::unordered_map<std::string, std::size_t> index, path_indices;
+        for (auto& [identifier, path] : build_alias_map(root)){
+            auto [itr, inserted] = path_indices.emplace(path, paths.size());
+            if (inserted){
+                paths.push_back(path);
+            }
+            index[identifier] = itr->second;
+        }
+        return std::make_tuple(paths, index);
+    }
+
+    /// Read the index file into paths and index, returning false if it is missing or does not list the fluid files now in the folder; throws if it is not valid
+    bool read_index_file(){
+        auto index_path = get_index_path();
+        if (!std::filesystem::is_regular_file(index_path)){
+            return false;
+        }
+        auto j = load_a_JSON_file(index_path);
+        if (j.value("version", -1) != 1){
+            return false;
+        }
+        auto folder = std::filesystem::absolute(root + "/dev/fluids");
+        std::set<std::string> listed, present;
+        for (const auto& filename : j.at("files")){
+            listed.insert(filename.get<std::string>());
+            paths.push_back((folder / filename.get<std::string>()).string());
+        }
+        for (const auto& path : get_files_in_folder(folder.string(), ".json")){
+            present.insert(path.filename().string());
+        }
+        if (listed != present || listed.size() != paths.size()){
+            return false;
+        }
+        for (const auto& [identifier, i] : j.at("identifiers").items()){
+            auto k = i.get<std::size_t>();
+            if (k >= paths.size()){
+                return false;
+            }
+            index[identifier] = k;
+        }
+        return true;
+    }
+
+    /// Load the index from the index file, returning false if it is missing, invalid, or does not list the fluid files now in the folder, in which case paths and index are left empty
+    bool load_index_file(){
+        bool loaded = false;
+        try{
+            loaded = read_index_file();
+        }
+        catch(...){
+            // An index file that cannot be parsed or has entries of the wrong type is treated like a missing one
+        }
+        if (!loaded){
+            paths.clear(); index.clear();
+        }
+        return loaded;
+    }
+
+    void build_index(){
+        if (!load_index_file()){
+            std::tie(paths, index) = scan_files();
+        }
+    }
+
+    const auto& get_index(){
+        std::call_once(index_flag, [this](){ build_index(); });
+        return index;
+    }
+
+public:
+    FluidLibrary(const std::string& root) : root(root) {};
+
+    /// The shared library for this root, created the first time it is requested
+    static FluidLibrary& get(const std::string& root){
+        static std::mutex mutex;
+        static std::unordered_map<std::string, std::unique_ptr<FluidLibrary>> libraries;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& lib = libraries[root];
+        if (!lib){
+            lib = std::make_unique<FluidLibrary>(root);
+        }
+        return *lib;
+    }
+
+    /// The path of the index file, in the dev folder next to the fluids folder
+    std::string get_index_path() const { return root + "/dev/fluids_index.json"; }
+
+    /// Write the index of identifiers to file, so that it can be loaded by later processes without parsing the fluid files
+    void write_index() const {
+        auto [scanned_paths, scanned_index] = scan_files();
+        nlohmann::json files = nlohmann::json::array();
+        for (const auto& path : scanned_paths){
+            files.push_back(std::filesystem::path(path).filename().string());
+        }
+        nlohmann::json identifiers = nlohmann::json::object();
+        for (const auto& [identifier, i] : scanned_index){
+            identifiers[identifier] = i;
+        }
+        std::ofstream ofs(get_index_path());
+        ofs << nlohmann::json{{"version", 1}, {"files", files}, {"identifiers", identifiers}}.dump();
+        if (!ofs){
+            throw teqp::InvalidArgument("Unable to write the index of the fluid library to: " + get_index_path());
+        }
+    }
+
+    /// The absolute path of the fluid file for the given identifier (name, CAS number, REFPROP name or alias), if it is in the library
+    std::optional<std::string> get_path(const std::string& identifier){
+        const auto& idx = get_index();
+        auto itr = idx.find(identifier);
+        if (itr == idx.end()){
+            return std::nullopt;
+        }
+        return paths[itr->second];
+    }
+
+    /// The map from identifier to absolute path, in the same form as returned by build_alias_map
+    std::map<std::string, std::string> get_alias_map(){
+        std::map<std::string, std::string> o;
+        for (const auto& [identifier, i] : get_index()){
+            o[identifier] = paths[i];
+        }
+        return o;
+    }
+
+    /// The parsed contents of the fluid file at the given path, cached until the modification time or size of the file changes
+    std::shared_ptr<const nlohmann::json> get_fluid_JSON(const std::string& path){
+        auto abspath = std::filesystem::absolute(path).string();
+        auto write_time = std::filesystem::last_write_time(abspath);
+        auto size = std::filesystem::file_size(abspath);
+        {
+            std::shared_lock<std::shared_mutex> lock(cache_mutex);
+            auto itr = cache.find(abspath);
+            if (itr != cache.end() && itr->second.write_time == write_time && itr->second.size == size){
+                return itr->second.contents;
+            }
+        }
+        // Parse outside the lock; if another thread stored the same file in the meantime, either copy is up to date
+        auto j = std::make_shared<const nlohmann::json>(load_a_JSON_file(abspath));
+        std::unique_lock<std::shared_mutex> lock(cache_mutex);
+        cache[abspath] = CacheEntry{write_time, size, j};
+        return j;
+    }
+};
+
+}
@@ -48,7 +48,8 @@ namespace teqp {
             auto rhored = forceeval(redfunc.get_rhor(molefrac));
             auto delta = forceeval(rho / rhored);
             auto tau = forceeval(Tred / T);
-            auto val = base.corr.alphar(tau, delta, molefrac) + dep.alphar(tau, delta, molefrac);
+            EOSTermContext<decltype(tau), decltype(delta)> ctx(tau, delta, std::max(base.corr.get_lmax(), dep.get_lmax()));
+            auto val = base.corr.alphar(ctx, molefrac) + dep.alphar(ctx, molefrac);
             return forceeval(val);
         }
     };
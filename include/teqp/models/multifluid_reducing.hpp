@@ -1,71 +1,88 @@
 #pragma once
 
 #include "teqp/types.hpp"
+#include <optional>
 
 namespace teqp {
 
     namespace reducing {
 
-        inline auto get_BIPdep(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
-            if (!collection.is_array()){
-                throw teqp::InvalidArgument("collection provided to get_BIPdep must be an array");
-            }
-            if (collection.size() > 0 && !collection[0].is_object()){
-                throw teqp::InvalidArgument("entries in collection provided to get_BIPdep must be objects");
-            }
-
-            // If force-estimate is provided in flags, the estimation will over-ride the provided model(s)
-            if (flags.contains("force-estimate")) {
-                std::string scheme = flags.at("estimate");
-                if (scheme == "Lorentz-Berthelot") {
-                    return std::make_tuple(nlohmann::json({
-                        {"betaT", 1.0}, {"gammaT", 1.0}, {"betaV", 1.0}, {"gammaV", 1.0}, {"F", 0.0}
-                        }), false);
-                }
-                else {
-                    throw std::invalid_argument("estimation scheme is not understood:" + scheme);
-                }
-            }
-
+        /**
+         * \brief The index of the entry in the collection that matches the binary pair, and whether the order of the components is swapped in it
+         *
+         * Entries are matched first on their hashes, then on their names, then on their CAS numbers. The index is empty if no entry matches
+         */
+        inline std::tuple<std::optional<std::size_t>, bool> get_BIPdep_index(const nlohmann::json& collection, const std::vector<std::string>& identifiers) {
             // convert string to upper case
             auto toupper = [](const std::string s) { auto data = s; std::for_each(data.begin(), data.end(), [](char& c) { c = ::toupper(c); }); return data; };
 
             std::string comp0 = toupper(identifiers[0]);
             std::string comp1 = toupper(identifiers[1]);
             // O-th pass, check the hashes
-            for (auto& el : collection) {
+            for (auto i = 0U; i < collection.size(); ++i) {
+                const auto& el = collection[i];
                 if (!el.contains("hash1")){ continue; }
                 std::string name1 = toupper(el.at("hash1"));
                 std::string name2 = toupper(el.at("hash2"));
                 if (comp0 == name1 && comp1 == name2) {
-                    return std::make_tuple(el, false);
+                    return std::make_tuple(i, false);
                 }
                 if (comp0 == name2 && comp1 == name1) {
-                    return std::make_tuple(el, true);
+                    return std::make_tuple(i, true);
                 }
             }
             // First pass, check names
-            for (auto& el : collection) {
+            for (auto i = 0U; i < collection.size(); ++i) {
+                const auto& el = collection[i];
                 std::string name1 = toupper(el.at("Name1"));
                 std::string name2 = toupper(el.at("Name2"));
                 if (comp0 == name1 && comp1 == name2) {
-                    return std::make_tuple(el, false);
+                    return std::make_tuple(i, false);
                 }
                 if (comp0 == name2 && comp1 == name1) {
-                    return std::make_tuple(el, true);
+                    return std::make_tuple(i, true);
                 }
             }
             // Second pass, check CAS#
-            for (auto& el : collection) {
+            for (auto i = 0U; i < collection.size(); ++i) {
+                const auto& el = collection[i];
                 std::string CAS1 = el.at("CAS1");
                 std::string CAS2 = el.at("CAS2");
                 if (identifiers[0] == CAS1 && identifiers[1] == CAS2) {
-                    return std::make_tuple(el, false);
+                    return std::make_tuple(i, false);
                 }
                 if (identifiers[0] == CAS2 && identifiers[1] == CAS1) {
-                    return std::make_tuple(el, true);
+                    return std::make_tuple(i, true);
                 }
             }
+            return std::make_tuple(std::nullopt, false);
+        }
+
+        inline auto get_BIPdep(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
+            if (!collection.is_array()){
+                throw teqp::InvalidArgument("collection provided to get_BIPdep must be an array");
+            }
+            if (collection.size() > 0 && !collection[0].is_object()){
+                throw teqp::InvalidArgument("entries in collection provided to get_BIPdep must be objects");
+            }
+
+            // If force-estimate is provided in flags, the estimation will over-ride the provided model(s)
+            if (flags.contains("force-estimate")) {
+                std::string scheme = flags.at("estimate");
+                if (scheme == "Lorentz-Berthelot") {
+                    return std::make_tuple(nlohmann::json({
+                        {"betaT", 1.0}, {"gammaT", 1.0}, {"betaV", 1.0}, {"gammaV", 1.0}, {"F", 0.0}
+                        }), false);
+                }
+                else {
+                    throw std::invalid_argument("estimation scheme is not understood:" + scheme);
+                }
+            }
+
+            auto [index, swap_needed] = get_BIPdep_index(collection, identifiers);
+            if (index) {
+                return std::make_tuple(collection[index.value()], swap_needed);
+            }
 
             // If estimate is provided in flags, it will be the fallback solution for filling in interaction parameters
             if (flags.contains("estimate")) {
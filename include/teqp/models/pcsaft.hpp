@@ -12,6 +12,9 @@
 #include "teqp/constants.hpp"
 #include "teqp/json_tools.hpp"
 #include "teqp/models/saft/polar_terms.hpp"
+#include "teqp/models/association/association.hpp"
+#include "teqp/math/forms.hpp"
+#include "teqp/small_buffer.hpp"
 #include <optional>
 
 namespace teqp {
@@ -28,6 +31,9 @@ struct SAFTCoeffs {
            nmu = 0, ///< number of dipolar segments
            Qstar2 = 0, ///< nondimensional, the reduced quadrupole squared
            nQ = 0; ///< number of quadrupolar segments
+    association::association_classes association_class = association::association_classes::not_associating; ///< the site scheme of Huang and Radosz
+    double epsilon_AB_over_k = 0, ///< [K] association energy divided by Boltzmann constant
+           kappa_AB = 0; ///< nondimensional, the association volume
 };
 
 /// Manager class for PCSAFT coefficients
@@ -169,18 +175,6 @@ auto sumproduct(const VecType1& v1, const VecType2& v2, const VecType3& v3) {
     return forceeval((v1.template cast<ResultType>().array() * v2.template cast<ResultType>().array() * v3.template cast<ResultType>().array()).sum());
 }
 
-/// Parameters for model evaluation
-template<typename NumType, typename ProductType>
-class SAFTCalc {
-public:
-    // Just temperature dependent things
-    Eigen::ArrayX<NumType> d;
-
-    // These things also have composition dependence
-    ProductType m2_epsilon_sigma3_bar, ///< Eq. A. 12
-                m2_epsilon2_sigma3_bar; ///< Eq. A. 13
-};
-
 /***
  * \brief This class provides the evaluation of the hard chain contribution from classic PC-SAFT
  */
@@ -192,15 +186,46 @@ protected:
         sigma_Angstrom, ///<
         epsilon_over_k; ///< depth of pair potential divided by Boltzman constant
     const Eigen::ArrayXXd kmat; ///< binary interaction parameter matrix
+    Eigen::ArrayXXd m2_epsilon_sigma3, ///< \f$m_im_j(\epsilon_{ij}/k)\sigma_{ij}^3\f$, in terms of which Eq. A.12 is a quadratic form
+        m2_epsilon2_sigma3; ///< \f$m_im_j(\epsilon_{ij}/k)^2\sigma_{ij}^3\f$, in terms of which Eq. A.13 is a quadratic form
 
 public:
     PCSAFTHardChainContribution(const Eigen::ArrayX<double> &m, const Eigen::ArrayX<double> &mminus1, const Eigen::ArrayX<double> &sigma_Angstrom, const Eigen::ArrayX<double> &epsilon_over_k, const Eigen::ArrayXXd &kmat)
-    : m(m), mminus1(mminus1), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), kmat(kmat) {}
+    : m(m), mminus1(mminus1), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), kmat(kmat) {
+        const auto N = m.size();
+        m2_epsilon_sigma3.resize(N, N);
+        m2_epsilon2_sigma3.resize(N, N);
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                // Eq. A.5
+                auto sigma_ij = 0.5 * sigma_Angstrom[i] + 0.5 * sigma_Angstrom[j];
+                auto eij_over_k = sqrt(epsilon_over_k[i] * epsilon_over_k[j]) * (1.0 - kmat(i,j));
+                m2_epsilon_sigma3(i,j) = m[i] * m[j] * eij_over_k * pow(sigma_ij, 3);
+                m2_epsilon2_sigma3(i,j) = m[i] * m[j] * pow(eij_over_k, 2) * pow(sigma_ij, 3);
+            }
+        }
+    }
     
     PCSAFTHardChainContribution& operator=( const PCSAFTHardChainContribution& ) = delete; // non copyable
     
+    /// The temperature-dependent segment diameters in A (Eqn A.9), written into d, which must hold one value per component
+    template<typename TTYPE, typename DType>
+    void get_d(const TTYPE& T, DType& d) const {
+        for (auto i = 0; i < m.size(); ++i) {
+            d[i] = sigma_Angstrom[i]*(1.0 - 0.12 * exp(-3.0*epsilon_over_k[i]/T)); // [A]
+        }
+    }
+    
     template<typename TTYPE, typename RhoType, typename VecType>
     auto eval(const TTYPE& T, const RhoType& rhomolar, const VecType& mole_fractions) const {
+        SmallBuffer<TTYPE> d(m.size());
+        get_d(T, d);
+        return eval(T, rhomolar, mole_fractions, d);
+    }
+    
+    /// The same as eval(T, rhomolar, mole_fractions), with the segment diameters from get_d
+    template<typename TTYPE, typename RhoType, typename VecType, typename DType>
+    auto eval(const TTYPE& T, const RhoType& rhomolar, const VecType& mole_fractions, const DType& d) const {
         
         std::size_t N = m.size();
         
@@ -210,20 +235,9 @@ public:
         
         using TRHOType = std::common_type_t<std::decay_t<TTYPE>, std::decay_t<RhoType>, std::decay_t<decltype(mole_fractions[0])>, std::decay_t<decltype(m[0])>>;
         
-        SAFTCalc<TTYPE, TRHOType> c;
-        c.m2_epsilon_sigma3_bar = static_cast<TRHOType>(0.0);
-        c.m2_epsilon2_sigma3_bar = static_cast<TRHOType>(0.0);
-        c.d.resize(N);
-        for (std::size_t i = 0; i < N; ++i) {
-            c.d[i] = sigma_Angstrom[i]*(1.0 - 0.12 * exp(-3.0*epsilon_over_k[i]/T)); // [A]
-            for (std::size_t j = 0; j < N; ++j) {
-                // Eq. A.5
-                auto sigma_ij = 0.5 * sigma_Angstrom[i] + 0.5 * sigma_Angstrom[j];
-                auto eij_over_k = sqrt(epsilon_over_k[i] * epsilon_over_k[j]) * (1.0 - kmat(i,j));
-                c.m2_epsilon_sigma3_bar = c.m2_epsilon_sigma3_bar + mole_fractions[i] * mole_fractions[j] * m[i] * m[j] * eij_over_k / T * pow(sigma_ij, 3);
-                c.m2_epsilon2_sigma3_bar = c.m2_epsilon2_sigma3_bar + mole_fractions[i] * mole_fractions[j] * m[i] * m[j] * pow(eij_over_k / T, 2) * pow(sigma_ij, 3);
-            }
-        }
+        // Eq. A.12 and Eq. A.13
+        auto m2_epsilon_sigma3_bar = forceeval(quadratic_form(m2_epsilon_sigma3, mole_fractions) / T);
+        auto m2_epsilon2_sigma3_bar = forceeval(quadratic_form(m2_epsilon2_sigma3, mole_fractions) / (T * T));
         auto mbar = (mole_fractions.template cast<TRHOType>().array()*m.template cast<TRHOType>().array()).sum();
         
         /// Convert from molar density to number density in molecules/Angstrom^3
@@ -232,14 +246,20 @@ public:
         constexpr double MY_PI = EIGEN_PI;
         double pi6 = (MY_PI / 6.0);
         
-        /// Evaluate the components of zeta
-        using ta = std::common_type_t<decltype(pi6), decltype(m[0]), decltype(c.d[0]), decltype(rho_A3)>;
-        std::vector<ta> zeta(4);
+        /// Evaluate the components of zeta (Eqn A.8)
+        using xmd_t = std::common_type_t<TTYPE, std::decay_t<decltype(mole_fractions[0])>>;
+        std::array<xmd_t, 4> xmdn{0.0, 0.0, 0.0, 0.0};
+        for (std::size_t i = 0; i < N; ++i) {
+            TTYPE dn = 1.0;
+            for (std::size_t n = 0; n < 4; ++n) {
+                xmdn[n] = xmdn[n] + mole_fractions[i]*m[i]*dn;
+                dn = dn*d[i];
+            }
+        }
+        using ta = std::common_type_t<decltype(pi6), decltype(m[0]), TTYPE, decltype(rho_A3), xmd_t>;
+        std::array<ta, 4> zeta;
         for (std::size_t n = 0; n < 4; ++n) {
-            // Eqn A.8
-            auto dn = pow(c.d, static_cast<int>(n));
-            TRHOType xmdn = forceeval((mole_fractions.template cast<TRHOType>().array()*m.template cast<TRHOType>().array()*dn.template cast<TRHOType>().array()).sum());
-            zeta[n] = forceeval(pi6*rho_A3*xmdn);
+            zeta[n] = forceeval(pi6*rho_A3*xmdn[n]);
         }
         
         /// Packing fraction is the 4-th value in zeta, at index 3
@@ -249,25 +269,71 @@ public:
         auto [I2, etadI2deta] = get_I2(eta, mbar);
         
         // Hard chain contribution from G&S
-        using tt = std::common_type_t<decltype(zeta[0]), decltype(c.d[0])>;
-        Eigen::ArrayX<tt> lngii_hs(mole_fractions.size());
-        for (auto i = 0; i < lngii_hs.size(); ++i) {
-            lngii_hs[i] = log(gij_HS(zeta, c.d, i, i));
+        using tt = std::common_type_t<decltype(zeta[0]), TTYPE, std::decay_t<decltype(mole_fractions[0])>>;
+        tt sum_lngii_hs = 0.0;
+        for (std::size_t i = 0; i < N; ++i) {
+            sum_lngii_hs = sum_lngii_hs + mole_fractions[i]*mminus1[i]*log(gij_HS(zeta, d, i, i));
         }
-        auto alphar_hc = forceeval(mbar * get_alphar_hs(zeta) - sumproduct(mole_fractions, mminus1, lngii_hs)); // Eq. A.4
+        auto alphar_hc = forceeval(mbar * get_alphar_hs(zeta) - sum_lngii_hs); // Eq. A.4
         
         // Dispersive contribution
-        auto alphar_disp = forceeval(-2 * MY_PI * rho_A3 * I1 * c.m2_epsilon_sigma3_bar - MY_PI * rho_A3 * mbar * C1(eta, mbar) * I2 * c.m2_epsilon2_sigma3_bar);
+        auto alphar_disp = forceeval(-2 * MY_PI * rho_A3 * I1 * m2_epsilon_sigma3_bar - MY_PI * rho_A3 * mbar * C1(eta, mbar) * I2 * m2_epsilon2_sigma3_bar);
                                      
         using eta_t = decltype(eta);
+        using zeta_t = decltype(zeta);
         using hc_t = decltype(alphar_hc);
         using disp_t = decltype(alphar_disp);
         struct PCSAFTHardChainContributionTerms{
             eta_t eta;
+            zeta_t zeta;
             hc_t alphar_hc;
             disp_t alphar_disp;
         };
-        return PCSAFTHardChainContributionTerms{forceeval(eta), forceeval(alphar_hc), forceeval(alphar_disp)};
+        return PCSAFTHardChainContributionTerms{forceeval(eta), zeta, forceeval(alphar_hc), forceeval(alphar_disp)};
+    }
+};
+
+/**
+ The association contribution of Gross and Sadowski, Ind. Eng. Chem. Res., 41, 2002, for any number of (associating or not) components,
+ with the combining rules of Wolbach and Sandler, Ind. Eng. Chem. Res., 37, 1998:
+ \f$\epsilon^{A_iB_j} = (\epsilon^{A_iB_i}+\epsilon^{A_jB_j})/2\f$ and
+ \f$\kappa^{A_iB_j} = \sqrt{\kappa^{A_iB_i}\kappa^{A_jB_j}}\left(\sqrt{\sigma_i\sigma_j}/\sigma_{ij}\right)^3\f$
+ */
+class PCSAFTAssociationContribution {
+private:
+    const association::Association assoc;
+
+    static auto build_association(const std::vector<SAFTCoeffs>& coeffs, const Eigen::ArrayX<double>& sigma_Angstrom) {
+        std::vector<association::association_classes> classes;
+        for (const auto& c : coeffs) {
+            classes.push_back(c.association_class);
+        }
+        auto combine = [&coeffs, &sigma_Angstrom](std::size_t i, std::size_t j) {
+            double epsij_over_k = (coeffs[i].epsilon_AB_over_k + coeffs[j].epsilon_AB_over_k) / 2.0;
+            // sigma_ij^3*kappa_ij, in A^3
+            double volij = pow(sigma_Angstrom[i] * sigma_Angstrom[j], 1.5) * sqrt(coeffs[i].kappa_AB * coeffs[j].kappa_AB);
+            return std::make_tuple(epsij_over_k, volij);
+        };
+        return association::Association(association::build_site_matrices(classes, combine));
+    }
+public:
+    PCSAFTAssociationContribution(const std::vector<SAFTCoeffs>& coeffs, const Eigen::ArrayX<double>& sigma_Angstrom)
+    : assoc(build_association(coeffs, sigma_Angstrom)) {}
+
+    const auto& get_association() const { return assoc; }
+
+    /// The contribution to alphar, with the segment diameters d in A from PCSAFTHardChainContribution::get_d
+    template<typename TTYPE, typename RhoType, typename ZetaType, typename VecType, typename DType>
+    auto eval(const TTYPE& T, const RhoType& rho_A3, const ZetaType& zeta, const VecType& mole_fractions, const DType& d) const {
+        // The contact value of the hard-sphere radial distribution function, Eq. A.7 from Gross and Sadowski, 2001
+        auto g = [&zeta, &d](std::size_t i, std::size_t j) { return gij_HS(zeta, d, i, j); };
+        auto alpha = assoc.alphar(T, rho_A3, mole_fractions, g);
+
+        using alpha_t = decltype(alpha);
+        struct PCSAFTAssociationContributionTerms {
+            alpha_t alpha;
+        };
+        return PCSAFTAssociationContributionTerms{alpha};
     }
 };
 
@@ -292,6 +358,7 @@ protected:
     PCSAFTHardChainContribution hardchain;
     std::optional<PCSAFTDipolarContribution> dipolar; // Can be present or not
     std::optional<PCSAFTQuadrupolarContribution> quadrupolar; // Can be present or not
+    std::optional<PCSAFTAssociationContribution> assoc; // Can be present or not
 
     void check_kmat(std::size_t N) {
         if (kmat.cols() != kmat.rows()) {
@@ -364,9 +431,20 @@ protected:
         }
         return PCSAFTQuadrupolarContribution(m, sigma_Angstrom, epsilon_over_k, Qstar2, nQ);
     }
+    auto build_association(const std::vector<SAFTCoeffs> &coeffs) -> std::optional<PCSAFTAssociationContribution>{
+        // The dispersive and hard chain initialization has already happened at this point
+        bool any = false;
+        for (const auto &coeff : coeffs) {
+            any = any || (coeff.association_class != teqp::association::association_classes::not_associating);
+        }
+        if (!any){
+            return std::nullopt; // No association contribution is present
+        }
+        return PCSAFTAssociationContribution(coeffs, sigma_Angstrom);
+    }
 public:
     PCSAFTMixture(const std::vector<std::string> &names, const Eigen::ArrayXXd& kmat = {}) : PCSAFTMixture(get_coeffs_from_names(names), kmat){};
-    PCSAFTMixture(const std::vector<SAFTCoeffs> &coeffs, const Eigen::ArrayXXd &kmat = {}) : names(extract_names(coeffs)), kmat(kmat), hardchain(build_hardchain(coeffs)), dipolar(build_dipolar(coeffs)), quadrupolar(build_quadrupolar(coeffs)) {};
+    PCSAFTMixture(const std::vector<SAFTCoeffs> &coeffs, const Eigen::ArrayXXd &kmat = {}) : names(extract_names(coeffs)), kmat(kmat), hardchain(build_hardchain(coeffs)), dipolar(build_dipolar(coeffs)), quadrupolar(build_quadrupolar(coeffs)), assoc(build_association(coeffs)) {};
     
 //    PCSAFTMixture( const PCSAFTMixture& ) = delete; // non construction-copyable
     PCSAFTMixture& operator=( const PCSAFTMixture& ) = delete; // non copyable
@@ -403,8 +481,12 @@ public:
 
     template<typename TTYPE, typename RhoType, typename VecType>
     auto alphar(const TTYPE& T, const RhoType& rhomolar, const VecType& mole_fractions) const {
+        // The segment diameters, shared by the hard chain and the association
+        SmallBuffer<TTYPE> d(m.size());
+        hardchain.get_d(T, d);
+        
         // First values for the chain with dispersion (always included)
-        auto vals = hardchain.eval(T, rhomolar, mole_fractions);
+        auto vals = hardchain.eval(T, rhomolar, mole_fractions, d);
         auto alphar = forceeval(vals.alphar_hc + vals.alphar_disp);
         
         auto rho_A3 = forceeval(rhomolar*N_A*1e-30);
@@ -418,6 +500,11 @@ public:
             auto valsquad = quadrupolar.value().eval(T, rho_A3, vals.eta, mole_fractions);
             alphar += valsquad.alpha;
         }
+        // If association is present, add its contribution
+        if (assoc){
+            auto valsassoc = assoc.value().eval(T, rho_A3, vals.zeta, mole_fractions, d);
+            alphar += valsassoc.alpha;
+        }
         return forceeval(alphar);
     }
 };
@@ -453,6 +540,11 @@ inline auto PCSAFTfactory(const nlohmann::json& spec) {
                 c.Qstar2 = j.at("(Q^*)^2");
                 c.nQ = j.at("nQ");
             }
+            if (j.contains("association_class")){
+                c.association_class = association::get_association_classes(j.at("association_class"));
+                c.epsilon_AB_over_k = j.at("epsilon_AB_over_k");
+                c.kappa_AB = j.at("kappa_AB");
+            }
             coeffs.push_back(c);
         }
         if (kmat && kmat.value().rows() != coeffs.size()){
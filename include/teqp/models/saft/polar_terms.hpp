@@ -14,15 +14,17 @@
 #include <optional>
 #include <Eigen/Dense>  
 #include "teqp/math/pow_templates.hpp"
+#include "teqp/math/forms.hpp"
+#include "teqp/small_buffer.hpp"
 #include <variant>
 
 namespace teqp{
 
 namespace SAFTpolar{
 
-/// Eq. 10 from Gross and Vrabec
-template <typename Eta, typename MType, typename TType>
-auto get_JDD_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
+/// The coefficients \f$a_{nij}\f$ (Eq. 12) and \f$b_{nij}\f$ (Eq. 13) of the powers of \f$\eta\f$ in Eq. 10 from Gross and Vrabec
+template <typename MType>
+auto get_JDD_2ij_coeffs(const MType& mij) {
     static Eigen::ArrayXd a_0 = (Eigen::ArrayXd(5) << 0.3043504, -0.1358588, 1.4493329, 0.3556977, -2.0653308).finished();
     static Eigen::ArrayXd a_1 = (Eigen::ArrayXd(5) << 0.9534641, -1.8396383, 2.0131180, -7.3724958, 8.2374135).finished();
     static Eigen::ArrayXd a_2 = (Eigen::ArrayXd(5) << -1.1610080, 4.5258607, 0.9751222, -12.281038, 5.9397575).finished();
@@ -31,32 +33,52 @@ auto get_JDD_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
     static Eigen::ArrayXd b_1 = (Eigen::ArrayXd(5) << -0.5873164, 1.2489132, -0.5085280, 0, 0).finished();
     static Eigen::ArrayXd b_2 = (Eigen::ArrayXd(5) << 3.4869576, -14.915974, 15.372022, 0, 0).finished();
     
+    std::array<MType, 5> anij, bnij;
+    for (auto n = 0; n < 5; ++n){
+        anij[n] = a_0[n] + (mij-1)/mij*a_1[n] + (mij-1)/mij*(mij-2)/mij*a_2[n]; // Eq. 12
+        bnij[n] = b_0[n] + (mij-1)/mij*b_1[n] + (mij-1)/mij*(mij-2)/mij*b_2[n]; // Eq. 13
+    }
+    return std::make_tuple(anij, bnij);
+}
+
+/// Eq. 10 from Gross and Vrabec
+template <typename Eta, typename MType, typename TType>
+auto get_JDD_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
+    const auto [anij, bnij] = get_JDD_2ij_coeffs(mij);
     std::common_type_t<Eta, MType, TType> summer = 0.0;
     for (auto n = 0; n < 5; ++n){
-        auto anij = a_0[n] + (mij-1)/mij*a_1[n] + (mij-1)/mij*(mij-2)/mij*a_2[n]; // Eq. 12
-        auto bnij = b_0[n] + (mij-1)/mij*b_1[n] + (mij-1)/mij*(mij-2)/mij*b_2[n]; // Eq. 13
-        summer += (anij + bnij/Tstarij)*pow(eta, n);
+        summer += (anij[n] + bnij[n]/Tstarij)*pow(eta, n);
     }
     return forceeval(summer);
 }
 
-/// Eq. 11 from Gross and Vrabec
-template <typename Eta, typename MType>
-auto get_JDD_3ijk(const Eta& eta, const MType& mijk) {
+/// The coefficients \f$c_{nijk}\f$ (Eq. 14) of the powers of \f$\eta\f$ in Eq. 11 from Gross and Vrabec
+template <typename MType>
+auto get_JDD_3ijk_coeffs(const MType& mijk) {
     static Eigen::ArrayXd c_0 = (Eigen::ArrayXd(5) << -0.0646774, 0.1975882, -0.8087562, 0.6902849, 0.0).finished();
     static Eigen::ArrayXd c_1 = (Eigen::ArrayXd(5) << -0.9520876, 2.9924258, -2.3802636, -0.2701261, 0.0).finished();
     static Eigen::ArrayXd c_2 = (Eigen::ArrayXd(5) << -0.6260979, 1.2924686, 1.6542783, -3.4396744, 0.0).finished();
+    std::array<MType, 5> cnijk;
+    for (auto n = 0; n < 5; ++n){
+        cnijk[n] = c_0[n] + (mijk-1)/mijk*c_1[n] + (mijk-1)/mijk*(mijk-2)/mijk*c_2[n]; // Eq. 14
+    }
+    return cnijk;
+}
+
+/// Eq. 11 from Gross and Vrabec
+template <typename Eta, typename MType>
+auto get_JDD_3ijk(const Eta& eta, const MType& mijk) {
+    const auto cnijk = get_JDD_3ijk_coeffs(mijk);
     std::common_type_t<Eta, MType> summer = 0.0;
     for (auto n = 0; n < 5; ++n){
-        auto cnijk = c_0[n] + (mijk-1)/mijk*c_1[n] + (mijk-1)/mijk*(mijk-2)/mijk*c_2[n]; // Eq. 14
-        summer += cnijk*pow(eta, n);
+        summer += cnijk[n]*pow(eta, n);
     }
     return forceeval(summer);
 }
 
-/// Eq. 12 from Gross and Vrabec, AICHEJ
-template <typename Eta, typename MType, typename TType>
-auto get_JQQ_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
+/// The coefficients \f$a_{nij}\f$ and \f$b_{nij}\f$ of the powers of \f$\eta\f$ in Eq. 12 from Gross and Vrabec, AICHEJ
+template <typename MType>
+auto get_JQQ_2ij_coeffs(const MType& mij) {
     static Eigen::ArrayXd a_0 = (Eigen::ArrayXd(5) << 1.2378308, 2.4355031, 1.6330905, -1.6118152, 6.9771185).finished();
     static Eigen::ArrayXd a_1 = (Eigen::ArrayXd(5) << 1.2854109, -11.465615, 22.086893, 7.4691383, -17.197772).finished();
     static Eigen::ArrayXd a_2 = (Eigen::ArrayXd(5) << 1.7942954, 0.7695103, 7.2647923, 94.486699, -77.148458).finished();
@@ -65,11 +87,21 @@ auto get_JQQ_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
     static Eigen::ArrayXd b_1 = (Eigen::ArrayXd(5) << -0.8137340, 10.064030, -10.876631, 0.0, 0.0).finished();
     static Eigen::ArrayXd b_2 = (Eigen::ArrayXd(5) << 6.8682675, -5.1732238, -17.240207, 0.0, 0.0).finished();
     
+    std::array<MType, 5> anij, bnij;
+    for (auto n = 0; n < 5; ++n){
+        anij[n] = a_0[n] + (mij-1)/mij*a_1[n] + (mij-1)/mij*(mij-2)/mij*a_2[n]; // Eq. 12
+        bnij[n] = b_0[n] + (mij-1)/mij*b_1[n] + (mij-1)/mij*(mij-2)/mij*b_2[n]; // Eq. 13
+    }
+    return std::make_tuple(anij, bnij);
+}
+
+/// Eq. 12 from Gross and Vrabec, AICHEJ
+template <typename Eta, typename MType, typename TType>
+auto get_JQQ_2ij(const Eta& eta, const MType& mij, const TType& Tstarij) {
+    const auto [anij, bnij] = get_JQQ_2ij_coeffs(mij);
     std::common_type_t<Eta, MType, TType> summer = 0.0;
     for (auto n = 0; n < 5; ++n){
-        auto anij = a_0[n] + (mij-1)/mij*a_1[n] + (mij-1)/mij*(mij-2)/mij*a_2[n]; // Eq. 12
-        auto bnij = b_0[n] + (mij-1)/mij*b_1[n] + (mij-1)/mij*(mij-2)/mij*b_2[n]; // Eq. 13
-        summer += (anij + bnij/Tstarij)*pow(eta, n);
+        summer += (anij[n] + bnij[n]/Tstarij)*pow(eta, n);
     }
     return forceeval(summer);
 }
@@ -123,15 +155,114 @@ auto get_JDQ_3ijk(const Eta& eta, const MType& mijk) {
     return forceeval(summer);
 }
 
+/**
+ The composition-independent parts of the two-body and three-body terms of Gross and Vrabec, for the components that carry the multipole.
+ 
+ Because the integrals \f$J\f$ are polynomials in the packing fraction, each term is a sum over the powers of \f$\eta\f$ of quadratic (two-body)
+ or cubic (three-body) forms in the mole fractions, and the coefficient tensors of those forms are built once at construction
+ */
+class GrossVrabecPolarForms {
+private:
+    std::vector<Eigen::Index> ipolar; ///< Indices of the components with a multipole
+    std::array<Eigen::ArrayXXd, 5> A2, ///< Two-body coefficients multiplying \f$\eta^n/T^2\f$
+        B2, ///< Two-body coefficients multiplying \f$\eta^n/T^3\f$
+        C3; ///< Three-body coefficients multiplying \f$\eta^n/T^3\f$, in the layout of teqp::cubic_form
+    
+    template<typename VecType, typename Function>
+    auto with_polar_molefracs(const VecType& mole_fractions, const Function& f) const {
+        using X = std::decay_t<decltype(mole_fractions[0])>;
+        const auto Np = static_cast<Eigen::Index>(ipolar.size());
+        SmallBuffer<X> buf(Np);
+        for (auto a = 0; a < Np; ++a){
+            buf[a] = mole_fractions[ipolar[a]];
+        }
+        if constexpr (std::is_same_v<X, double>){
+            return f(Eigen::Map<const Eigen::ArrayXd>(buf.data(), Np));
+        }
+        else{
+            return f(buf);
+        }
+    }
+public:
+    /**
+     \param n The number of multipolar segments; components with n = 0 are skipped
+     \param pre2 Callable pre2(i,j) returning everything in the two-body summand but the mole fractions, \f$1/T^2\f$ and \f$J_{ij}\f$
+     \param J2coeffs Callable J2coeffs(mij) returning the tuple of coefficients (a, b) of \f$J_{ij}\f$
+     \param pre3 Callable pre3(i,j,k) returning everything in the three-body summand but the mole fractions, \f$1/T^3\f$ and \f$J_{ijk}\f$
+     \param J3coeffs Callable J3coeffs(mijk) returning the coefficients c of \f$J_{ijk}\f$
+     */
+    template<typename Pre2, typename J2Coeffs, typename Pre3, typename J3Coeffs>
+    GrossVrabecPolarForms(const Eigen::ArrayXd& m, const Eigen::ArrayXd& epsilon_over_k, const Eigen::ArrayXd& n, const Pre2& pre2, const J2Coeffs& J2coeffs, const Pre3& pre3, const J3Coeffs& J3coeffs){
+        for (auto i = 0; i < n.size(); ++i){
+            if (n[i] > 0){ ipolar.push_back(i); }
+        }
+        const auto Np = static_cast<Eigen::Index>(ipolar.size());
+        for (auto& A : A2){ A.setZero(Np, Np); }
+        for (auto& B : B2){ B.setZero(Np, Np); }
+        for (auto& C : C3){ C.setZero(Np*Np, Np); }
+        for (auto a = 0; a < Np; ++a){
+            for (auto b = 0; b < Np; ++b){
+                const auto i = ipolar[a], j = ipolar[b];
+                // Lorentz-Berthelot mixing rules
+                const double epskij = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
+                const double mij = std::min(sqrt(m[i]*m[j]), 2.0);
+                const auto [anij, bnij] = J2coeffs(mij);
+                const double p2 = pre2(i, j);
+                for (auto nn = 0; nn < 5; ++nn){
+                    A2[nn](a, b) = p2*anij[nn];
+                    B2[nn](a, b) = p2*bnij[nn]*epskij; // Since T*_{ij} = T/epskij
+                }
+                for (auto c = 0; c < Np; ++c){
+                    const auto k = ipolar[c];
+                    const double mijk = std::min(pow(m[i]*m[j]*m[k], 1.0/3.0), 2.0);
+                    const auto cnijk = J3coeffs(mijk);
+                    const double p3 = pre3(i, j, k);
+                    for (auto nn = 0; nn < 5; ++nn){
+                        C3[nn](a + Np*b, c) = p3*cnijk[nn];
+                    }
+                }
+            }
+        }
+    }
+    
+    /// The two-body sum \f$\sum_i\sum_j x_ix_j\,{\rm pre}_{ij}J_{ij}(\eta, T)/T^2\f$
+    template<typename TTYPE, typename EtaType, typename VecType>
+    auto get_sum2(const TTYPE& T, const EtaType& eta, const VecType& mole_fractions) const {
+        return with_polar_molefracs(mole_fractions, [&](const auto& xp){
+            std::common_type_t<TTYPE, EtaType, std::decay_t<decltype(mole_fractions[0])>> summer = 0.0;
+            EtaType etan = 1.0;
+            for (auto nn = 0; nn < 5; ++nn){
+                summer += etan*(quadratic_form(A2[nn], xp) + quadratic_form(B2[nn], xp)/T);
+                etan = etan*eta;
+            }
+            return forceeval(summer/(T*T));
+        });
+    }
+    
+    /// The three-body sum \f$\sum_i\sum_j\sum_k x_ix_jx_k\,{\rm pre}_{ijk}J_{ijk}(\eta)/T^3\f$
+    template<typename TTYPE, typename EtaType, typename VecType>
+    auto get_sum3(const TTYPE& T, const EtaType& eta, const VecType& mole_fractions) const {
+        return with_polar_molefracs(mole_fractions, [&](const auto& xp){
+            std::common_type_t<TTYPE, EtaType, std::decay_t<decltype(mole_fractions[0])>> summer = 0.0;
+            EtaType etan = 1.0;
+            for (auto nn = 0; nn < 5; ++nn){
+                summer += etan*cubic_form(C3[nn], xp);
+                etan = etan*eta;
+            }
+            return forceeval(summer/(T*T*T));
+        });
+    }
+};
+
 /***
  * \brief The dipolar contribution given in Gross and Vrabec
  */
 class DipolarContributionGrossVrabec {
 private:
     const Eigen::ArrayXd m, sigma_Angstrom, epsilon_over_k, mustar2, nmu;
-public:
-    const bool has_a_polar;
-    DipolarContributionGrossVrabec(const Eigen::ArrayX<double> &m, const Eigen::ArrayX<double> &sigma_Angstrom, const Eigen::ArrayX<double> &epsilon_over_k, const Eigen::ArrayX<double> &mustar2, const Eigen::ArrayX<double> &nmu) : m(m), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), mustar2(mustar2), nmu(nmu), has_a_polar(mustar2.cwiseAbs().sum() > 0) {
+    const GrossVrabecPolarForms forms;
+    
+    auto build_forms() const {
         // Check lengths match
         if (m.size() != mustar2.size()){
             throw teqp::InvalidArgument("bad size of mustar2");
@@ -139,56 +270,32 @@ public:
         if (m.size() != nmu.size()){
             throw teqp::InvalidArgument("bad size of n");
         }
+        const auto& sigma = sigma_Angstrom; // concision
+        auto pre2 = [&](auto i, auto j){
+            auto sigmaij = (sigma[i]+sigma[j])/2;
+            return epsilon_over_k[i]*epsilon_over_k[j]*POW3(sigma[i]*sigma[j]/sigmaij)*nmu[i]*nmu[j]*mustar2[i]*mustar2[j];
+        };
+        auto pre3 = [&](auto i, auto j, auto k){
+            // Lorentz-Berthelot mixing rules for sigma
+            auto sigmaij = (sigma[i]+sigma[j])/2, sigmaik = (sigma[i]+sigma[k])/2, sigmajk = (sigma[j]+sigma[k])/2;
+            return epsilon_over_k[i]*epsilon_over_k[j]*epsilon_over_k[k]*POW3(sigma[i]*sigma[j]*sigma[k])/(sigmaij*sigmaik*sigmajk)*nmu[i]*nmu[j]*nmu[k]*mustar2[i]*mustar2[j]*mustar2[k];
+        };
+        return GrossVrabecPolarForms(m, epsilon_over_k, nmu, pre2, [](double mij){ return get_JDD_2ij_coeffs(mij); }, pre3, [](double mijk){ return get_JDD_3ijk_coeffs(mijk); });
     }
+public:
+    const bool has_a_polar;
+    DipolarContributionGrossVrabec(const Eigen::ArrayX<double> &m, const Eigen::ArrayX<double> &sigma_Angstrom, const Eigen::ArrayX<double> &epsilon_over_k, const Eigen::ArrayX<double> &mustar2, const Eigen::ArrayX<double> &nmu) : m(m), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), mustar2(mustar2), nmu(nmu), forms(build_forms()), has_a_polar(mustar2.cwiseAbs().sum() > 0) {}
     
     /// Eq. 8 from Gross and Vrabec
     template<typename TTYPE, typename RhoType, typename EtaType, typename VecType>
     auto get_alpha2DD(const TTYPE& T, const RhoType& rhoN_A3, const EtaType& eta, const VecType& mole_fractions) const{
-        const auto& x = mole_fractions; // concision
-        const auto& sigma = sigma_Angstrom; // concision
-        const auto N = mole_fractions.size();
-        std::common_type_t<TTYPE, RhoType, decltype(mole_fractions[0])> summer = 0.0;
-        for (auto i = 0; i < N; ++i){
-            for (auto j = 0; j < N; ++j){
-                auto ninj = nmu[i]*nmu[j];
-                if (ninj > 0){
-                    // Lorentz-Berthelot mixing rules
-                    auto epskij = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
-                    auto sigmaij = (sigma[i]+sigma[j])/2;
-                    
-                    auto Tstarij = forceeval(T/epskij);
-                    auto mij = std::min(sqrt(m[i]*m[j]), 2.0);
-                    summer += x[i]*x[j]*epsilon_over_k[i]/T*epsilon_over_k[j]/T*POW3(sigma[i]*sigma[j]/sigmaij)*ninj*mustar2[i]*mustar2[j]*get_JDD_2ij(eta, mij, Tstarij);
-                }
-            }
-        }
-        return forceeval(-static_cast<double>(EIGEN_PI)*rhoN_A3*summer);
+        return forceeval(-static_cast<double>(EIGEN_PI)*rhoN_A3*forms.get_sum2(T, eta, mole_fractions));
     }
     
     /// Eq. 9 from Gross and Vrabec
     template<typename TTYPE, typename RhoType, typename EtaType, typename VecType>
     auto get_alpha3DD(const TTYPE& T, const RhoType& rhoN_A3, const EtaType& eta, const VecType& mole_fractions) const{
-        const auto& x = mole_fractions; // concision
-        const auto& sigma = sigma_Angstrom; // concision
-        const auto N = mole_fractions.size();
-        std::common_type_t<TTYPE, RhoType, decltype(mole_fractions[0])> summer = 0.0;
-        for (auto i = 0; i < N; ++i){
-            for (auto j = 0; j < N; ++j){
-                for (auto k = 0; k < N; ++k){
-                    auto ninjnk = nmu[i]*nmu[j]*nmu[k];
-                    if (ninjnk > 0){
-                        // Lorentz-Berthelot mixing rules for sigma
-                        auto sigmaij = (sigma[i]+sigma[j])/2;
-                        auto sigmaik = (sigma[i]+sigma[k])/2;
-                        auto sigmajk = (sigma[j]+sigma[k])/2;
-                        
-                        auto mijk = std::min(pow(m[i]*m[j]*m[k], 1.0/3.0), 2.0);
-                        summer += x[i]*x[j]*x[k]*epsilon_over_k[i]/T*epsilon_over_k[j]/T*epsilon_over_k[k]/T*POW3(sigma[i]*sigma[j]*sigma[k])/(sigmaij*sigmaik*sigmajk)*ninjnk*mustar2[i]*mustar2[j]*mustar2[k]*get_JDD_3ijk(eta, mijk);
-                    }
-                }
-            }
-        }
-        return forceeval(-4.0*POW2(static_cast<double>(EIGEN_PI))/3.0*POW2(rhoN_A3)*summer);
+        return forceeval(-4.0*POW2(static_cast<double>(EIGEN_PI))/3.0*POW2(rhoN_A3)*forms.get_sum3(T, eta, mole_fractions));
     }
     
     /***
@@ -219,10 +326,9 @@ public:
 class QuadrupolarContributionGross {
 private:
     const Eigen::ArrayXd m, sigma_Angstrom, epsilon_over_k, Qstar2, nQ;
+    const GrossVrabecPolarForms forms;
     
-public:
-    const bool has_a_polar;
-    QuadrupolarContributionGross(const Eigen::ArrayX<double> &m, const Eigen::ArrayX<double> &sigma_Angstrom, const Eigen::ArrayX<double> &epsilon_over_k, const Eigen::ArrayX<double> &Qstar2, const Eigen::ArrayX<double> &nQ) : m(m), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), Qstar2(Qstar2), nQ(nQ), has_a_polar(Qstar2.cwiseAbs().sum() > 0) {
+    auto build_forms() const {
         // Check lengths match
         if (m.size() != Qstar2.size()){
             throw teqp::InvalidArgument("bad size of mustar2");
@@ -230,57 +336,34 @@ public:
         if (m.size() != nQ.size()){
             throw teqp::InvalidArgument("bad size of n");
         }
+        const auto& sigma = sigma_Angstrom; // concision
+        auto pre2 = [&](auto i, auto j){
+            auto sigmaij = (sigma[i]+sigma[j])/2;
+            return epsilon_over_k[i]*epsilon_over_k[j]*POW5(sigma[i]*sigma[j])/POW7(sigmaij)*nQ[i]*nQ[j]*Qstar2[i]*Qstar2[j];
+        };
+        auto pre3 = [&](auto i, auto j, auto k){
+            // Lorentz-Berthelot mixing rules for sigma
+            auto sigmaij = (sigma[i]+sigma[j])/2, sigmaik = (sigma[i]+sigma[k])/2, sigmajk = (sigma[j]+sigma[k])/2;
+            return epsilon_over_k[i]*epsilon_over_k[j]*epsilon_over_k[k]*POW5(sigma[i]*sigma[j]*sigma[k])/POW3(sigmaij*sigmaik*sigmajk)*nQ[i]*nQ[j]*nQ[k]*Qstar2[i]*Qstar2[j]*Qstar2[k];
+        };
+        return GrossVrabecPolarForms(m, epsilon_over_k, nQ, pre2, [](double mij){ return get_JQQ_2ij_coeffs(mij); }, pre3, [](double mijk){ return get_JDD_3ijk_coeffs(mijk); });
     }
+    
+public:
+    const bool has_a_polar;
+    QuadrupolarContributionGross(const Eigen::ArrayX<double> &m, const Eigen::ArrayX<double> &sigma_Angstrom, const Eigen::ArrayX<double> &epsilon_over_k, const Eigen::ArrayX<double> &Qstar2, const Eigen::ArrayX<double> &nQ) : m(m), sigma_Angstrom(sigma_Angstrom), epsilon_over_k(epsilon_over_k), Qstar2(Qstar2), nQ(nQ), forms(build_forms()), has_a_polar(Qstar2.cwiseAbs().sum() > 0) {}
     QuadrupolarContributionGross& operator=( const QuadrupolarContributionGross& ) = delete; // non copyable
     
     /// Eq. 9 from Gross, AICHEJ, doi: 10.1002/aic.10502
     template<typename TTYPE, typename RhoType, typename EtaType, typename VecType>
     auto get_alpha2QQ(const TTYPE& T, const RhoType& rhoN_A3, const EtaType& eta, const VecType& mole_fractions) const{
-        const auto& x = mole_fractions; // concision
-        const auto& sigma = sigma_Angstrom; // concision
-        const auto N = mole_fractions.size();
-        std::common_type_t<TTYPE, RhoType, decltype(mole_fractions[0])> summer = 0.0;
-        for (auto i = 0; i < N; ++i){
-            for (auto j = 0; j < N; ++j){
-                auto ninj = nQ[i]*nQ[j];
-                if (ninj > 0){
-                    // Lorentz-Berthelot mixing rules
-                    auto epskij = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
-                    auto sigmaij = (sigma[i]+sigma[j])/2;
-                    
-                    auto Tstarij = forceeval(T/epskij);
-                    auto mij = std::min(sqrt(m[i]*m[j]), 2.0);
-                    summer += x[i]*x[j]*epsilon_over_k[i]/T*epsilon_over_k[j]/T*POW5(sigma[i]*sigma[j])/POW7(sigmaij)*ninj*Qstar2[i]*Qstar2[j]*get_JQQ_2ij(eta, mij, Tstarij);
-                }
-            }
-        }
-        return forceeval(-static_cast<double>(EIGEN_PI)*POW2(3.0/4.0)*rhoN_A3*summer);
+        return forceeval(-static_cast<double>(EIGEN_PI)*POW2(3.0/4.0)*rhoN_A3*forms.get_sum2(T, eta, mole_fractions));
     }
     
     /// Eq. 10 from Gross, AICHEJ, doi: 10.1002/aic.10502
     template<typename TTYPE, typename RhoType, typename EtaType, typename VecType>
     auto get_alpha3QQ(const TTYPE& T, const RhoType& rhoN_A3, const EtaType& eta, const VecType& mole_fractions) const{
-        const auto& x = mole_fractions; // concision
-        const auto& sigma = sigma_Angstrom; // concision
-        const std::size_t N = mole_fractions.size();
-        std::common_type_t<TTYPE, RhoType, decltype(mole_fractions[0])> summer = 0.0;
-        for (std::size_t i = 0; i < N; ++i){
-            for (std::size_t j = 0; j < N; ++j){
-                for (std::size_t k = 0; k < N; ++k){
-                    auto ninjnk = nQ[i]*nQ[j]*nQ[k];
-                    if (ninjnk > 0){
-                        // Lorentz-Berthelot mixing rules for sigma
-                        auto sigmaij = (sigma[i]+sigma[j])/2;
-                        auto sigmaik = (sigma[i]+sigma[k])/2;
-                        auto sigmajk = (sigma[j]+sigma[k])/2;
-                        
-                        auto mijk = std::min(pow(m[i]*m[j]*m[k], 1.0/3.0), 2.0);
-                        summer += x[i]*x[j]*x[k]*epsilon_over_k[i]/T*epsilon_over_k[j]/T*epsilon_over_k[k]/T*POW5(sigma[i]*sigma[j]*sigma[k])/POW3(sigmaij*sigmaik*sigmajk)*ninjnk*Qstar2[i]*Qstar2[j]*Qstar2[k]*get_JDD_3ijk(eta, mijk);
-                    }
-                }
-            }
-        }
-        return forceeval(-4.0*POW2(static_cast<double>(EIGEN_PI))/3.0*POW3(3.0/4.0)*POW2(rhoN_A3)*summer);
+        return forceeval(-4.0*POW2(static_cast<double>(EIGEN_PI))/3.0*POW3(3.0/4.0)*POW2(rhoN_A3)*forms.get_sum3(T, eta, mole_fractions));
     }
     
     /***
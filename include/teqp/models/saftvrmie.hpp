@@ -12,6 +12,7 @@
 #include "teqp/exceptions.hpp"
 #include "teqp/constants.hpp"
 #include "teqp/math/quadrature.hpp"
+#include "teqp/math/chebyshev.hpp"
 #include "teqp/models/saft/polar_terms.hpp"
 #include <optional>
 #include <variant>
@@ -236,6 +237,33 @@ struct SAFTVRMieChainContributionTerms{
         return get_cij(lambda_r_ij + lambda_a_ij);
     }
     
+    /**
+     Build the expansions of \f$d_{ii}(T)\f$ when the flags contain an entry "dii_Chebyshev", e.g.
+     \verbatim "dii_Chebyshev": {} \endverbatim
+     The expansion of component i covers the reduced temperatures \f$0.1 \leq T/(\epsilon_i/k_B) \leq 100\f$, a range that can be narrowed
+     (but not widened) with "Tmin / K" and "Tmax / K". Optionally also with the "degree" of the expansions (default 16) and the relative
+     tolerance "rtol" on the coefficients (default 1e-14). Once the expansions are built, get_dmat rejects temperatures outside their range
+     */
+    std::optional<std::vector<PiecewiseChebyshev>> build_dii_Chebyshev(const std::optional<nlohmann::json>& flags) const {
+        if (!flags || !flags.value().contains("dii_Chebyshev")){
+            return std::nullopt;
+        }
+        const nlohmann::json& j = flags.value().at("dii_Chebyshev");
+        int degree = j.value("degree", 16);
+        double rtol = j.value("rtol", 1e-14);
+        std::vector<PiecewiseChebyshev> expansions;
+        for (auto i = 0U; i < N; ++i){
+            double Tmin = 0.1*epsilon_over_k[i], Tmax = 100.0*epsilon_over_k[i];
+            if (j.contains("Tmin / K")){ Tmin = std::max(Tmin, j.at("Tmin / K").get<double>()); }
+            if (j.contains("Tmax / K")){ Tmax = std::min(Tmax, j.at("Tmax / K").get<double>()); }
+            if (!(Tmax > Tmin)){
+                throw teqp::InvalidArgument("The temperature range of the expansion of d for component " + std::to_string(i) + " is empty");
+            }
+            expansions.push_back(fit_piecewise_Chebyshev([this, i](double T){ return get_dii(i, T); }, Tmin, Tmax, degree, rtol));
+        }
+        return expansions;
+    }
+    
     EpsilonijFlags get_epsilon_ij(const std::optional<nlohmann::json>& flags){
         if (flags){
             const nlohmann::json& j = flags.value();
@@ -260,6 +288,9 @@ struct SAFTVRMieChainContributionTerms{
 
     const std::vector<Eigen::ArrayXXd> crnij, canij, c2rnij, c2anij, carnij;
     const std::vector<Eigen::ArrayXXd> fkij; // Matrices of parameters
+    
+    /// Piecewise Chebyshev expansions of \f$d_{ii}(T)\f$ for each component, if requested in the flags
+    const std::optional<std::vector<PiecewiseChebyshev>> dii_Chebyshev;
 
     SAFTVRMieChainContributionTerms(
             const Eigen::ArrayXd& m,
@@ -277,7 +308,8 @@ struct SAFTVRMieChainContributionTerms{
         sigma_ij(get_sigma_ij()), epsilon_ij(get_epsilon_ij()),
         crnij(get_crnij()), canij(get_canij()),
         c2rnij(get_c2rnij()), c2anij(get_c2anij()), carnij(get_carnij()),
-        fkij(get_fkij())
+        fkij(get_fkij()),
+        dii_Chebyshev(build_dii_Chebyshev(flags))
     {}
     
     /// Get the matrix of \f$\varepsilon_{ij}/k_B\f$ with the entries in K
@@ -360,7 +392,7 @@ struct SAFTVRMieChainContributionTerms{
     */
     template <typename TType>
     TType get_dii(std::size_t i, const TType &T) const{
-        std::function<TType(TType)> integrand = [this, i, &T](const TType& r){
+        auto integrand = [this, i, &T](const TType& r){
             return forceeval(1.0-exp(-this->get_uii_over_kB(i, r)/T));
         };
         
@@ -378,9 +410,19 @@ struct SAFTVRMieChainContributionTerms{
     template <typename TType>
     auto get_dmat(const TType &T) const{
         Eigen::Array<TType, Eigen::Dynamic, Eigen::Dynamic> d(N,N);
-        // For the pure components, by integration
+        // For the pure components, by integration, or from the expansions of the integrals if available
+        double Tbase = getbaseval(T);
         for (auto i = 0; i < N; ++i){
-            d(i,i) = get_dii(i, T);
+            if (dii_Chebyshev){
+                const auto& pw = dii_Chebyshev.value()[i];
+                if (!pw.contains(Tbase)){
+                    throw teqp::InvalidArgument("T of " + std::to_string(Tbase) + " K is outside the range [" + std::to_string(pw.get_xmin()) + ", " + std::to_string(pw.get_xmax()) + "] K of the expansion of d for component " + std::to_string(i));
+                }
+                d(i,i) = pw.eval(T, Tbase);
+            }
+            else{
+                d(i,i) = get_dii(i, T);
+            }
         }
         // The cross terms, using the linear mixing rule
         for (auto i = 0; i < N; ++i){
@@ -937,13 +979,17 @@ inline auto SAFTVRMiefactory(const nlohmann::json & spec){
     if (spec.contains("kmat") && spec.at("kmat").is_array() && spec.at("kmat").size() > 0){
         kmat = build_square_matrix(spec["kmat"]);
     }
+    std::optional<nlohmann::json> SAFTVRMie_flags = std::nullopt;
+    if (spec.contains("SAFTVRMie_flags")){
+        SAFTVRMie_flags = spec["SAFTVRMie_flags"];
+    }
     
     if (spec.contains("names")){
         std::vector<std::string> names = spec["names"];
         if (kmat && kmat.value().rows() != names.size()){
             throw teqp::InvalidArgument("Provided length of names of " + std::to_string(names.size()) + " does not match the dimension of the kmat of " + std::to_string(kmat.value().rows()));
         }
-        return SAFTVRMieMixture(names, kmat);
+        return SAFTVRMieMixture(names, kmat, SAFTVRMie_flags);
     }
     else if (spec.contains("coeffs")){
         bool something_polar = false;
@@ -980,7 +1026,7 @@ inline auto SAFTVRMiefactory(const nlohmann::json & spec){
         
         if (!something_polar){
             // Nonpolar, just m, epsilon, sigma and possibly a kmat matrix with kij coefficients
-            return SAFTVRMieMixture(SAFTVRMieMixture::build_chain(coeffs, kmat), coeffs);
+            return SAFTVRMieMixture(SAFTVRMieMixture::build_chain(coeffs, kmat, SAFTVRMie_flags), coeffs);
         }
         else{
             // Polar term is also provided, along with the chain terms
@@ -988,10 +1034,6 @@ inline auto SAFTVRMiefactory(const nlohmann::json & spec){
             if (spec.contains("polar_model")){
                 polar_model = spec["polar_model"];
             }
-            std::optional<nlohmann::json> SAFTVRMie_flags = std::nullopt;
-            if (spec.contains("SAFTVRMie_flags")){
-                SAFTVRMie_flags = spec["SAFTVRMie_flags"];
-            }
             std::optional<nlohmann::json> polar_flags = std::nullopt;
             if (spec.contains("polar_flags")){
                 polar_flags = spec["polar_flags"];
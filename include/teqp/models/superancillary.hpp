@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include "nlohmann/json.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/math/chebyshev.hpp"
+
+namespace teqp{
+
+    /**
+     A saturation property of a pure fluid, stored as piecewise Chebyshev expansions in the variable \f$x=\sqrt{T_c-T}\f$
+
+     For models with classical critical behavior, the saturated densities are analytic functions of \f$\sqrt{T_c-T}\f$ rather than of
+     \f$T\f$, so the expansions in \f$x\f$ converge quickly all the way up to the critical point, where expansions in \f$T\f$ would require
+     ever smaller intervals. Properties that span many orders of magnitude (the vapor density and the pressure) are expanded in their logarithm.
+
+     The values at the boundaries of the intervals are stored so that monotonic curves can also be inverted, giving for instance the
+     saturation temperature at a given pressure
+     */
+    struct SuperAncillaryCurve{
+        const PiecewiseChebyshev exps;
+        const double Tcrit, Tmin;
+        const bool logarithmic; ///< If true, the expansions are of the logarithm of the property
+        const std::vector<double> ybounds; ///< The values of the expansions at the boundaries of the intervals
+        const bool monotonic;
+
+        SuperAncillaryCurve(const PiecewiseChebyshev& exps, double Tcrit, double Tmin, bool logarithmic) : exps(exps), Tcrit(Tcrit), Tmin(Tmin), logarithmic(logarithmic), ybounds(get_ybounds(this->exps)), monotonic(internal::is_strictly_monotonic(ybounds)){};
+
+        SuperAncillaryCurve(const nlohmann::json& j) :
+            exps(exps_from_json(j.at("expansions"))),
+            Tcrit(j.at("Tcrit / K")),
+            Tmin(j.at("Tmin / K")),
+            logarithmic(j.at("logarithmic")),
+            ybounds(get_ybounds(exps)),
+            monotonic(internal::is_strictly_monotonic(ybounds)){};
+
+        static std::vector<double> get_ybounds(const PiecewiseChebyshev& pw){
+            return internal::get_interval_bounds(pw.expansions, [](const ChebyshevExpansion& e, double x){ return e.eval(x); });
+        }
+
+        static PiecewiseChebyshev exps_from_json(const nlohmann::json& j){
+            PiecewiseChebyshev pw;
+            for (auto& jexp : j){
+                pw.expansions.push_back(ChebyshevExpansion{jexp.at("coef").get<std::vector<double>>(), jexp.at("xmin"), jexp.at("xmax")});
+            }
+            if (pw.expansions.empty()){
+                throw teqp::InvalidArgument("At least one expansion is required");
+            }
+            return pw;
+        }
+
+        nlohmann::json to_json() const{
+            nlohmann::json jexps = nlohmann::json::array();
+            for (auto& ce : exps.expansions){
+                jexps.push_back({{"xmin", ce.xmin}, {"xmax", ce.xmax}, {"coef", ce.coeff}});
+            }
+            return {{"Tcrit / K", Tcrit}, {"Tmin / K", Tmin}, {"logarithmic", logarithmic}, {"expansions", jexps}};
+        }
+
+        double operator() (double T) const{
+            if (T > Tcrit || T < Tmin) {
+                throw teqp::InvalidArgument("Input temperature of " + std::to_string(T) + " K is outside the range [" + std::to_string(Tmin) + ", " + std::to_string(Tcrit) + "] K of the superancillary");
+            }
+            double x = sqrt(Tcrit - T);
+            double y = exps.eval(x, x);
+            return (logarithmic) ? exp(y) : y;
+        };
+
+        /// The temperature at which the property is equal to the given value
+        double solve_for_T(double value) const{
+            if (!monotonic){
+                throw teqp::InvalidArgument("The superancillary curve is not monotonic so it cannot be inverted");
+            }
+            double y = (logarithmic) ? log(value) : value;
+            auto i = internal::get_monotonic_interval(ybounds, y);
+            double x = exps.expansions[i].solve_for_x(y);
+            return std::clamp(Tcrit - x*x, Tmin, Tcrit);
+        };
+    };
+
+    /**
+     The superancillary equations of a pure fluid, giving the saturated liquid and vapor densities and the vapor pressure
+     from the critical point down to the minimum temperature without any iteration.
+
+     They are obtained from a model with ancillaries::build_superancillaries, and can be stored as JSON with to_json
+     */
+    struct SuperAncillaryVLE{
+        const double Tcrit, rhocrit, pcrit, Tmin;
+        const SuperAncillaryCurve rhoL, rhoV, p;
+
+        SuperAncillaryVLE(const nlohmann::json& j) :
+            Tcrit(j.at("Tcrit / K")),
+            rhocrit(j.at("rhocrit / mol/m^3")),
+            pcrit(j.at("pcrit / Pa")),
+            Tmin(j.at("Tmin / K")),
+            rhoL(j.at("rhoL")),
+            rhoV(j.at("rhoV")),
+            p(j.at("p")){};
+
+        SuperAncillaryVLE(double Tcrit, double rhocrit, double pcrit, double Tmin, const SuperAncillaryCurve& rhoL, const SuperAncillaryCurve& rhoV, const SuperAncillaryCurve& p) :
+            Tcrit(Tcrit), rhocrit(rhocrit), pcrit(pcrit), Tmin(Tmin), rhoL(rhoL), rhoV(rhoV), p(p){};
+
+        nlohmann::json to_json() const{
+            return {
+                {"Tcrit / K", Tcrit},
+                {"rhocrit / mol/m^3", rhocrit},
+                {"pcrit / Pa", pcrit},
+                {"Tmin / K", Tmin},
+                {"rhoL", rhoL.to_json()},
+                {"rhoV", rhoV.to_json()},
+                {"p", p.to_json()}
+            };
+        }
+    };
+}
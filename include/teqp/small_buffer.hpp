@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+namespace teqp{
+
+/**
+ A contiguous buffer whose length is known only at runtime, for per-call temporaries (e.g., one value per component).
+ 
+ The values live on the stack when there are no more than Nstack of them, and on the heap otherwise, so the common case
+ of a few components does not allocate. The stack storage is left uninitialized and only the N values in use are constructed,
+ which matters when T is an automatic differentiation type. Not copyable, as the data pointer may point into the object itself
+ */
+template<typename T, std::size_t Nstack = 16>
+class SmallBuffer {
+private:
+    alignas(T) unsigned char stack_[Nstack*sizeof(T)];
+    std::vector<T> heap_;
+    T* data_;
+    std::size_t size_;
+    bool on_stack() const { return size_ <= Nstack; }
+public:
+    explicit SmallBuffer(std::size_t N) : size_(N) {
+        if (on_stack()){
+            data_ = reinterpret_cast<T*>(stack_);
+            for (std::size_t i = 0; i < N; ++i){
+                ::new (static_cast<void*>(data_ + i)) T();
+            }
+        }
+        else{
+            heap_.resize(N);
+            data_ = heap_.data();
+        }
+    }
+    ~SmallBuffer(){
+        if (on_stack()){
+            for (std::size_t i = 0; i < size_; ++i){
+                data_[i].~T();
+            }
+        }
+    }
+    SmallBuffer(const SmallBuffer&) = delete;
+    SmallBuffer& operator=(const SmallBuffer&) = delete;
+    
+    T& operator[](std::size_t i){ return data_[i]; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+    T* data(){ return data_; }
+    const T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+};
+
+}
@@ -78,6 +78,9 @@ namespace teqp {
     template<typename T> struct is_mcx_t<mcx::MultiComplex<T>> : public std::true_type {};
 #endif
 
+    /// Specialized to true for the HessianDual numbers in teqp/math/hessian_dual.hpp
+    template<typename T> struct is_hessian_dual_t : public std::false_type {};
+
     // Extract the underlying value from more complicated numerical types, like complex step types with
     // a tiny increment in the imaginary direction
     template<typename T>
@@ -104,6 +107,9 @@ namespace teqp {
             return expr.real();
 #endif
         }
+        else if constexpr (is_hessian_dual_t<T>()) {
+            return expr.val;
+        }
 #if defined(TEQP_MULTIPRECISION_ENABLED)
         else if constexpr (boost::multiprecision::is_number<T>()) {
             return static_cast<double>(expr);
@@ -3,9 +3,14 @@
  * to allow for features only available in C++ and avoiding C memory management
  */
 
-#include <unordered_map>
 #include <variant>
 #include <atomic>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstring>
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
@@ -30,11 +35,126 @@
 
 using namespace teqp;
 
-// An atomic is used here for thread safety
-// The max possible index is 18,446,744,073,709,551,615
-std::atomic<long long int> next_index{ 0 };
+/**
+ A thread-safe registry of the models that have been built, indexed by an integer handle
 
-std::unordered_map<unsigned long long int, std::shared_ptr<teqp::cppinterface::AbstractModel>> library;
+ The models are stored in slots that never move once allocated (they live in fixed-size segments). The handle
+ is the slot index in the low 32 bits and a generation counter in the high bits, so a handle that has been freed
+ is never confused with a later model reusing the same slot.
+
+ Lookups are wait-free: the reader increments the active count of the slot, checks the handle stored in the slot
+ and reads the model pointer. Building and freeing models are serialized with a mutex, and freeing a model clears the slot
+ and then waits until the active count of the slot drops to zero before destroying the model, so a model is never
+ destroyed while a lookup is using it.
+ */
+class ModelRegistry{
+public:
+    using handle_t = long long int;
+private:
+    struct Slot{
+        std::atomic<handle_t> handle{-1};
+        std::atomic<const cppinterface::AbstractModel*> model{nullptr};
+        std::atomic<std::size_t> active{0};
+        std::uint32_t generation = 0; ///< Only touched with the writer mutex held
+        std::unique_ptr<cppinterface::AbstractModel> owner; ///< Only touched with the writer mutex held
+    };
+    static constexpr std::size_t slots_per_segment = 1024, max_segments = 4096;
+    using Segment = std::array<Slot, slots_per_segment>;
+    
+    std::array<std::atomic<Segment*>, max_segments> segments{};
+    std::mutex writer_mutex;
+    std::vector<std::size_t> free_slots;
+    std::size_t Nslots = 0;
+    
+    Slot* get_slot(std::size_t islot) const {
+        if (islot >= slots_per_segment*max_segments){ return nullptr; }
+        Segment* seg = segments[islot/slots_per_segment].load(std::memory_order_acquire);
+        return (seg == nullptr) ? nullptr : &((*seg)[islot % slots_per_segment]);
+    }
+    static std::size_t slot_index(handle_t handle){ return static_cast<std::size_t>(handle & 0xFFFFFFFFLL); }
+    
+public:
+    /// A lease keeps the model alive until the lease goes out of scope
+    class Lease{
+    private:
+        Slot* slot;
+        const cppinterface::AbstractModel* m;
+    public:
+        Lease(Slot* slot, const cppinterface::AbstractModel* m) : slot(slot), m(m) {};
+        Lease(const Lease&) = delete;
+        Lease(Lease&& other) : slot(other.slot), m(other.m) { other.slot = nullptr; };
+        ~Lease(){ if (slot != nullptr){ slot->active.fetch_sub(1); } }
+        const cppinterface::AbstractModel* operator->() const { return m; }
+        const cppinterface::AbstractModel* get() const { return m; }
+    };
+    
+    ~ModelRegistry(){
+        for (auto& seg : segments){
+            delete seg.load();
+        }
+    }
+    
+    handle_t add(std::unique_ptr<cppinterface::AbstractModel>&& model){
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        std::size_t islot;
+        if (!free_slots.empty()){
+            islot = free_slots.back(); free_slots.pop_back();
+        }
+        else{
+            islot = Nslots;
+            if (islot >= slots_per_segment*max_segments){
+                throw teqpcException(31, "Too many models are allocated");
+            }
+            auto& seg = segments[islot/slots_per_segment];
+            if (seg.load() == nullptr){
+                seg.store(new Segment(), std::memory_order_release);
+            }
+            Nslots++;
+        }
+        Slot& slot = *get_slot(islot);
+        slot.generation++;
+        handle_t handle = (static_cast<handle_t>(slot.generation & 0x7FFFFFFF) << 32) | static_cast<handle_t>(islot);
+        slot.owner = std::move(model);
+        slot.model.store(slot.owner.get());
+        slot.handle.store(handle); // Publishes the model to readers
+        return handle;
+    }
+    
+    void remove(handle_t handle){
+        std::unique_ptr<cppinterface::AbstractModel> doomed;
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            Slot* slot = (handle < 0) ? nullptr : get_slot(slot_index(handle));
+            if (slot == nullptr || slot->handle.load() != handle){
+                throw teqpcException(40, "Model handle " + std::to_string(handle) + " is not valid");
+            }
+            slot->handle.store(-1);
+            slot->model.store(nullptr);
+            // Wait for any lookups that might still see the old model to finish
+            while (slot->active.load() != 0){
+                std::this_thread::yield();
+            }
+            doomed = std::move(slot->owner);
+            free_slots.push_back(slot_index(handle));
+        }
+        // The model is destroyed here, outside the lock
+    }
+    
+    Lease lease(handle_t handle) const {
+        Slot* slot = (handle < 0) ? nullptr : get_slot(slot_index(handle));
+        if (slot != nullptr){
+            slot->active.fetch_add(1);
+            const auto* m = (slot->handle.load() == handle) ? slot->model.load() : nullptr;
+            if (m != nullptr){
+                return Lease(slot, m);
+            }
+            slot->active.fetch_sub(1);
+        }
+        throw teqpcException(40, "Model handle " + std::to_string(handle) + " is not valid");
+    }
+};
+
+ModelRegistry library;
 
 void exception_handler(int& errcode, char* message_buffer, const int buffer_length)
 {
@@ -70,14 +190,44 @@ EXPORT_CODE int CONVENTION build_model(const char* j, long long int* uuid, char*
     int errcode = 0;
     try{
         nlohmann::json json = nlohmann::json::parse(j);
-        long long int uid = next_index++;
+        std::unique_ptr<cppinterface::AbstractModel> model;
+        try {
+            // Validation is controlled by the "validate" field of the JSON, which is true by default
+            model = cppinterface::make_model(json, false);
+        }
+        catch (std::exception &e) {
+            throw teqpcException(30, "Unable to load with error:" + std::string(e.what()));
+        }
+        *uuid = library.add(std::move(model));
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION export_spec(const long long int uuid, const char* path, char* errmsg, int errmsg_length){
+    int errcode = 0;
+    try{
+        library.lease(uuid)->export_spec(path);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION build_model_from_exported_spec(const char* path, long long int* uuid, char* errmsg, int errmsg_length){
+    int errcode = 0;
+    try{
+        std::unique_ptr<cppinterface::AbstractModel> model;
         try {
-            library.emplace(std::make_pair(uid, cppinterface::make_model(json)));
+            model = cppinterface::make_model_from_exported_spec(path);
         }
         catch (std::exception &e) {
             throw teqpcException(30, "Unable to load with error:" + std::string(e.what()));
         }
-        *uuid = uid;
+        *uuid = library.add(std::move(model));
     }
     catch (...) {
         exception_handler(errcode, errmsg, errmsg_length);
@@ -88,7 +238,7 @@ EXPORT_CODE int CONVENTION build_model(const char* j, long long int* uuid, char*
 EXPORT_CODE int CONVENTION free_model(const long long int uuid, char* errmsg, int errmsg_length) {
     int errcode = 0;
     try {
-        library.erase(uuid);
+        library.remove(uuid);
     }
     catch (...) {
         exception_handler(errcode, errmsg, errmsg_length);
@@ -102,7 +252,161 @@ EXPORT_CODE int CONVENTION get_Arxy(const long long int uuid, const int NT, cons
         // Make an Eigen view of the double buffer
         Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
         // Call the function
-        *val = library.at(uuid)->get_Arxy(NT, ND, T, rho, molefrac_);
+        *val = library.lease(uuid)->get_Arxy(NT, ND, T, rho, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+ Resolve a handle into an opaque pointer to the model, which can be passed to the functions ending in _p and _batch,
+ skipping the lookup of the handle in each call. The pointer remains valid until free_model is called with the handle,
+ and it must not be used after (or concurrently with) that call.
+ */
+EXPORT_CODE int CONVENTION resolve_model(const long long int uuid, const void** model, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        *model = library.lease(uuid).get();
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+namespace{
+    const cppinterface::AbstractModel* as_model(const void* model){
+        if (model == nullptr){
+            throw teqpcException(41, "Model pointer is null");
+        }
+        return static_cast<const cppinterface::AbstractModel*>(model);
+    }
+    // Strided views of the buffers; all strides are in units of doubles
+    using StridedArray = Eigen::Map<const Eigen::ArrayXd, 0, Eigen::InnerStride<>>;
+    using StridedMatrix = Eigen::Map<const Eigen::ArrayXXd, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+    using WStridedArray = Eigen::Map<Eigen::ArrayXd, 0, Eigen::InnerStride<>>;
+    using WStridedMatrix = Eigen::Map<Eigen::ArrayXXd, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+    
+    void check_batch_args(const int N, const int Ncomp){
+        if (N < 0){ throw teqpcException(42, "Number of points must be non-negative"); }
+        if (Ncomp < 1){ throw teqpcException(42, "Number of components must be positive"); }
+    }
+}
+
+/// The same as get_Arxy, but taking the pointer obtained from resolve_model
+EXPORT_CODE int CONVENTION get_Arxy_p(const void* model, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        *val = as_model(model)->get_Arxy(NT, ND, T, rho, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+ Evaluate Ar_{NT,ND} at N state points with the pointer obtained from resolve_model
+ 
+ The k-th point has temperature T[k*T_stride], density rho[k*rho_stride], and its i-th mole fraction
+ at molefracs[k*molefrac_point_stride + i*molefrac_comp_stride], and the result is written to out[k*out_stride].
+ A C-ordered N x Ncomp array has strides (Ncomp, 1), a Fortran-ordered one has strides (1, N).
+ */
+EXPORT_CODE int CONVENTION get_Arxy_batch(const void* model, const int NT, const int ND, const int N, const double* T, const int T_stride, const double* rho, const int rho_stride, const double* molefracs, const int Ncomp, const int molefrac_point_stride, const int molefrac_comp_stride, double* out, const int out_stride, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_args(N, Ncomp);
+        StridedArray T_(T, N, Eigen::InnerStride<>(T_stride)), rho_(rho, N, Eigen::InnerStride<>(rho_stride));
+        StridedMatrix molefracs_(molefracs, N, Ncomp, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(molefrac_comp_stride, molefrac_point_stride));
+        if (out_stride == 1){
+            as_model(model)->get_Arxy_many(NT, ND, T_, rho_, molefracs_, Eigen::Map<Eigen::ArrayXd>(out, N));
+        }
+        else{
+            Eigen::ArrayXd buf(N);
+            as_model(model)->get_Arxy_many(NT, ND, T_, rho_, molefracs_, buf);
+            WStridedArray(out, N, Eigen::InnerStride<>(out_stride)) = buf;
+        }
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+ Evaluate the fugacity coefficients at N state points with the pointer obtained from resolve_model
+ 
+ The strides of the molar concentration vectors (rhovecs) and the output are as for the mole fractions in get_Arxy_batch
+ */
+EXPORT_CODE int CONVENTION get_fugacity_coefficients_batch(const void* model, const int N, const double* T, const int T_stride, const double* rhovecs, const int Ncomp, const int rhovec_point_stride, const int rhovec_comp_stride, double* out, const int out_point_stride, const int out_comp_stride, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_args(N, Ncomp);
+        StridedArray T_(T, N, Eigen::InnerStride<>(T_stride));
+        StridedMatrix rhovecs_(rhovecs, N, Ncomp, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(rhovec_comp_stride, rhovec_point_stride));
+        if (out_point_stride == 1 && out_comp_stride == N){
+            as_model(model)->get_fugacity_coefficients_many(T_, rhovecs_, Eigen::Map<Eigen::ArrayXXd>(out, N, Ncomp));
+        }
+        else{
+            Eigen::ArrayXXd buf(N, Ncomp);
+            as_model(model)->get_fugacity_coefficients_many(T_, rhovecs_, buf);
+            WStridedMatrix(out, N, Ncomp, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(out_comp_stride, out_point_stride)) = buf;
+        }
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+ Carry out a flash calculation with the pointer(s) obtained from resolve_model
+ 
+ The specification is one of "PT", "PH", "PS", "TS" or "UV", and val1 and val2 are the specified values in that order (with U and V molar,
+ in J/mol and m^3/mol). The ideal-gas model pointer may be null for a PT flash. If warm_start is nonzero, the values in T, p, beta, rhoL, rhoV,
+ x and y (each of length Ncomp) are taken to be the result of a flash at a nearby state and are used as the initial guess. On return,
+ those buffers hold the solution, and Nphases the number of phases found. An unsuccessful flash gives the error code 50.
+ */
+EXPORT_CODE int CONVENTION flash_calc(const void* model, const void* idealgas_model, const char* spec, const double val1, const double val2, const double* z, const int Ncomp, const int warm_start, double* T, double* p, double* beta, double* rhoL, double* rhoV, double* x, double* y, int* Nphases, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_args(0, Ncomp);
+        if (spec == nullptr || z == nullptr || T == nullptr || p == nullptr || beta == nullptr || rhoL == nullptr || rhoV == nullptr || x == nullptr || y == nullptr || Nphases == nullptr){
+            throw teqpcException(41, "A required pointer is null");
+        }
+        const std::string spec_(spec);
+        flash::FlashSpecification fs;
+        if (spec_ == "PT"){ fs = flash::FlashSpecification::PT; }
+        else if (spec_ == "PH"){ fs = flash::FlashSpecification::PH; }
+        else if (spec_ == "PS"){ fs = flash::FlashSpecification::PS; }
+        else if (spec_ == "TS"){ fs = flash::FlashSpecification::TS; }
+        else if (spec_ == "UV"){ fs = flash::FlashSpecification::UV; }
+        else{
+            throw teqpcException(42, "Flash specification \"" + spec_ + "\" is not one of PT, PH, PS, TS, UV");
+        }
+        const auto* aig = (idealgas_model == nullptr) ? nullptr : static_cast<const cppinterface::AbstractModel*>(idealgas_model);
+        Eigen::Map<const Eigen::ArrayXd> z_(z, Ncomp);
+        
+        std::optional<flash::FlashResult> guess;
+        if (warm_start != 0){
+            flash::FlashResult g;
+            g.success = true;
+            g.T = *T; g.p = *p; g.beta = *beta; g.rhoL = *rhoL; g.rhoV = *rhoV;
+            g.x = Eigen::Map<const Eigen::ArrayXd>(x, Ncomp);
+            g.y = Eigen::Map<const Eigen::ArrayXd>(y, Ncomp);
+            g.Nphases = (*beta > 0 && *beta < 1) ? 2 : 1;
+            guess = g;
+        }
+        auto r = as_model(model)->flash(fs, val1, val2, z_, aig, std::nullopt, guess);
+        if (!r.success){
+            throw teqpcException(50, "Flash calculation failed: " + r.message);
+        }
+        *T = r.T; *p = r.p; *beta = r.beta; *rhoL = r.rhoL; *rhoV = r.rhoV; *Nphases = r.Nphases;
+        Eigen::Map<Eigen::ArrayXd>(x, Ncomp) = r.x;
+        Eigen::Map<Eigen::ArrayXd>(y, Ncomp) = r.y;
     }
     catch (...) {
         exception_handler(errcode, errmsg, errmsg_length);
@@ -348,6 +652,135 @@ TEST_CASE("Use of C interface","[teqpc]") {
     };
     
 }
+
+TEST_CASE("Concurrent use of C interface","[teqpc]") {
+    constexpr int errmsg_length = 300;
+    const std::string j = R"({"kind":"vdW1", "model":{"a":1.0, "b":2.0}})";
+    std::valarray<double> molefrac = { 1.0 };
+    char errmsg[errmsg_length] = "";
+    
+    long long int uuidshared;
+    REQUIRE(build_model(j.c_str(), &uuidshared, errmsg, errmsg_length) == 0);
+    double expected = -1;
+    REQUIRE(get_Arxy(uuidshared, 0, 1, 300.0, 3.0e-6, &(molefrac[0]), 1, &expected, errmsg, errmsg_length) == 0);
+    
+    // Each thread builds, calls and frees its own models while also calling the shared model
+    const std::size_t Nthreads = std::max(4U, std::thread::hardware_concurrency());
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < Nthreads; ++i){
+        threads.emplace_back([&](){
+            char msg[errmsg_length] = "";
+            double val = -1;
+            for (auto k = 0; k < 2000; ++k){
+                long long int uuid;
+                if (build_model(j.c_str(), &uuid, msg, errmsg_length) != 0){ failures++; continue; }
+                if (get_Arxy(uuid, 0, 1, 300.0, 3.0e-6, &(molefrac[0]), 1, &val, msg, errmsg_length) != 0 || val != expected){ failures++; }
+                if (get_Arxy(uuidshared, 0, 1, 300.0, 3.0e-6, &(molefrac[0]), 1, &val, msg, errmsg_length) != 0 || val != expected){ failures++; }
+                if (free_model(uuid, msg, errmsg_length) != 0){ failures++; }
+                // A freed handle is never valid again, even once its slot has been reused
+                if (get_Arxy(uuid, 0, 1, 300.0, 3.0e-6, &(molefrac[0]), 1, &val, msg, errmsg_length) != 40){ failures++; }
+            }
+        });
+    }
+    for (auto& t : threads){ t.join(); }
+    CHECK(failures == 0);
+    
+    CHECK(free_model(uuidshared, errmsg, errmsg_length) == 0);
+    CHECK(free_model(uuidshared, errmsg, errmsg_length) == 40);
+    CHECK(get_Arxy(uuidshared, 0, 1, 300.0, 3.0e-6, &(molefrac[0]), 1, &expected, errmsg, errmsg_length) == 40);
+}
+
+TEST_CASE("Batched C interface","[teqpc]") {
+    constexpr int errmsg_length = 300;
+    char errmsg[errmsg_length] = "";
+    nlohmann::json jcoeffs = nlohmann::json::array();
+    jcoeffs.push_back({ {"name", "Methane"}, { "m", 1.0 }, { "sigma_Angstrom", 3.7039},{"epsilon_over_k", 150.03}, {"BibTeXKey", "Gross-IECR-2001"} });
+    jcoeffs.push_back({ {"name", "Ethane"}, { "m", 1.6069 }, { "sigma_Angstrom", 3.5206},{"epsilon_over_k", 191.42}, {"BibTeXKey", "Gross-IECR-2001"} });
+    std::string js = nlohmann::json{{"kind", "PCSAFT"}, {"model", {{"coeffs", jcoeffs}}}}.dump();
+    long long int uuid;
+    REQUIRE(build_model(js.c_str(), &uuid, errmsg, errmsg_length) == 0);
+    const void* model = nullptr;
+    REQUIRE(resolve_model(uuid, &model, errmsg, errmsg_length) == 0);
+    
+    // Fortran-ordered (N x 2) compositions and molar concentrations, and every other element of T, rho and the outputs
+    constexpr int N = 20, Ncomp = 2;
+    std::vector<double> T(2*N), rho(2*N), z(N*Ncomp), rhovecs(N*Ncomp), Ar(2*N), lnphi(2*N*Ncomp);
+    for (auto k = 0; k < N; ++k){
+        T[2*k] = 200.0 + 10*k; rho[2*k] = 100.0 + 50*k;
+        z[k] = 0.1 + 0.04*k; z[k + N] = 1-z[k];
+        rhovecs[k] = rho[2*k]*z[k]; rhovecs[k + N] = rho[2*k]*z[k + N];
+    }
+    REQUIRE(get_Arxy_batch(model, 0, 1, N, &(T[0]), 2, &(rho[0]), 2, &(z[0]), Ncomp, 1, N, &(Ar[0]), 2, errmsg, errmsg_length) == 0);
+    REQUIRE(get_fugacity_coefficients_batch(model, N, &(T[0]), 2, &(rhovecs[0]), Ncomp, 1, N, &(lnphi[0]), 2*Ncomp, 1, errmsg, errmsg_length) == 0);
+    
+    const auto& m = *static_cast<const teqp::cppinterface::AbstractModel*>(model);
+    for (auto k = 0; k < N; ++k){
+        double z_[Ncomp] = {z[k], z[k + N]}, val = -1;
+        REQUIRE(get_Arxy(uuid, 0, 1, T[2*k], rho[2*k], z_, Ncomp, &val, errmsg, errmsg_length) == 0);
+        CHECK(Ar[2*k] == val);
+        REQUIRE(get_Arxy_p(model, 0, 1, T[2*k], rho[2*k], z_, Ncomp, &val, errmsg, errmsg_length) == 0);
+        CHECK(Ar[2*k] == val);
+        Eigen::ArrayXd rhovec(2); rhovec << rhovecs[k], rhovecs[k + N];
+        Eigen::ArrayXd expected = m.get_fugacity_coefficients(T[2*k], rhovec);
+        CHECK(lnphi[2*Ncomp*k] == expected[0]);
+        CHECK(lnphi[2*Ncomp*k + 1] == expected[1]);
+    }
+    
+    CHECK(get_Arxy_batch(nullptr, 0, 1, N, &(T[0]), 2, &(rho[0]), 2, &(z[0]), Ncomp, 1, N, &(Ar[0]), 2, errmsg, errmsg_length) == 41);
+    CHECK(get_Arxy_batch(model, 0, 1, -1, &(T[0]), 2, &(rho[0]), 2, &(z[0]), Ncomp, 1, N, &(Ar[0]), 2, errmsg, errmsg_length) == 42);
+    CHECK(free_model(uuid, errmsg, errmsg_length) == 0);
+    CHECK(resolve_model(uuid, &model, errmsg, errmsg_length) == 40);
+}
+
+TEST_CASE("Flash through the C interface","[teqpc][flash]") {
+    constexpr int errmsg_length = 300;
+    char errmsg[errmsg_length] = "";
+    // Methane + propane with Peng-Robinson
+    std::string js = nlohmann::json{{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 369.89}}, {"pcrit / Pa", {4599200.0, 4251200.0}}, {"acentric", {0.011, 0.1521}}}}}.dump();
+    long long int uuid;
+    REQUIRE(build_model(js.c_str(), &uuid, errmsg, errmsg_length) == 0);
+    const void* model = nullptr;
+    REQUIRE(resolve_model(uuid, &model, errmsg, errmsg_length) == 0);
+    
+    constexpr int Ncomp = 2;
+    double z[Ncomp] = {0.5, 0.5}, x[Ncomp], y[Ncomp], T, p, beta, rhoL, rhoV;
+    int Nphases = -1;
+    REQUIRE(flash_calc(model, nullptr, "PT", 2e6, 250.0, z, Ncomp, 0, &T, &p, &beta, &rhoL, &rhoV, x, y, &Nphases, errmsg, errmsg_length) == 0);
+    CHECK(Nphases == 2);
+    CHECK(beta > 0); CHECK(beta < 1);
+    CHECK(y[0] > z[0]); CHECK(x[0] < z[0]);
+    
+    // Starting from the previous solution at a nearby state
+    const double betaold = beta;
+    REQUIRE(flash_calc(model, nullptr, "PT", 2e6, 251.0, z, Ncomp, 1, &T, &p, &beta, &rhoL, &rhoV, x, y, &Nphases, errmsg, errmsg_length) == 0);
+    CHECK(Nphases == 2);
+    CHECK(beta > betaold);
+    
+    CHECK(flash_calc(model, nullptr, "XY", 2e6, 251.0, z, Ncomp, 0, &T, &p, &beta, &rhoL, &rhoV, x, y, &Nphases, errmsg, errmsg_length) == 42);
+    CHECK(free_model(uuid, errmsg, errmsg_length) == 0);
+}
+
+TEST_CASE("Exported specifications through the C interface","[teqpc][export_spec]") {
+    constexpr int errmsg_length = 300;
+    char errmsg[errmsg_length] = "";
+    std::string js = nlohmann::json{{"kind", "multifluid"}, {"model", {{"components", {"Ethane", "Nitrogen"}}, {"root", "../mycp"}, {"BIP", ""}, {"departure", ""}}}}.dump();
+    std::string path = (std::filesystem::temp_directory_path() / "teqp_exported_spec_test.bin").string();
+    long long int uuid, uuidloaded;
+    REQUIRE(build_model(js.c_str(), &uuid, errmsg, errmsg_length) == 0);
+    REQUIRE(export_spec(uuid, path.c_str(), errmsg, errmsg_length) == 0);
+    REQUIRE(build_model_from_exported_spec(path.c_str(), &uuidloaded, errmsg, errmsg_length) == 0);
+    
+    double z[2] = {0.3, 0.7}, val = -1, valloaded = -2;
+    REQUIRE(get_Arxy(uuid, 1, 2, 250.0, 3000.0, z, 2, &val, errmsg, errmsg_length) == 0);
+    REQUIRE(get_Arxy(uuidloaded, 1, 2, 250.0, 3000.0, z, 2, &valloaded, errmsg, errmsg_length) == 0);
+    CHECK(val == valloaded);
+    CHECK(build_model_from_exported_spec("not a file", &uuidloaded, errmsg, errmsg_length) == 30);
+    
+    CHECK(free_model(uuid, errmsg, errmsg_length) == 0);
+    CHECK(free_model(uuidloaded, errmsg, errmsg_length) == 0);
+    std::filesystem::remove(path);
+}
 #else 
 int main() {
 }
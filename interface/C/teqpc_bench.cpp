@@ -1,5 +1,8 @@
 #include <valarray>
 #include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <iostream>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
@@ -8,6 +11,10 @@
 extern "C" int build_model(const char* j, long long int* uuid, char* errmsg, int errmsg_length);
 extern "C" int free_model(const long long int uid, char* errmsg, int errmsg_length);
 extern "C" int get_Arxy(const long long int uid, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length);
+extern "C" int resolve_model(const long long int uuid, const void** model, char* errmsg, int errmsg_length);
+extern "C" int get_Arxy_p(const void* model, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length);
+extern "C" int get_Arxy_batch(const void* model, const int NT, const int ND, const int N, const double* T, const int T_stride, const double* rho, const int rho_stride, const double* molefracs, const int Ncomp, const int molefrac_point_stride, const int molefrac_comp_stride, double* out, const int out_stride, char* errmsg, int errmsg_length);
+extern "C" int get_fugacity_coefficients_batch(const void* model, const int N, const double* T, const int T_stride, const double* rhovecs, const int Ncomp, const int rhovec_point_stride, const int rhovec_comp_stride, double* out, const int out_point_stride, const int out_comp_stride, char* errmsg, int errmsg_length);
 
 TEST_CASE("teqpc profiling", "[teqpc]")
 {
@@ -51,9 +58,80 @@ TEST_CASE("teqpc profiling", "[teqpc]")
         int errcode = build_model(model, &uid, errstr, 200);
         return uid;
     };
+    
+    // Model construction throughput, with and without validation of the parameters against the schema
+    const std::string model_validated = model;
+    const std::string model_unvalidated = "{\"validate\": false, " + model_validated.substr(model_validated.find('{') + 1);
+    std::vector<long long int> uids(100);
+    auto build_many = [&](const std::string& j){
+        for (auto& u : uids){
+            build_model(j.c_str(), &u, errstr, 200);
+        }
+        for (auto u : uids){
+            free_model(u, errstr, 200);
+        }
+        return uids.back();
+    };
+    BENCHMARK("build and free 100 models, validated"){ return build_many(model_validated); };
+    BENCHMARK("build and free 100 models, not validated"){ return build_many(model_unvalidated); };
     BENCHMARK("call model") {
         double out = -1;
         int errcode2 = get_Arxy(uid, NT, ND, T, rho, &(z[0]), static_cast<int>(z.size()), &out, errstr, 200);
         return out;
     };
+    
+    const void* ptr = nullptr;
+    REQUIRE(resolve_model(uid, &ptr, errstr, 200) == 0);
+    BENCHMARK("call resolved model") {
+        double out = -1;
+        int errcode2 = get_Arxy_p(ptr, NT, ND, T, rho, &(z[0]), static_cast<int>(z.size()), &out, errstr, 200);
+        return out;
+    };
+    
+    // Scalar versus batched calls for the same set of points, C-ordered compositions
+    const int N = 1000, Ncomp = static_cast<int>(z.size());
+    std::vector<double> Ts(N), rhos(N), zs(N*Ncomp), rhovecs(N*Ncomp), outs(N), lnphis(N*Ncomp);
+    for (auto k = 0; k < N; ++k){
+        Ts[k] = T + 0.1*k; rhos[k] = rho + 0.01*k;
+        for (auto i = 0; i < Ncomp; ++i){
+            zs[k*Ncomp + i] = z[i]; rhovecs[k*Ncomp + i] = rhos[k]*z[i];
+        }
+    }
+    auto scalar = [&](){
+        for (auto k = 0; k < N; ++k){
+            get_Arxy(uid, NT, ND, Ts[k], rhos[k], &(zs[k*Ncomp]), Ncomp, &(outs[k]), errstr, 200);
+        }
+        return outs[N-1];
+    };
+    auto scalar_resolved = [&](){
+        for (auto k = 0; k < N; ++k){
+            get_Arxy_p(ptr, NT, ND, Ts[k], rhos[k], &(zs[k*Ncomp]), Ncomp, &(outs[k]), errstr, 200);
+        }
+        return outs[N-1];
+    };
+    auto batch = [&](){
+        get_Arxy_batch(ptr, NT, ND, N, &(Ts[0]), 1, &(rhos[0]), 1, &(zs[0]), Ncomp, Ncomp, 1, &(outs[0]), 1, errstr, 200);
+        return outs[N-1];
+    };
+    auto batch_fugacity = [&](){
+        get_fugacity_coefficients_batch(ptr, N, &(Ts[0]), 1, &(rhovecs[0]), Ncomp, Ncomp, 1, &(lnphis[0]), Ncomp, 1, errstr, 200);
+        return lnphis[0];
+    };
+    BENCHMARK("1000 points, scalar get_Arxy"){ return scalar(); };
+    BENCHMARK("1000 points, scalar get_Arxy_p"){ return scalar_resolved(); };
+    BENCHMARK("1000 points, get_Arxy_batch"){ return batch(); };
+    BENCHMARK("1000 points, get_fugacity_coefficients_batch"){ return batch_fugacity(); };
+    
+    // Report the cost per point
+    auto per_point_ns = [&](auto f){
+        const int Nrepeat = 200;
+        auto tic = std::chrono::high_resolution_clock::now();
+        for (auto r = 0; r < Nrepeat; ++r){ f(); }
+        auto toc = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(toc-tic).count()/(Nrepeat*N);
+    };
+    std::cout << "per point, scalar get_Arxy: " << per_point_ns(scalar) << " ns" << std::endl;
+    std::cout << "per point, scalar get_Arxy_p: " << per_point_ns(scalar_resolved) << " ns" << std::endl;
+    std::cout << "per point, get_Arxy_batch: " << per_point_ns(batch) << " ns" << std::endl;
+    std::cout << "per point, get_fugacity_coefficients_batch: " << per_point_ns(batch_fugacity) << " ns" << std::endl;
 }
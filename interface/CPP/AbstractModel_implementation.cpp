@@ -3,6 +3,8 @@
 #include "teqp/algorithms/VLE_pure.hpp"
 #include "teqp/algorithms/VLE.hpp"
 #include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/flash.hpp"
+#include "teqp/algorithms/rho_Tp.hpp"
 
 namespace teqp{
     namespace cppinterface{
@@ -72,6 +74,25 @@ namespace teqp{
         return teqp::trace_VLE_isobar_binary(*this, p, T0, rhovecL0, rhovecV0, options);
     }
     
+    teqp::flash::FlashResult AbstractModel::flash(const teqp::flash::FlashSpecification spec, const double val1, const double val2, const REArrayd& z, const AbstractModel* aig, const std::optional<teqp::flash::FlashOptions>& options, const std::optional<teqp::flash::FlashResult>& guess) const {
+        return teqp::flash::flash(*this, aig, spec, val1, val2, z, options.value_or(teqp::flash::FlashOptions{}), guess);
+    }
+    
+    double AbstractModel::solve_rho_Tp(const double T, const double p, const REArrayd& z, const PhaseHint hint) const {
+        return teqp::solve_rho_Tp(*this, T, p, z, hint);
+    }
+    void AbstractModel::solve_rho_Tp_many(const REArrayd& T, const REArrayd& p, const REMatrixd& molefracs, const PhaseHint hint, WEArrayd out) const {
+        const auto N = T.size();
+        if (p.size() != N || molefracs.rows() != N || out.size() != N){
+            throw teqp::InvalidArgument("Lengths of batch inputs and outputs must all be equal to the length of T: " + std::to_string(N));
+        }
+        EArrayd z(molefracs.cols()); // Reused for each state point
+        for (auto k = 0; k < N; ++k){
+            z = molefracs.row(k).transpose();
+            out[k] = solve_rho_Tp(T[k], p[k], z, hint);
+        }
+    }
+    
     nlohmann::json AbstractModel::trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& filename, const std::optional<TCABOptions> &options) const {
         using crit = teqp::CriticalTracing<decltype(*this), double, std::decay_t<decltype(rhovec0)>>;
         return crit::trace_critical_arclength_binary(*this, T0, rhovec0, filename , options);
@@ -1,3 +1,7 @@
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/models/fwd.hpp"
 #include "teqp/cpp/deriv_adapter.hpp"
@@ -49,6 +53,49 @@ namespace teqp {
             {"SAFT-VR-Mie", [](const nlohmann::json& spec){ return make_SAFTVRMie(spec); }}
         };
 
+        /**
+         The compiled validators for the schemas in the library, shared by all the threads in the process.
+         
+         The map has one entry per kind and is never modified after it is constructed, so lookups do not need a lock. Each validator
+         is compiled the first time its kind is used; std::call_once makes the concurrent first uses of a kind wait for a single
+         compilation. Thereafter validation only reads from the compiled schema.
+         */
+        class ValidatorCache{
+        private:
+            struct Entry{
+                std::once_flag flag;
+                std::unique_ptr<const JSONValidator> validator;
+            };
+            std::unordered_map<std::string, Entry> entries;
+        public:
+            ValidatorCache(){
+                for (auto& [kind, schema] : model_schema_library.items()){
+                    entries[kind];
+                }
+            }
+            /// Get the validator for this kind of model, or nullptr if there is no schema for it
+            const JSONValidator* get(const std::string& kind){
+                auto itr = entries.find(kind);
+                if (itr == entries.end()){
+                    return nullptr;
+                }
+                auto& entry = itr->second;
+                std::call_once(entry.flag, [&](){ entry.validator = std::make_unique<const JSONValidator>(model_schema_library.at(kind)); });
+                return entry.validator.get();
+            }
+        };
+        
+        static ValidatorCache& get_validator_cache(){
+            static ValidatorCache cache; // Construction of a function-local static is thread-safe
+            return cache;
+        }
+    
+        /// Functions that pull the data in files referenced by the specification of a model into the specification itself, so that the model can be rebuilt without them; only called when the specification is exported
+        static std::unordered_map<std::string, std::function<nlohmann::json(const nlohmann::json&)>> spec_resolvers = {
+            {"multifluid", [](const nlohmann::json& spec){ return resolve_multifluid_spec(spec); }},
+            {"multifluid-ECS-HuberEly1994", [](const nlohmann::json& spec){ return ECSHuberEly::resolve_ECSHuberEly1994_spec(spec); }}
+        };
+    
         std::unique_ptr<teqp::cppinterface::AbstractModel> build_model_ptr(const nlohmann::json& json, const bool validate) {
             
             // Extract the name of the model and the model parameters
@@ -61,15 +108,16 @@ namespace teqp {
             auto itr = pointer_factory.find(kind);
             if (itr != pointer_factory.end()){
                 if (validate || validate_in_json){
-                    if (model_schema_library.contains(kind)){
-                        // This block is not thread-safe, needs a mutex or something
-                        JSONValidator validator(model_schema_library.at(kind));
-                        if (!validator.is_valid(spec)){
-                            throw teqp::JSONValidationError(validator.get_validation_errors(spec));
+                    if (auto validator = get_validator_cache().get(kind)){
+                        auto errors = validator->get_validation_errors(spec);
+                        if (!errors.empty()){
+                            throw teqp::JSONValidationError(errors);
                         }
                     }
                 }
-                return (itr->second)(spec);
+                auto model = (itr->second)(spec);
+                model->set_spec({{"kind", std::move(kind)}, {"model", std::move(spec)}});
+                return model;
             }
             else{
                 throw std::invalid_argument("Don't understand \"kind\" of: " + kind);
@@ -77,13 +125,61 @@ namespace teqp {
         }
     
         std::unique_ptr<AbstractModel> make_multifluid_model(const std::vector<std::string>& components, const std::string& coolprop_root, const std::string& BIPcollectionpath, const nlohmann::json& flags, const std::string& departurepath) {
-            return make_owned(build_multifluid_model(components, coolprop_root, BIPcollectionpath, flags, departurepath));
+            nlohmann::json spec = {{"components", components}, {"root", coolprop_root}, {"BIP", BIPcollectionpath}, {"departure", departurepath}, {"flags", flags}};
+            return build_model_ptr({{"kind", "multifluid"}, {"model", spec}});
         }
     
         std::unique_ptr<AbstractModel> make_model(const nlohmann::json& j, const bool validate) {
             return build_model_ptr(j, validate);
         }
     
+        /*
+         An exported specification is the eight bytes of exported_spec_magic followed by the specification of the model in CBOR (a binary
+         encoding of JSON). The data in the files the specification refers to are pulled into it when it is exported, so the model can be
+         rebuilt from it without those files.
+         */
+        static const std::string exported_spec_magic = "teqpspec";
+        static const int exported_spec_version = 1;
+    
+        void AbstractModel::export_spec(const std::string& path) const {
+            if (spec.is_null()){
+                throw teqp::InvalidArgument("Only the specifications of models built with make_model can be exported");
+            }
+            nlohmann::json j = spec;
+            auto resolver = spec_resolvers.find(j.at("kind").get<std::string>());
+            if (resolver != spec_resolvers.end()){
+                j["model"] = (resolver->second)(j.at("model"));
+            }
+            j["exported_spec_version"] = exported_spec_version;
+            auto payload = nlohmann::json::to_cbor(j);
+            std::ofstream ofs(path, std::ios::binary);
+            ofs.write(exported_spec_magic.data(), exported_spec_magic.size());
+            ofs.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+            if (!ofs){
+                throw teqp::InvalidArgument("Unable to write the specification to: " + path);
+            }
+        }
+    
+        std::unique_ptr<AbstractModel> make_model_from_exported_spec(const std::string& path) {
+            std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+            if (!ifs){
+                throw teqp::InvalidArgument("Unable to open the exported specification: " + path);
+            }
+            std::vector<std::uint8_t> buffer(static_cast<std::size_t>(ifs.tellg()));
+            ifs.seekg(0);
+            ifs.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+            if (buffer.size() < exported_spec_magic.size() || !std::equal(exported_spec_magic.begin(), exported_spec_magic.end(), buffer.begin())){
+                throw teqp::InvalidArgument("The file is not a specification exported by teqp: " + path);
+            }
+            auto j = nlohmann::json::from_cbor(buffer.begin() + exported_spec_magic.size(), buffer.end());
+            if (j.value("exported_spec_version", -1) != exported_spec_version){
+                throw teqp::InvalidArgument("The version of the exported specification in " + path + " is not supported");
+            }
+            j.erase("exported_spec_version");
+            j["validate"] = false; // The specification was validated when the model was first built
+            return build_model_ptr(j, false);
+        }
+    
         void add_model_pointer_factory_function(const std::string& key, ModelPointerFactoryFunction& func){
             if (pointer_factory.find(key) == pointer_factory.end()){
                 pointer_factory[key] = func;
@@ -7,6 +7,7 @@ using namespace teqp::cppinterface;
 
 #include "teqp/derivs.hpp"
 #include "teqp/models/multifluid.hpp"
+#include "teqp/algorithms/rho_Tp.hpp"
 
 using namespace teqp;
 
@@ -45,3 +46,97 @@ TEST_CASE("Benchmark C++ interface", "[C++]")
         return TDXDerivatives<decltype(model1novar)>::get_Arxy<0,1,ADBackends::autodiff>(model1novar, 300, 3, z1);
     }; 
 }
+
+TEST_CASE("Benchmark batched C++ interface", "[C++]")
+{
+    auto model = teqp::cppinterface::make_multifluid_model({ "Methane", "Ethane"}, "../mycp");
+    
+    const Eigen::Index N = 1000;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 250, 350);
+    Eigen::ArrayXd rho = Eigen::ArrayXd::LinSpaced(N, 1, 10);
+    Eigen::ArrayXXd Z(N, 2); Z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.1, 0.9); Z.col(1) = 1.0 - Z.col(0);
+    Eigen::ArrayXXd rhovecs = Z.colwise()*rho;
+    
+    Eigen::ArrayXd out(N);
+    Eigen::ArrayXXd out0n(N, 3), outphi(N, 2);
+    
+    SECTION("batched matches per-point"){
+        model->get_Arxy_many(1, 1, T, rho, Z, out);
+        for (auto k = 0; k < N; k += 100){
+            Eigen::ArrayXd z = Z.row(k).transpose();
+            CHECK(out[k] == model->get_Arxy(1, 1, T[k], rho[k], z));
+        }
+    }
+    
+    BENCHMARK("Ar01 per-point, 1000 points") {
+        Eigen::ArrayXd z(2);
+        for (auto k = 0; k < N; ++k){
+            z = Z.row(k).transpose();
+            out[k] = model->get_Ar01(T[k], rho[k], z);
+        }
+        return out[N-1];
+    };
+    BENCHMARK("Ar01 batched, 1000 points") {
+        model->get_Arxy_many(0, 1, T, rho, Z, out);
+        return out[N-1];
+    };
+    BENCHMARK("Ar02n per-point, 1000 points") {
+        Eigen::ArrayXd z(2);
+        for (auto k = 0; k < N; ++k){
+            z = Z.row(k).transpose();
+            out0n.row(k) = model->get_Ar02n(T[k], rho[k], z).transpose();
+        }
+        return out0n(N-1, 2);
+    };
+    BENCHMARK("Ar02n batched, 1000 points") {
+        model->get_Ar0n_many(2, T, rho, Z, out0n);
+        return out0n(N-1, 2);
+    };
+    BENCHMARK("fugacity coefficients per-point, 1000 points") {
+        Eigen::ArrayXd rhovec(2);
+        for (auto k = 0; k < N; ++k){
+            rhovec = rhovecs.row(k).transpose();
+            outphi.row(k) = model->get_fugacity_coefficients(T[k], rhovec).transpose();
+        }
+        return outphi(N-1, 0);
+    };
+    BENCHMARK("fugacity coefficients batched, 1000 points") {
+        model->get_fugacity_coefficients_many(T, rhovecs, outphi);
+        return outphi(N-1, 0);
+    };
+}
+
+TEST_CASE("Benchmark density solver", "[C++][rho_Tp]")
+{
+    // 1000 roots per batch, so the time per batch in microseconds is the time per root in nanoseconds
+    const Eigen::Index N = 1000;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 200, 350);
+    Eigen::ArrayXd p = Eigen::ArrayXd::LinSpaced(N, 1e5, 1e7);
+    Eigen::ArrayXXd Z(N, 2); Z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.1, 0.9); Z.col(1) = 1.0 - Z.col(0);
+    Eigen::ArrayXd out(N);
+    
+    auto PR = teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 305.32}}, {"pcrit / Pa", {4599200.0, 4872200.0}}, {"acentric", {0.011, 0.099}}}}});
+    auto PCSAFT = teqp::cppinterface::make_model(nlohmann::json::parse(R"({"kind": "PCSAFT", "model": {"names": ["Methane","Ethane"]}})"));
+    auto multifluid = teqp::cppinterface::make_multifluid_model({ "Methane", "Ethane"}, "../mycp");
+    
+    BENCHMARK("PR closed-form, 1000 roots") {
+        PR->solve_rho_Tp_many(T, p, Z, PhaseHint::stable, out);
+        return out[N-1];
+    };
+    BENCHMARK("PR iterative, 1000 roots") {
+        Eigen::ArrayXd z(2);
+        for (auto k = 0; k < N; ++k){
+            z = Z.row(k).transpose();
+            out[k] = teqp::solve_rho_Tp(*PR, T[k], p[k], z, PhaseHint::stable);
+        }
+        return out[N-1];
+    };
+    BENCHMARK("PC-SAFT, 1000 roots") {
+        PCSAFT->solve_rho_Tp_many(T, p, Z, PhaseHint::stable, out);
+        return out[N-1];
+    };
+    BENCHMARK("multifluid, 1000 roots") {
+        multifluid->solve_rho_Tp_many(T, p, Z, PhaseHint::stable, out);
+        return out[N-1];
+    };
+}
@@ -15,6 +15,7 @@
 #include "teqp/cpp/deriv_adapter.hpp"
 #include "teqp/models/fwd.hpp"
 #include "teqp/algorithms/ancillary_builder.hpp"
+#include "teqp/algorithms/VLE_cache.hpp"
 
 namespace py = pybind11;
 using namespace py::literals;
@@ -40,10 +41,32 @@ void add_multifluid(py::module& m){
         .def_readonly("pL", &MultiFluidVLEAncillaries::pL)
         .def_readonly("pV", &MultiFluidVLEAncillaries::pV)
         ;
+    
+    // The superancillary curves, in the form of piecewise Chebyshev expansions
+    py::class_<SuperAncillaryCurve>(m, "SuperAncillaryCurve")
+        .def(py::init<const nlohmann::json&>())
+        .def("__call__", &SuperAncillaryCurve::operator())
+        .def("solve_for_T", &SuperAncillaryCurve::solve_for_T, "value"_a)
+        .def("to_json", &SuperAncillaryCurve::to_json)
+        .def_readonly("Tcrit", &SuperAncillaryCurve::Tcrit)
+        .def_readonly("Tmin", &SuperAncillaryCurve::Tmin)
+        ;
+    py::class_<SuperAncillaryVLE>(m, "SuperAncillaryVLE")
+        .def(py::init<const nlohmann::json&>())
+        .def("to_json", &SuperAncillaryVLE::to_json)
+        .def_readonly("Tcrit", &SuperAncillaryVLE::Tcrit)
+        .def_readonly("rhocrit", &SuperAncillaryVLE::rhocrit)
+        .def_readonly("pcrit", &SuperAncillaryVLE::pcrit)
+        .def_readonly("Tmin", &SuperAncillaryVLE::Tmin)
+        .def_readonly("rhoL", &SuperAncillaryVLE::rhoL)
+        .def_readonly("rhoV", &SuperAncillaryVLE::rhoV)
+        .def_readonly("p", &SuperAncillaryVLE::p)
+        ;
 
     // Expose some additional functions for working with the JSON data structures and resolving aliases
     m.def("get_BIPdep", &reducing::get_BIPdep, py::arg("BIPcollection"), py::arg("identifiers"), py::arg("flags") = nlohmann::json{});
     m.def("build_alias_map", &build_alias_map, py::arg("root"));
+    m.def("write_fluid_library_index", [](const std::string& root){ FluidLibrary::get(root).write_index(); }, py::arg("root"));
     m.def("collect_component_json", &collect_component_json, py::arg("identifiers"), py::arg("root"));
     m.def("get_departure_json", &get_departure_json, py::arg("name"), py::arg("root"));
 }
@@ -384,6 +407,51 @@ void init_teqp(py::module& m) {
         .def_readwrite("maxiter", &MixVLEpxFlags::maxiter)
         ;
     
+    py::enum_<flash::FlashSpecification>(m, "FlashSpecification")
+        .value("PT", flash::FlashSpecification::PT)
+        .value("PH", flash::FlashSpecification::PH)
+        .value("PS", flash::FlashSpecification::PS)
+        .value("TS", flash::FlashSpecification::TS)
+        .value("UV", flash::FlashSpecification::UV)
+        ;
+    
+    py::enum_<PhaseHint>(m, "PhaseHint")
+        .value("liquid", PhaseHint::liquid)
+        .value("vapor", PhaseHint::vapor)
+        .value("stable", PhaseHint::stable)
+        ;
+
+    py::class_<flash::FlashOptions>(m, "FlashOptions")
+        .def(py::init<>())
+        .def_readwrite("SS_tol", &flash::FlashOptions::SS_tol)
+        .def_readwrite("Newton_tol", &flash::FlashOptions::Newton_tol)
+        .def_readwrite("stability_tol", &flash::FlashOptions::stability_tol)
+        .def_readwrite("outer_tol", &flash::FlashOptions::outer_tol)
+        .def_readwrite("T0", &flash::FlashOptions::T0)
+        .def_readwrite("p0", &flash::FlashOptions::p0)
+        .def_readwrite("maxiter_SS", &flash::FlashOptions::maxiter_SS)
+        .def_readwrite("maxiter_Newton", &flash::FlashOptions::maxiter_Newton)
+        .def_readwrite("maxiter_stability", &flash::FlashOptions::maxiter_stability)
+        .def_readwrite("maxiter_outer", &flash::FlashOptions::maxiter_outer)
+        ;
+
+    py::class_<flash::FlashResult>(m, "FlashResult")
+        .def(py::init<>())
+        .def_readonly("success", &flash::FlashResult::success)
+        .def_readonly("message", &flash::FlashResult::message)
+        .def_readonly("Nphases", &flash::FlashResult::Nphases)
+        .def_readonly("T", &flash::FlashResult::T)
+        .def_readonly("p", &flash::FlashResult::p)
+        .def_readonly("beta", &flash::FlashResult::beta)
+        .def_readonly("rhoL", &flash::FlashResult::rhoL)
+        .def_readonly("rhoV", &flash::FlashResult::rhoV)
+        .def_readonly("x", &flash::FlashResult::x)
+        .def_readonly("y", &flash::FlashResult::y)
+        .def_readonly("num_SS", &flash::FlashResult::num_SS)
+        .def_readonly("num_Newton", &flash::FlashResult::num_Newton)
+        .def_readonly("num_outer", &flash::FlashResult::num_outer)
+        ;
+    
     using namespace teqp::cppinterface;
     // The Jacobian and value matrices for Newton-Raphson
     py::class_<IterationMatrices>(m, "IterationMatrices")
@@ -415,7 +483,40 @@ void init_teqp(py::module& m) {
         .def_readonly("r", &MixVLEReturn::r)
         .def_readonly("initial_r", &MixVLEReturn::initial_r)
         ;
-    
+
+    py::class_<VLECacheOptions>(m, "VLECacheOptions")
+        .def(py::init<>())
+        .def_readwrite("capacity", &VLECacheOptions::capacity)
+        .def_readwrite("max_dT", &VLECacheOptions::max_dT)
+        .def_readwrite("max_drelp", &VLECacheOptions::max_drelp)
+        .def_readwrite("max_dx", &VLECacheOptions::max_dx)
+        .def_readwrite("extrapolate", &VLECacheOptions::extrapolate)
+        ;
+
+    py::class_<VLECacheStats>(m, "VLECacheStats")
+        .def(py::init<>())
+        .def_readonly("num_calls", &VLECacheStats::num_calls)
+        .def_readonly("num_hits", &VLECacheStats::num_hits)
+        .def_readonly("num_extrapolated", &VLECacheStats::num_extrapolated)
+        .def_readonly("num_iter_hits", &VLECacheStats::num_iter_hits)
+        .def_readonly("num_iter_misses", &VLECacheStats::num_iter_misses)
+        .def_readonly("num_failures", &VLECacheStats::num_failures)
+        .def("hit_rate", &VLECacheStats::hit_rate)
+        .def("mean_iter_hits", &VLECacheStats::mean_iter_hits)
+        .def("mean_iter_misses", &VLECacheStats::mean_iter_misses)
+        ;
+
+    // The cache holds a reference to the model, so the model is kept alive as long as the cache is
+    py::class_<VLESolutionCache>(m, "VLESolutionCache")
+        .def(py::init<const AbstractModel&, const std::optional<VLECacheOptions>&>(), "model"_a, py::arg_v("options", std::nullopt, "None"), py::keep_alive<1, 2>())
+        .def("mix_VLE_Tp", &VLESolutionCache::mix_VLE_Tp, "T"_a, "p_given"_a, py::arg_v("rhovecL0", std::nullopt, "None"), py::arg_v("rhovecV0", std::nullopt, "None"), py::arg_v("options", std::nullopt, "None"))
+        .def("mixture_VLE_px", &VLESolutionCache::mixture_VLE_px, "p_spec"_a, "xmolar_spec"_a, py::arg_v("T0", std::nullopt, "None"), py::arg_v("rhovecL0", std::nullopt, "None"), py::arg_v("rhovecV0", std::nullopt, "None"), py::arg_v("options", std::nullopt, "None"))
+        .def("get_stats", &VLESolutionCache::get_stats)
+        .def("reset_stats", &VLESolutionCache::reset_stats)
+        .def("size", &VLESolutionCache::size)
+        .def("clear", &VLESolutionCache::clear)
+        ;
+
     using namespace teqp::PCSAFT;
     py::class_<SAFTCoeffs>(m, "SAFTCoeffs")
     .def(py::init<>())
@@ -445,6 +546,9 @@ void init_teqp(py::module& m) {
         .def("get_dmBnvirdTm", &am::get_dmBnvirdTm, "Nderiv"_a, "NTderiv"_a, "T"_a, "molefrac"_a.noconvert())
         .def("get_B12vir", &am::get_B12vir, "T"_a, "molefrac"_a.noconvert())
     
+        .def("get_spec", &am::get_spec)
+        .def("export_spec", &am::export_spec, "path"_a)
+    
         .def("get_Arxy", &am::get_Arxy, "NT"_a, "ND"_a, "T"_a, "rho"_a, "molefrac"_a.noconvert())
         // Here X-Macros are used to create functions like get_Ar00, get_Ar01, ....
         #define X(i,j) .def(stringify(get_Ar ## i ## j), &am::get_Ar ## i ## j, "T"_a, "rho"_a, "molefrac"_a.noconvert())
@@ -456,6 +560,17 @@ void init_teqp(py::module& m) {
         #undef X
         .def("get_neff", &am::get_neff, "T"_a, "rho"_a, "molefrac"_a.noconvert())
     
+        // Batched derivatives, the output buffers are allocated here and returned
+        .def("get_Arxy_many", [](const am& self, const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs){
+            EArrayd out(T.size()); self.get_Arxy_many(NT, ND, T, rho, molefracs, out); return out;
+        }, "NT"_a, "ND"_a, "T"_a.noconvert(), "rho"_a.noconvert(), "molefracs"_a)
+        .def("get_Ar0n_many", [](const am& self, const int Nderiv, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs){
+            EMatrixd out(T.size(), Nderiv+1); self.get_Ar0n_many(Nderiv, T, rho, molefracs, out); return out;
+        }, "Nderiv"_a, "T"_a.noconvert(), "rho"_a.noconvert(), "molefracs"_a)
+        .def("get_fugacity_coefficients_many", [](const am& self, const REArrayd& T, const REMatrixd& rhovecs){
+            EMatrixd out(rhovecs.rows(), rhovecs.cols()); self.get_fugacity_coefficients_many(T, rhovecs, out); return out;
+        }, "T"_a.noconvert(), "rhovecs"_a)
+    
         // Methods that come from the isochoric derivatives formalism
         .def("get_pr", &am::get_pr, "T"_a, "rhovec"_a.noconvert())
         .def("get_splus", &am::get_splus, "T"_a, "rhovec"_a.noconvert())
@@ -469,6 +584,7 @@ void init_teqp(py::module& m) {
         .def("get_partial_molar_volumes", &am::get_partial_molar_volumes, "T"_a, "rhovec"_a.noconvert())
     
         .def("get_deriv_mat2", &am::get_deriv_mat2, "T"_a, "rho"_a, "molefrac"_a.noconvert())
+        .def("get_Ar_block", &am::get_Ar_block, "Nmax"_a, "T"_a, "rho"_a, "molefrac"_a.noconvert())
     
         // Routines related to pure fluid critical point calculation
         .def("get_pure_critical_conditions_Jacobian", &am::get_pure_critical_conditions_Jacobian, "T"_a, "rho"_a, py::arg_v("alternative_pure_index", std::nullopt, "None"), py::arg_v("alternative_length", std::nullopt, "None"))
@@ -500,11 +616,19 @@ void init_teqp(py::module& m) {
         .def("find_VLLE_T_binary", &am::find_VLLE_T_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("find_VLLE_p_binary", &am::find_VLLE_p_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("trace_VLLE_binary", &am::trace_VLLE_binary, "T"_a, "rhovecV"_a.noconvert(), "rhovecL1"_a.noconvert(), "rhovecL2"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+    
+        .def("flash", &am::flash, "spec"_a, "val1"_a, "val2"_a, "z"_a.noconvert(), py::arg_v("aig", nullptr, "None"), py::arg_v("options", std::nullopt, "None"), py::arg_v("guess", std::nullopt, "None"))
+        .def("solve_rho_Tp", &am::solve_rho_Tp, "T"_a, "p"_a, "z"_a.noconvert(), py::arg_v("hint", PhaseHint::stable, "PhaseHint.stable"))
+        .def("solve_rho_Tp_many", [](const am& self, const REArrayd& T, const REArrayd& p, const REMatrixd& molefracs, const PhaseHint hint){
+            EArrayd out(T.size()); self.solve_rho_Tp_many(T, p, molefracs, hint, out); return out;
+        }, "T"_a.noconvert(), "p"_a.noconvert(), "molefracs"_a, py::arg_v("hint", PhaseHint::stable, "PhaseHint.stable"))
     ;
     
     m.def("_make_model", &teqp::cppinterface::make_model, "json_data"_a, py::arg_v("validate", true));
+    m.def("_make_model_from_exported_spec", &teqp::cppinterface::make_model_from_exported_spec, "path"_a);
     m.def("attach_model_specific_methods", &attach_model_specific_methods);
     m.def("build_ancillaries", &teqp::ancillaries::build_ancillaries, "model"_a, "Tc"_a, "rhoc"_a, "Tmin"_a, py::arg_v("flags", std::nullopt, "None"));
+    m.def("build_superancillaries", &teqp::ancillaries::build_superancillaries, "model"_a, "Tc"_a, "rhoc"_a, "Tmin"_a, py::arg_v("flags", std::nullopt, "None"));
     m.def("convert_FLD", [](const std::string& component, const std::string& name){ return RPinterop::FLDfile(component).make_json(name); },
           "component"_a, "name"_a);
     m.def("convert_HMXBNC", [](const std::string& path){ return RPinterop::HMXBNCfile(path).make_jsons(); }, "path"_a);
@@ -4,6 +4,7 @@
 #include "teqp/models/vdW.hpp"
 #include "teqp/models/pcsaft.hpp"
 #include "teqp/models/cubics.hpp"
+#include "teqp/models/saftvrmie.hpp"
 
 #include "teqp/derivs.hpp"
 
@@ -120,6 +121,167 @@ TEST_CASE("PCSAFT more derivatives", "[PCSAFT]")
 }
 
 
+TEST_CASE("PCSAFT 10-component derivatives", "[PCSAFT]")
+{
+    using namespace PCSAFT;
+    // n-alkanes from methane to n-decane, from Gross and Sadowski, IECR, 2001
+    std::vector<std::tuple<std::string, double, double, double>> params = {
+        {"Methane", 1.0000, 3.7039, 150.03}, {"Ethane", 1.6069, 3.5206, 191.42},
+        {"Propane", 2.0020, 3.6184, 208.11}, {"n-Butane", 2.3316, 3.7086, 222.88},
+        {"n-Pentane", 2.6896, 3.7729, 231.20}, {"n-Hexane", 3.0576, 3.7983, 236.77},
+        {"n-Heptane", 3.4831, 3.8049, 238.40}, {"n-Octane", 3.8176, 3.8373, 242.78},
+        {"n-Nonane", 4.2079, 3.8448, 244.51}, {"n-Decane", 4.6627, 3.8384, 243.87}
+    };
+    std::vector<SAFTCoeffs> coeffs;
+    for (auto& [name, m, sigma, eps] : params) {
+        SAFTCoeffs c;
+        c.name = name; c.m = m; c.sigma_Angstrom = sigma; c.epsilon_over_k = eps; c.BibTeXKey = "Gross-IECR-2001";
+        coeffs.push_back(c);
+    }
+    auto model = PCSAFTMixture(coeffs);
+
+    double T = 300, rho = 2;
+    Eigen::ArrayX<double> z(coeffs.size()); z.fill(1.0/z.size());
+    using tdx = TDXDerivatives<decltype(model), double, decltype(z)>;
+
+    BENCHMARK("alphar") {
+        return model.alphar(T, rho, z);
+    };
+    BENCHMARK("rho^2*d^2alphar/drho^2 w/ autodiff") {
+        return tdx::get_Ar02(model, T, rho, z);
+    };
+}
+
+TEST_CASE("PCSAFT 4-component association", "[PCSAFT],[association]")
+{
+    using namespace PCSAFT;
+    // Water and alcohols, all 2B, from Gross and Sadowski, IECR, 2002
+    std::vector<std::tuple<std::string, double, double, double, double, double>> params = {
+        {"Water", 1.0656, 3.0007, 366.51, 2500.7, 0.034868},
+        {"Methanol", 1.5255, 3.2300, 188.90, 2899.5, 0.035176},
+        {"Ethanol", 2.3827, 3.1771, 198.24, 2653.4, 0.032384},
+        {"1-Propanol", 2.9997, 3.2522, 233.40, 2276.8, 0.015268}
+    };
+    std::vector<SAFTCoeffs> coeffs, coeffs_noassoc;
+    for (auto& [name, m, sigma, eps, epsAB, kappaAB] : params) {
+        SAFTCoeffs c;
+        c.name = name; c.m = m; c.sigma_Angstrom = sigma; c.epsilon_over_k = eps; c.BibTeXKey = "Gross-IECR-2002";
+        coeffs_noassoc.push_back(c);
+        c.association_class = association::association_classes::a2B; c.epsilon_AB_over_k = epsAB; c.kappa_AB = kappaAB;
+        coeffs.push_back(c);
+    }
+    auto model = PCSAFTMixture(coeffs), model_noassoc = PCSAFTMixture(coeffs_noassoc);
+
+    double T = 350, rho = 20000;
+    auto z = (Eigen::ArrayXd(4) << 0.4, 0.3, 0.2, 0.1).finished();
+    using tdx = TDXDerivatives<decltype(model), double, decltype(z)>;
+
+    BENCHMARK("alphar, non-associating") {
+        return model_noassoc.alphar(T, rho, z);
+    };
+    BENCHMARK("alphar") {
+        return model.alphar(T, rho, z);
+    };
+    BENCHMARK("rho^2*d^2alphar/drho^2 w/ autodiff, non-associating") {
+        return tdx::get_Ar02(model_noassoc, T, rho, z);
+    };
+    BENCHMARK("rho^2*d^2alphar/drho^2 w/ autodiff") {
+        return tdx::get_Ar02(model, T, rho, z);
+    };
+}
+
+
+TEST_CASE("SAFT-VR-Mie Chebyshev expansions of d", "[SAFTVRMie]")
+{
+    using namespace SAFTVRMie;
+    std::vector<std::string> names = { "Methane", "Ethane" };
+    nlohmann::json flags = {{"dii_Chebyshev", {{"Tmin / K", 50.0}, {"Tmax / K", 1500.0}}}};
+    SAFTVRMieMixture model{names}, modelcheb{names, std::nullopt, flags};
+
+    double T = 300, rho = 5000;
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    using tdx = TDXDerivatives<decltype(model), double, decltype(z)>;
+
+    BENCHMARK("get_dmat w/ quadrature") {
+        return model.get_terms().get_dmat(T);
+    };
+    BENCHMARK("get_dmat w/ Chebyshev") {
+        return modelcheb.get_terms().get_dmat(T);
+    };
+    BENCHMARK("alphar w/ quadrature") {
+        return model.alphar(T, rho, z);
+    };
+    BENCHMARK("alphar w/ Chebyshev") {
+        return modelcheb.alphar(T, rho, z);
+    };
+    BENCHMARK("c_vr/R w/ autodiff, quadrature") {
+        return -tdx::get_Ar20(model, T, rho, z);
+    };
+    BENCHMARK("c_vr/R w/ autodiff, Chebyshev") {
+        return -tdx::get_Ar20(modelcheb, T, rho, z);
+    };
+}
+
+TEST_CASE("Gauss-Legendre quadrature", "[quadrature]")
+{
+    using ADType = autodiff::Real<2, double>;
+    ADType T = 300.0;
+    auto integrand = [&T](const ADType& r){ return forceeval(1.0 - exp(-(pow(1.0/r, 12) - pow(1.0/r, 6))*100.0/T)); };
+    std::function<ADType(ADType)> integrand_erased = integrand;
+    ADType a = 0.8, b = 1.0;
+
+    BENCHMARK("quad<10> w/ std::function") {
+        return quad<10, ADType, ADType>(integrand_erased, a, b);
+    };
+    BENCHMARK("quad<10> w/ lambda") {
+        return quad<10, ADType, ADType>(integrand, a, b);
+    };
+    BENCHMARK("quad<30> w/ std::function") {
+        return quad<30, ADType, ADType>(integrand_erased, a, b);
+    };
+    BENCHMARK("quad<30> w/ lambda") {
+        return quad<30, ADType, ADType>(integrand, a, b);
+    };
+    
+    using namespace SAFTVRMie;
+    std::vector<std::string> names = { "Ethane" };
+    SAFTVRMieMixture model{names};
+    BENCHMARK("SAFT-VR-Mie get_dii w/ autodiff") {
+        return model.get_terms().get_dii(0, T);
+    };
+}
+
+TEST_CASE("Cubic superancillaries", "[cubic][superanc]")
+{
+    using namespace CubicSuperAncillary;
+    double Ttilde = 0.1;
+    double ptilde = supercubic(PR_CODE, P_CODE, Ttilde), rhoLtilde = supercubic(PR_CODE, RHOL_CODE, Ttilde);
+    
+    BENCHMARK("ptilde(Ttilde)") {
+        return supercubic(PR_CODE, P_CODE, Ttilde);
+    };
+    BENCHMARK("Ttilde(ptilde)") {
+        return supercubic_Ttilde(PR_CODE, P_CODE, ptilde);
+    };
+    BENCHMARK("Ttilde(rhoLtilde)") {
+        return supercubic_Ttilde(PR_CODE, RHOL_CODE, rhoLtilde);
+    };
+    
+    // A saturation curve of 1000 points
+    const auto& anc = *get_superancillary(PR_CODE, RHOV_CODE);
+    std::vector<double> Ttildes(1000), out(1000);
+    for (auto i = 0U; i < Ttildes.size(); ++i){
+        Ttildes[i] = std::min(anc.get_xmin() + (anc.get_xmax()-anc.get_xmin())*i/(Ttildes.size()-1.0), anc.get_xmax());
+    }
+    BENCHMARK("rhoVtilde(Ttilde) for 1000 points, one at a time") {
+        for (auto i = 0U; i < Ttildes.size(); ++i){ out[i] = anc.y(Ttildes[i]); }
+        return out[0];
+    };
+    BENCHMARK("rhoVtilde(Ttilde) for 1000 points w/ y_many") {
+        anc.y_many(Ttildes.data(), out.data(), Ttildes.size());
+        return out[0];
+    };
+}
 
 
 TEST_CASE("Canonical cubic EOS derivatives", "[cubic]")
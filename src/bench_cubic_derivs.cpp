@@ -0,0 +1,44 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "teqp/models/cubics.hpp"
+#include "teqp/derivs.hpp"
+
+using namespace teqp;
+
+/// Forwards only alphar and R, hiding the closed-form derivatives so that automatic differentiation is used
+template<typename Model>
+struct AutodiffOnly {
+    const Model& model;
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFracType& molefrac) const { return model.alphar(T, rho, molefrac); }
+    template<typename VecType>
+    auto R(const VecType& molefrac) const { return model.R(molefrac); }
+};
+
+TEST_CASE("Benchmark closed-form cubic derivatives against autodiff", "[cubic][analytic][benchmark]"){
+    auto Ncomp = GENERATE(1, 3, 6, 20);
+    std::valarray<double> Tc_K(Ncomp), pc_Pa(Ncomp), acentric(Ncomp);
+    for (auto i = 0; i < Ncomp; ++i){
+        Tc_K[i] = 190.564 + 10*i; pc_Pa[i] = 4599200 - 5e4*i; acentric[i] = 0.011 + 0.02*i;
+    }
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    AutodiffOnly<decltype(model)> ad{model};
+    double T = 300, rho = 3000;
+    auto molefrac = (Eigen::ArrayXd::Ones(Ncomp)/Ncomp).eval();
+    auto rhovec = (rho*molefrac).eval();
+    
+    BENCHMARK("Ar02n closed-form, N=" + std::to_string(Ncomp)){
+        return TDXDerivatives<decltype(model)>::get_Ar0n<2>(model, T, rho, molefrac);
+    };
+    BENCHMARK("Ar02n autodiff, N=" + std::to_string(Ncomp)){
+        return TDXDerivatives<decltype(ad)>::get_Ar0n<2>(ad, T, rho, molefrac);
+    };
+    BENCHMARK("fugacity coefficients closed-form, N=" + std::to_string(Ncomp)){
+        return IsochoricDerivatives<decltype(model)>::get_fugacity_coefficients(model, T, rhovec);
+    };
+    BENCHMARK("fugacity coefficients autodiff, N=" + std::to_string(Ncomp)){
+        return IsochoricDerivatives<decltype(ad)>::get_fugacity_coefficients(ad, T, rhovec);
+    };
+}
@@ -46,6 +46,16 @@ TEST_CASE("multifluid derivatives", "[mf]")
         return DerivativeHolderSquare<2,AlphaWrapperOption::idealgas>(aig, T, rho, z).derivs;
     };
     
+    // The fused block should be compared against the DerivativeHolderSquare benchmarks above (three passes)
+    BENCHMARK("All residual derivatives in one sweep (fused block)") {
+        return TDXDerivatives<decltype(model)>::get_Ar_block<2,2>(model, T, rho, z);
+    };
+    
+    BENCHMARK("All ideal-gas derivatives in one sweep (fused block)") {
+        AlphaCallWrapper<AlphaWrapperOption::idealgas, decltype(aig)> wrapper(aig);
+        return TDXDerivatives<decltype(aig)>::get_Agen_block<2,2>(wrapper, T, rho, z);
+    };
+    
     BENCHMARK("All residual derivatives (via AbstractModel) needed for first derivatives of h,s,u,p w.r.t. T&rho") {
         return amm->get_deriv_mat2(T, rho, z);
     };
@@ -0,0 +1,37 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/flash.hpp"
+
+using namespace teqp;
+using namespace teqp::flash;
+
+TEST_CASE("Isothermal-isobaric flash of a 10-component natural gas", "[flash]")
+{
+    // Methane, ethane, propane, n-butane, isobutane, n-pentane, isopentane, n-hexane, nitrogen, carbon dioxide
+    std::vector<double> Tc_K = {190.564, 305.32, 369.89, 425.125, 407.81, 469.7, 460.35, 507.82, 126.192, 304.1282};
+    std::vector<double> pc_Pa = {4599200, 4872200, 4251200, 3796000, 3629000, 3370000, 3378000, 3034000, 3395800, 7377300};
+    std::vector<double> acentric = {0.011, 0.0995, 0.1521, 0.201, 0.184, 0.251, 0.2274, 0.3, 0.0372, 0.2239};
+    auto model = teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", Tc_K}, {"pcrit / Pa", pc_Pa}, {"acentric", acentric}}}});
+    Eigen::ArrayXd z(10); z << 0.6, 0.1, 0.08, 0.05, 0.04, 0.03, 0.03, 0.03, 0.02, 0.02;
+    const double p = 3e6, T = 250;
+
+    auto r = model->flash(FlashSpecification::PT, p, T, z);
+    REQUIRE(r.success);
+    REQUIRE(r.Nphases == 2);
+
+    BENCHMARK("PT flash, no guess") {
+        return model->flash(FlashSpecification::PT, p, T, z);
+    };
+    BENCHMARK("PT flash, warm start from a state 0.1 K away") {
+        return model->flash(FlashSpecification::PT, p, T + 0.1, z, nullptr, std::nullopt, r);
+    };
+    BENCHMARK("Sweep of 100 PT flashes with warm starts") {
+        std::optional<FlashResult> guess;
+        for (auto i = 0; i < 100; ++i){
+            guess = model->flash(FlashSpecification::PT, p, 200.0 + i, z, nullptr, std::nullopt, guess);
+        }
+        return guess;
+    };
+}
@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <thread>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/parallel.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Scaling of parallel batch evaluation", "[parallel]")
+{
+    auto model = teqp::cppinterface::make_multifluid_model({ "Methane", "Ethane" }, "../mycp");
+    const Eigen::Index N = 100000;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 250, 350);
+    Eigen::ArrayXd rho = Eigen::ArrayXd::LinSpaced(N, 1, 10);
+    Eigen::ArrayXXd Z(N, 2); Z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.1, 0.9); Z.col(1) = 1.0 - Z.col(0);
+    Eigen::ArrayXd out(N);
+    
+    BENCHMARK("Ar11 batched, serial, 1e5 points"){
+        model->get_Arxy_many(1, 1, T, rho, Z, out);
+        return out[N-1];
+    };
+    
+    // Double the number of threads up to the hardware concurrency (capped at 32)
+    const std::size_t Nmax = std::min(32U, std::max(1U, std::thread::hardware_concurrency()));
+    for (std::size_t Nthreads = 1; Nthreads <= Nmax; Nthreads *= 2){
+        parallel::WorkStealingPool pool(Nthreads);
+        BENCHMARK("Ar11 batched, " + std::to_string(Nthreads) + " threads, 1e5 points"){
+            parallel::get_Arxy_many(pool, *model, 1, 1, T, rho, Z, out);
+            return out[N-1];
+        };
+    }
+}
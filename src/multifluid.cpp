@@ -86,6 +86,78 @@ void time_calls(const std::string &coolprop_root, const J &BIPcollection) {
     }
 }
 
+/// Timing of the residual Helmholtz energy of a 20-component natural-gas-like mixture, for which the
+/// evaluation of the pure fluid terms (the flattened term tables) dominates
+template<typename J>
+void time_20component(const std::string& coolprop_root, const J& BIPcollection) {
+    std::vector<std::string> names = { "Methane", "Nitrogen", "CarbonDioxide", "Ethane", "n-Propane", "n-Butane", "IsoButane", "n-Pentane", "Isopentane", "n-Hexane",
+        "n-Heptane", "n-Octane", "n-Nonane", "n-Decane", "Hydrogen", "Oxygen", "CarbonMonoxide", "Water", "HydrogenSulfide", "Argon" };
+    auto model = build_multifluid_model(names, coolprop_root, BIPcollection);
+    Eigen::ArrayXd molefrac = Eigen::ArrayXd::Constant(names.size(), 0.01);
+    molefrac[0] = 1.0 - 0.01*(names.size() - 1);
+    const double T = 300, rho = 5000;
+    using tdx = TDXDerivatives<decltype(model), double, Eigen::ArrayXd>;
+    constexpr int N = 10000;
+    volatile double alphar;
+    {
+        Timer t(N);
+        for (auto i = 0; i < N; ++i) {
+            alphar = model.alphar(T, rho, molefrac);
+        }
+        std::cout << alphar << "; 20 components, function call" << std::endl;
+    }
+    {
+        Timer t(N);
+        for (auto i = 0; i < N; ++i) {
+            alphar = tdx::get_Ar01(model, T, rho, molefrac);
+        }
+        std::cout << alphar << "; 20 components, Ar01 with autodiff" << std::endl;
+    }
+    {
+        Timer t(N);
+        for (auto i = 0; i < N; ++i) {
+            alphar = tdx::get_Ar02(model, T, rho, molefrac);
+        }
+        std::cout << alphar << "; 20 components, Ar02 with autodiff" << std::endl;
+    }
+}
+
+/// Timing of the departure contribution of a GERG-style 21-component mixture; only the pairs with a departure function
+/// are visited in the departure term, compared here with the visit of all the pairs i < j
+template<typename J>
+void time_21component_departure(const std::string& coolprop_root, const J& BIPcollection) {
+    std::vector<std::string> names = { "Methane", "Nitrogen", "CarbonDioxide", "Ethane", "n-Propane", "n-Butane", "IsoButane", "n-Pentane", "Isopentane", "n-Hexane",
+        "n-Heptane", "n-Octane", "n-Nonane", "n-Decane", "Hydrogen", "Oxygen", "CarbonMonoxide", "Water", "HydrogenSulfide", "Helium", "Argon" };
+    auto model = build_multifluid_model(names, coolprop_root, BIPcollection);
+    const auto N = static_cast<int>(names.size());
+    Eigen::ArrayXd molefrac = Eigen::ArrayXd::Constant(N, 1.0/N);
+    const double tau = 1.2, delta = 0.8;
+    const auto& F = model.dep.get_F();
+    std::cout << model.dep.get_Npairs() << " of " << N*(N-1)/2 << " pairs have a departure function" << std::endl;
+    constexpr int Nrep = 100000;
+    volatile double alphar;
+    {
+        Timer t(Nrep);
+        for (auto k = 0; k < Nrep; ++k) {
+            alphar = model.dep.alphar(tau, delta, molefrac);
+        }
+        std::cout << alphar << "; 21 components, departure term over the pairs with a departure function" << std::endl;
+    }
+    {
+        Timer t(Nrep);
+        for (auto k = 0; k < Nrep; ++k) {
+            double o = 0.0;
+            for (auto i = 0; i < N; ++i) {
+                for (auto j = i+1; j < N; ++j) {
+                    o += molefrac[i]*molefrac[j]*F(i, j)*model.dep.get_alpharij(i, j, tau, delta);
+                }
+            }
+            alphar = o;
+        }
+        std::cout << alphar << "; 21 components, departure term over all the pairs" << std::endl;
+    }
+}
+
 int main(){
    
     std::string coolprop_root = "C:/Users/ihb/Code/CoolProp";
@@ -98,6 +170,8 @@ int main(){
     }
 
     time_calls(coolprop_root, BIPcollection);
+    time_20component(coolprop_root, BIPcollection);
+    time_21component_departure(coolprop_root, BIPcollection);
     /*{
         nlohmann::json flags = { {"estimate", true},{"another","key"} };
         auto model = build_multifluid_model({ "Ethane", "R1234ze(E)" }, coolprop_root, BIPcollection, flags);
@@ -362,3 +362,193 @@ TEST_CASE("Check B and its temperature derivatives", "[PCSAFT],[B]")
     auto TdBdT = Tspec*model->get_dmBnvirdTm(2, 1, Tspec, z);
     CHECK(TdBdT == Approx(TdBdTnondilute));
 }
+
+TEST_CASE("Check PCSAFT with association", "[PCSAFT],[association]")
+{
+    // Parameters of Gross and Sadowski, Ind. Eng. Chem. Res., 2002, all with the 2B scheme
+    std::vector<std::tuple<std::string, double, double, double, double, double>> params = {
+        {"Water", 1.0656, 3.0007, 366.51, 2500.7, 0.034868},
+        {"Methanol", 1.5255, 3.2300, 188.90, 2899.5, 0.035176},
+        {"Ethanol", 2.3827, 3.1771, 198.24, 2653.4, 0.032384},
+        {"1-Propanol", 2.9997, 3.2522, 233.40, 2276.8, 0.015268}
+    };
+    std::vector<SAFTCoeffs> coeffs;
+    for (auto [name, m, sigma, eps, epsAB, kappaAB] : params) {
+        SAFTCoeffs c;
+        c.name = name; c.m = m; c.sigma_Angstrom = sigma; c.epsilon_over_k = eps; c.BibTeXKey = "Gross-IECR-2002";
+        c.association_class = association::association_classes::a2B; c.epsilon_AB_over_k = epsAB; c.kappa_AB = kappaAB;
+        coeffs.push_back(c);
+    }
+    auto model = PCSAFTMixture(coeffs);
+    double T = 350, rho = 20000;
+    auto z = (Eigen::ArrayXd(4) << 0.4, 0.3, 0.2, 0.1).finished();
+
+    SECTION("Closed form of the site fractions for a pure 2B fluid") {
+        double epsAB_over_k = 2500.7, vol = 0.034868, g = 1.8, rhoN = 0.012;
+        auto combine = [&](std::size_t, std::size_t) { return std::make_tuple(epsAB_over_k, vol); };
+        association::Association assoc(association::build_site_matrices({association::association_classes::a2B}, combine));
+        auto x = (Eigen::ArrayXd(1) << 1.0).finished();
+        double Delta = g*vol*(exp(epsAB_over_k/T) - 1.0);
+        double X = (-1.0 + sqrt(1.0 + 4.0*rhoN*Delta))/(2.0*rhoN*Delta);
+        CHECK(assoc.alphar(T, rhoN, x, [g](std::size_t, std::size_t) { return g; }) == Approx(2.0*(log(X) - X/2.0 + 0.5)));
+    }
+    SECTION("Duplicated component") {
+        auto water = PCSAFTMixture(std::vector<SAFTCoeffs>{coeffs[0]});
+        auto waterwater = PCSAFTMixture(std::vector<SAFTCoeffs>{coeffs[0], coeffs[0]});
+        auto x = (Eigen::ArrayXd(1) << 1.0).finished();
+        auto xx = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+        CHECK(waterwater.alphar(T, 50000.0, xx) == Approx(water.alphar(T, 50000.0, x)));
+    }
+    SECTION("Derivatives") {
+        using my_float_type = boost::multiprecision::number<boost::multiprecision::cpp_bin_float<100U>>;
+        my_float_type Trecip = 1/T, rhof = rho, h = pow(my_float_type(10.0), -30);
+        auto fTrecip = [&](const auto& x) { return model.alphar(forceeval(1.0/x), rhof, z); };
+        auto fD = [&](const auto& x) { return model.alphar(forceeval(1.0/Trecip), x, z); };
+        using tdx = TDXDerivatives<decltype(model)>;
+        CHECK(tdx::get_Ar10(model, T, rho, z) == Approx(static_cast<double>(Trecip*centered_diff<1, 4>(fTrecip, Trecip, h))));
+        CHECK(tdx::get_Ar01(model, T, rho, z) == Approx(static_cast<double>(rhof*centered_diff<1, 4>(fD, rhof, h))));
+        CHECK(tdx::get_Ar02(model, T, rho, z) == Approx(static_cast<double>(rhof*rhof*centered_diff<2, 4>(fD, rhof, h))));
+    }
+    SECTION("Build from JSON") {
+        nlohmann::json jcoeffs = nlohmann::json::array();
+        for (auto [name, m, sigma, eps, epsAB, kappaAB] : params) {
+            jcoeffs.push_back({ {"name", name}, { "m", m }, { "sigma_Angstrom", sigma }, {"epsilon_over_k", eps}, {"BibTeXKey", "Gross-IECR-2002"}, {"association_class", "2B"}, {"epsilon_AB_over_k", epsAB}, {"kappa_AB", kappaAB} });
+        }
+        nlohmann::json j = {
+            {"kind", "PCSAFT"},
+            {"model", {{"coeffs", jcoeffs}}}
+        };
+        auto modelj = cppinterface::make_model(j);
+        CHECK(modelj->get_Ar00(T, rho, z) == Approx(model.alphar(T, rho, z)));
+    }
+}
+
+/// The hard chain, dispersion and polar terms written out as the direct double and triple sums over the components, as they were evaluated before the coefficient tensors were precomputed
+struct DirectSumPCSAFT {
+    Eigen::ArrayXd m, sigma, eps, mustar2, nmu, Qstar2, nQ;
+    Eigen::ArrayXXd kmat;
+    
+    template<class VecType>
+    auto R(const VecType& molefrac) const {
+        return get_R_gas<decltype(molefrac[0])>();
+    }
+    
+    template<typename TTYPE, typename RhoType, typename VecType>
+    auto alphar(const TTYPE& T, const RhoType& rhomolar, const VecType& x) const {
+        using namespace teqp::SAFTpolar;
+        using TR = std::common_type_t<TTYPE, RhoType, std::decay_t<decltype(x[0])>>;
+        const auto N = m.size();
+        const double pi = EIGEN_PI;
+        
+        TR m2es3 = 0.0, m2e2s3 = 0.0, mbar = 0.0;
+        Eigen::ArrayX<TTYPE> d(N);
+        for (auto i = 0; i < N; ++i){
+            d[i] = sigma[i]*(1.0 - 0.12*exp(-3.0*eps[i]/T));
+            mbar += x[i]*m[i];
+            for (auto j = 0; j < N; ++j){
+                auto sigma_ij = 0.5*sigma[i] + 0.5*sigma[j];
+                auto eij_over_k = sqrt(eps[i]*eps[j])*(1.0 - kmat(i,j));
+                m2es3 += x[i]*x[j]*m[i]*m[j]*eij_over_k/T*pow(sigma_ij, 3);
+                m2e2s3 += x[i]*x[j]*m[i]*m[j]*pow(eij_over_k/T, 2)*pow(sigma_ij, 3);
+            }
+        }
+        auto rho_A3 = forceeval(rhomolar*N_A*1e-30);
+        std::vector<TR> zeta(4);
+        for (auto n = 0; n < 4; ++n){
+            TR summer = 0.0;
+            for (auto i = 0; i < N; ++i){
+                TTYPE dn = 1.0;
+                for (auto k = 0; k < n; ++k){ dn *= d[i]; }
+                summer += x[i]*m[i]*dn;
+            }
+            zeta[n] = pi/6.0*rho_A3*summer;
+        }
+        TR eta = zeta[3];
+        auto [I1, etadI1deta] = get_I1(eta, mbar);
+        auto [I2, etadI2deta] = get_I2(eta, mbar);
+        TR sum_lngii = 0.0;
+        for (auto i = 0; i < N; ++i){
+            sum_lngii += x[i]*(m[i] - 1.0)*log(gij_HS(zeta, d, i, i));
+        }
+        TR alphar = mbar*get_alphar_hs(zeta) - sum_lngii - 2.0*pi*rho_A3*I1*m2es3 - pi*rho_A3*mbar*C1(eta, mbar)*I2*m2e2s3;
+        
+        TR s2DD = 0.0, s3DD = 0.0, s2QQ = 0.0, s3QQ = 0.0;
+        for (auto i = 0; i < N; ++i){
+            for (auto j = 0; j < N; ++j){
+                auto epskij = sqrt(eps[i]*eps[j]);
+                auto sigmaij = (sigma[i] + sigma[j])/2;
+                auto mij = std::min(sqrt(m[i]*m[j]), 2.0);
+                TTYPE Tstarij = T/epskij;
+                if (nmu[i]*nmu[j] > 0){
+                    s2DD += x[i]*x[j]*eps[i]/T*eps[j]/T*POW3(sigma[i]*sigma[j]/sigmaij)*nmu[i]*nmu[j]*mustar2[i]*mustar2[j]*get_JDD_2ij(eta, mij, Tstarij);
+                }
+                if (nQ[i]*nQ[j] > 0){
+                    s2QQ += x[i]*x[j]*eps[i]/T*eps[j]/T*POW5(sigma[i]*sigma[j])/POW7(sigmaij)*nQ[i]*nQ[j]*Qstar2[i]*Qstar2[j]*get_JQQ_2ij(eta, mij, Tstarij);
+                }
+                for (auto k = 0; k < N; ++k){
+                    auto sigmaik = (sigma[i] + sigma[k])/2, sigmajk = (sigma[j] + sigma[k])/2;
+                    auto mijk = std::min(pow(m[i]*m[j]*m[k], 1.0/3.0), 2.0);
+                    if (nmu[i]*nmu[j]*nmu[k] > 0){
+                        s3DD += x[i]*x[j]*x[k]*eps[i]/T*eps[j]/T*eps[k]/T*POW3(sigma[i]*sigma[j]*sigma[k])/(sigmaij*sigmaik*sigmajk)*nmu[i]*nmu[j]*nmu[k]*mustar2[i]*mustar2[j]*mustar2[k]*get_JDD_3ijk(eta, mijk);
+                    }
+                    if (nQ[i]*nQ[j]*nQ[k] > 0){
+                        s3QQ += x[i]*x[j]*x[k]*eps[i]/T*eps[j]/T*eps[k]/T*POW5(sigma[i]*sigma[j]*sigma[k])/POW3(sigmaij*sigmaik*sigmajk)*nQ[i]*nQ[j]*nQ[k]*Qstar2[i]*Qstar2[j]*Qstar2[k]*get_JDD_3ijk(eta, mijk);
+                    }
+                }
+            }
+        }
+        if ((nmu*mustar2).sum() > 0){
+            TR alpha2 = -pi*rho_A3*s2DD, alpha3 = -4.0*POW2(pi)/3.0*POW2(rho_A3)*s3DD;
+            alphar += alpha2/(1.0 - alpha3/alpha2);
+        }
+        if ((nQ*Qstar2).sum() > 0){
+            TR alpha2 = -pi*POW2(3.0/4.0)*rho_A3*s2QQ, alpha3 = -4.0*POW2(pi)/3.0*POW3(3.0/4.0)*POW2(rho_A3)*s3QQ;
+            alphar += alpha2/(1.0 - alpha3/alpha2);
+        }
+        return alphar;
+    }
+};
+
+TEST_CASE("Check PCSAFT with precomputed mixing tensors against the direct sums for a polar mixture", "[PCSAFT][polar]")
+{
+    // Methane, n-butane, CO2 (quadrupolar), acetone and dimethyl ether (dipolar)
+    std::vector<double> m = {1.0, 2.3316, 1.5131, 2.7447, 2.2634}, sigma = {3.7039, 3.7086, 3.1869, 3.2742, 3.2723}, eps = {150.03, 222.88, 169.33, 232.99, 210.29};
+    std::vector<double> mustar2 = {0, 0, 0, 1.5, 0.9}, nmu = {0, 0, 0, 1, 1}, Qstar2 = {0, 0, 1.3, 0, 0}, nQ = {0, 0, 1, 0, 0};
+    const auto N = m.size();
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Zero(N, N);
+    kmat(0,1) = kmat(1,0) = 0.01; kmat(0,2) = kmat(2,0) = 0.06; kmat(2,3) = kmat(3,2) = -0.02;
+    
+    std::vector<SAFTCoeffs> coeffs;
+    DirectSumPCSAFT ref;
+    ref.m.resize(N); ref.sigma.resize(N); ref.eps.resize(N); ref.mustar2.resize(N); ref.nmu.resize(N); ref.Qstar2.resize(N); ref.nQ.resize(N);
+    ref.kmat = kmat;
+    for (auto i = 0U; i < N; ++i){
+        SAFTCoeffs c;
+        c.name = "fluid" + std::to_string(i);
+        c.m = m[i]; c.sigma_Angstrom = sigma[i]; c.epsilon_over_k = eps[i];
+        c.mustar2 = mustar2[i]; c.nmu = nmu[i]; c.Qstar2 = Qstar2[i]; c.nQ = nQ[i];
+        coeffs.push_back(c);
+        ref.m[i] = m[i]; ref.sigma[i] = sigma[i]; ref.eps[i] = eps[i];
+        ref.mustar2[i] = mustar2[i]; ref.nmu[i] = nmu[i]; ref.Qstar2[i] = Qstar2[i]; ref.nQ[i] = nQ[i];
+    }
+    auto model = PCSAFTMixture(coeffs, kmat);
+    
+    double T = 320, rho = 8000;
+    auto z = (Eigen::ArrayXd(5) << 0.4, 0.2, 0.15, 0.15, 0.1).finished();
+    
+    using tdx = TDXDerivatives<decltype(model)>;
+    using tdxref = TDXDerivatives<decltype(ref)>;
+    CHECK(model.alphar(T, rho, z) == Approx(ref.alphar(T, rho, z)).epsilon(1e-13));
+    CHECK(tdx::get_Ar01(model, T, rho, z) == Approx(tdxref::get_Ar01(ref, T, rho, z)).epsilon(1e-12));
+    CHECK(tdx::get_Ar02(model, T, rho, z) == Approx(tdxref::get_Ar02(ref, T, rho, z)).epsilon(1e-12));
+    CHECK(tdx::get_Ar10(model, T, rho, z) == Approx(tdxref::get_Ar10(ref, T, rho, z)).epsilon(1e-12));
+    CHECK(tdx::get_Ar11(model, T, rho, z) == Approx(tdxref::get_Ar11(ref, T, rho, z)).epsilon(1e-12));
+    
+    // The composition derivatives go through the forms with dual numbers as mole fractions
+    auto rhovec = (rho*z).eval();
+    auto lnphi = IsochoricDerivatives<decltype(model)>::get_ln_fugacity_coefficients(model, T, rhovec);
+    auto lnphiref = IsochoricDerivatives<decltype(ref)>::get_ln_fugacity_coefficients(ref, T, rhovec);
+    for (auto i = 0U; i < N; ++i){
+        CHECK(lnphi[i] == Approx(lnphiref[i]).epsilon(1e-12));
+    }
+}
@@ -37,6 +37,19 @@ TEST_CASE("Check integration", "[SAFTVRMIE]"){
     auto deg5 = quad<5, double>(f, -1.0, 1.0);
     CHECK(deg4 == Approx(exact).margin(1e-12));
     CHECK(deg5 == Approx(exact).margin(1e-12));
+    
+    // Any callable can be integrated, and the batched form evaluates all the points at once
+    auto g = [](const double&x){ return x*sin(x); };
+    CHECK(quad<10, double>(g, -1.0, 1.0) == Approx(exact).margin(1e-14));
+    auto gbatch = [](const Eigen::Array<double, 10, 1>& x){ return (x*sin(x)).eval(); };
+    CHECK(quad_batched<10, double>(gbatch, -1.0, 1.0) == Approx(quad<10, double>(g, -1.0, 1.0)).margin(1e-15));
+    
+    // The rule with N points is exact for polynomials of degree 2N-1
+    auto p7 = [](const double&x){ return 3*pow(x, 7) - pow(x, 6) + x; };
+    CHECK(quad<4, double>(p7, 0.0, 2.0) == Approx(3*256.0/8 - 128.0/7 + 2).margin(1e-12));
+    auto p29 = [](const double&x){ return pow(x, 28) + pow(x, 29); };
+    CHECK(quad<15, double>(p29, -1.0, 1.0) == Approx(2.0/29).margin(1e-14));
+    CHECK(quad<30, double>(p29, -1.0, 1.0) == Approx(2.0/29).margin(1e-14));
 }
 
 TEST_CASE("Check integration for d", "[SAFTVRMIE]"){
@@ -58,6 +71,35 @@ TEST_CASE("Check integration for d", "[SAFTVRMIE]"){
     CHECK(d30 == Approx(3.597838581533227e-10).margin(1e-12));
 }
 
+TEST_CASE("Check Chebyshev expansions of d", "[SAFTVRMie][Chebyshev]"){
+    std::vector<std::string> names = {"Methane", "Ethane"};
+    nlohmann::json flags = {{"dii_Chebyshev", {{"Tmin / K", 50.0}, {"Tmax / K", 1500.0}}}};
+    SAFTVRMieMixture model{names}, modelcheb{names, std::nullopt, flags};
+    CHECK(modelcheb.get_terms().dii_Chebyshev);
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    using tdx = TDXDerivatives<SAFTVRMieMixture>;
+    for (double T : {60.0, 300.0, 1400.0}){
+        CAPTURE(T);
+        auto d = model.get_terms().get_dmat(T), dcheb = modelcheb.get_terms().get_dmat(T);
+        CHECK(dcheb(0,0) == Approx(d(0,0)).epsilon(1e-13));
+        CHECK(dcheb(1,1) == Approx(d(1,1)).epsilon(1e-13));
+        CHECK(tdx::get_Ar10(modelcheb, T, 5000.0, z) == Approx(tdx::get_Ar10(model, T, 5000.0, z)).epsilon(1e-10));
+        CHECK(tdx::get_Ar20(modelcheb, T, 5000.0, z) == Approx(tdx::get_Ar20(model, T, 5000.0, z)).epsilon(1e-8));
+    }
+    // Outside the range of the expansions, the evaluation is rejected
+    CHECK_THROWS_AS(modelcheb.get_terms().get_dmat(2000.0), teqp::InvalidArgument);
+    CHECK_THROWS_AS(modelcheb.get_terms().get_dmat(40.0), teqp::InvalidArgument);
+    
+    // Without a range in the flags, the expansions cover the reduced temperatures from 0.1 to 100 of each component
+    SAFTVRMieMixture modeldefault{names, std::nullopt, nlohmann::json{{"dii_Chebyshev", nlohmann::json::object()}}};
+    const auto& eps = modeldefault.get_terms().epsilon_over_k;
+    for (auto i = 0; i < 2; ++i){
+        CHECK(modeldefault.get_terms().dii_Chebyshev.value()[i].get_xmin() == Approx(0.1*eps[i]));
+        CHECK(modeldefault.get_terms().dii_Chebyshev.value()[i].get_xmax() == Approx(100.0*eps[i]));
+    }
+    CHECK(modeldefault.get_terms().get_dmat(2000.0)(0,0) == Approx(model.get_terms().get_dmat(2000.0)(0,0)).epsilon(1e-13));
+}
+
 TEST_CASE("Single alphar check value", "[SAFTVRMie]")
 {
     auto m = (Eigen::ArrayXd(1) << 1.4373).finished();
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/VLE_cache.hpp"
+#include "teqp/algorithms/flash_types.hpp"
+
+using namespace teqp;
+using namespace teqp::flash;
+
+namespace {
+    // Methane + propane with Peng-Robinson, and a two-phase state point to start from
+    auto make_VLE_model(){
+        auto model = teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 369.89}}, {"pcrit / Pa", {4599200.0, 4251200.0}}, {"acentric", {0.011, 0.1521}}}}});
+        Eigen::ArrayXd z(2); z << 0.5, 0.5;
+        auto r = model->flash(FlashSpecification::PT, 2e6, 250, z);
+        return std::make_tuple(std::move(model), r);
+    }
+}
+
+TEST_CASE("mix_VLE_Tp stops once converged, with the same solution as running all the iterations", "[VLE]"){
+    auto [model, r] = make_VLE_model();
+    REQUIRE(r.Nphases == 2);
+    // Start a little away from the solution
+    Eigen::ArrayXd rhovecL0 = 0.98*r.rhoL*r.x, rhovecV0 = 1.02*r.rhoV*r.y;
+    
+    auto rdefault = model->mix_VLE_Tp(250, 2e6, rhovecL0, rhovecV0);
+    CHECK(rdefault.success);
+    CHECK(rdefault.num_iter < MixVLETpFlags{}.maxiter);
+    
+    // With the tolerances at zero, all the iterations are carried out, as mix_VLE_Tp always did before it could stop early
+    MixVLETpFlags flags; flags.atol = 0; flags.reltol = 0; flags.axtol = 0; flags.relxtol = 0;
+    auto rall = model->mix_VLE_Tp(250, 2e6, rhovecL0, rhovecV0, flags);
+    for (auto i = 0; i < 2; ++i){
+        CHECK(rdefault.rhovecL[i] == Approx(rall.rhovecL[i]).epsilon(1e-10));
+        CHECK(rdefault.rhovecV[i] == Approx(rall.rhovecV[i]).epsilon(1e-10));
+    }
+    
+    // An empty cache passes the guesses through, so the result is exactly that of mix_VLE_Tp
+    VLESolutionCache cache(*model);
+    auto rcold = cache.mix_VLE_Tp(250, 2e6, rhovecL0, rhovecV0);
+    CHECK(cache.get_stats().num_hits == 0);
+    CHECK((rcold.rhovecL == rdefault.rhovecL).all());
+    CHECK((rcold.rhovecV == rdefault.rhovecV).all());
+    CHECK(rcold.num_iter == rdefault.num_iter);
+}
+
+TEST_CASE("Warm starts of VLE from a cache of solutions", "[VLE][cache]"){
+    auto [model, r] = make_VLE_model();
+    REQUIRE(r.Nphases == 2);
+    Eigen::ArrayXd rhovecL0 = r.rhoL*r.x, rhovecV0 = r.rhoV*r.y;
+
+    SECTION("Isothermal-isobaric"){
+        VLESolutionCache cache(*model);
+        // Nothing stored yet, and no guesses
+        CHECK_THROWS(cache.mix_VLE_Tp(252, 2e6));
+        for (auto i = 0; i < 50; ++i){
+            const double T = 252 + 0.2*i, p = 2e6*(1 + 0.001*i);
+            auto rc = cache.mix_VLE_Tp(T, p, rhovecL0, rhovecV0);
+            REQUIRE(rc.success);
+            // The same solution as obtained without the cache
+            auto rref = model->mix_VLE_Tp(T, p, rc.rhovecL, rc.rhovecV);
+            CHECK(rref.rhovecL[0] == Approx(rc.rhovecL[0]));
+            CHECK(rref.rhovecV[1] == Approx(rc.rhovecV[1]));
+        }
+        const auto& s = cache.get_stats();
+        CHECK(s.num_calls == 50);
+        CHECK(s.num_hits == 49);
+        CHECK(s.num_extrapolated == 49);
+        CHECK(s.num_failures == 0);
+        CHECK(s.mean_iter_hits() < s.mean_iter_misses());
+        CHECK(cache.size() == 50);
+        // Far away from all the stored solutions
+        CHECK_THROWS(cache.mix_VLE_Tp(350, 2e6));
+    }
+    SECTION("Isobaric with specified liquid composition"){
+        VLECacheOptions opt; opt.capacity = 8;
+        VLESolutionCache cache(*model, opt);
+        for (auto i = 0; i < 20; ++i){
+            const double p = 2e6*(1 + 0.002*i);
+            Eigen::ArrayXd x(2); x << r.x[0] + 0.001*i, 1 - r.x[0] - 0.001*i;
+            auto [code, T, rhovecL, rhovecV] = cache.mixture_VLE_px(p, x, r.T, rhovecL0, rhovecV0);
+            REQUIRE((code == VLE_return_code::xtol_satisfied || code == VLE_return_code::functol_satisfied));
+            CHECK(rhovecL[0]/rhovecL.sum() == Approx(x[0]));
+        }
+        CHECK(cache.get_stats().hit_rate() == Approx(19.0/20.0));
+        CHECK(cache.size() == 8);
+    }
+}
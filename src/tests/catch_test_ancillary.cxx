@@ -17,3 +17,41 @@ TEST_CASE("build ancillaries", "[ancillaries]")
     auto model = teqp::cppinterface::make_model(j);
     auto anc = teqp::ancillaries::build_ancillaries(*model, 370, 5000, 75);
 }
+
+TEST_CASE("build superancillaries", "[ancillaries]")
+{
+    auto j = R"(
+    {
+      "kind": "SAFT-VR-Mie",
+      "model": {"names": ["Propane"]}
+    }
+    )"_json;
+    auto model = teqp::cppinterface::make_model(j);
+    auto anc = teqp::ancillaries::build_superancillaries(*model, 370, 5000, 150);
+    auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    double R = model->get_R(z);
+    
+    // Away from the critical point, the superancillaries reproduce the iterative VLE calculation to nearly the precision of the latter
+    for (double Theta : {0.5, 0.3, 0.1, 0.01}){
+        double T = anc.Tcrit*(1-Theta);
+        CAPTURE(T);
+        auto rhovec = model->pure_VLE_T(T, anc.rhoL(T), anc.rhoV(T), 10);
+        double p = rhovec[0]*R*T*(1+model->get_Ar01(T, rhovec[0], z));
+        CHECK(anc.rhoL(T) == Approx(rhovec[0]).epsilon(1e-10));
+        CHECK(anc.rhoV(T) == Approx(rhovec[1]).epsilon(1e-10));
+        CHECK(anc.p(T) == Approx(p).epsilon(1e-10));
+        // And the saturation temperature is obtained from the pressure or the densities without any VLE calculation
+        CHECK(anc.p.solve_for_T(p) == Approx(T).epsilon(1e-12));
+        CHECK(anc.rhoL.solve_for_T(rhovec[0]) == Approx(T).epsilon(1e-10));
+        CHECK(anc.rhoV.solve_for_T(rhovec[1]) == Approx(T).epsilon(1e-10));
+    }
+    CHECK_THROWS(anc.p.solve_for_T(2*anc.pcrit));
+    CHECK(anc.rhoL(anc.Tcrit) == Approx(anc.rhocrit).epsilon(1e-14));
+    CHECK_THROWS(anc.rhoL(149.0));
+    CHECK_THROWS(anc.rhoL(anc.Tcrit + 1e-6));
+    
+    // And they are recovered exactly from their JSON representation
+    teqp::SuperAncillaryVLE anc2(nlohmann::json::parse(anc.to_json().dump()));
+    CHECK(anc2.rhoV(250.0) == anc.rhoV(250.0));
+    CHECK(anc2.p(250.0) == anc.p(250.0));
+}
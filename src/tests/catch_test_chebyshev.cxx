@@ -0,0 +1,40 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/types.hpp"
+#include "teqp/math/chebyshev.hpp"
+#include "teqp/models/cubicsuperancillary.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Check Chebyshev expansions", "[Chebyshev]"){
+    auto f = [](double x){ return exp(x)*sin(3*x); };
+    auto ce = fit_Chebyshev(f, -1.0, 2.0, 30);
+    auto pw = fit_piecewise_Chebyshev(f, -1.0, 2.0, 8, 1e-14);
+    CHECK(pw.expansions.size() > 1);
+    for (double x : {-1.0, -0.3, 0.77, 1.5, 2.0}){
+        CAPTURE(x);
+        CHECK(ce.eval(x) == Approx(f(x)).margin(1e-13));
+        CHECK(pw.eval(x, x) == Approx(f(x)).margin(1e-13));
+    }
+    CHECK(pw.contains(-1.0));
+    CHECK(pw.contains(2.0));
+    CHECK(!pw.contains(2.0 + 1e-12));
+    // The derivative of the expansion follows from the automatic differentiation of Clenshaw's method
+    autodiff::dual x = 0.77;
+    auto df = autodiff::derivative([&ce](const autodiff::dual& x_){ return ce.eval(x_); }, autodiff::wrt(x), autodiff::at(x));
+    CHECK(df == Approx(exp(0.77)*(sin(3*0.77) + 3*cos(3*0.77))).margin(1e-11));
+}
+
+TEST_CASE("Check that the cubic superancillaries use the general Chebyshev expansions", "[Chebyshev]"){
+    static_assert(std::is_same_v<CubicSuperAncillary::Chebyshev, ChebyshevExpansion>);
+    // The pressure of the superancillary for PR, evaluated from its own expansion and from a refit of that expansion
+    const auto& sa = CubicSuperAncillary::PR_p;
+    auto Ttilde = (sa.get_xmin() + sa.get_xmax())/2.0;
+    auto i = sa.get_index(Ttilde);
+    std::vector<double> coeff(sa.coeffs.begin() + i*sa.Ncoeff, sa.coeffs.begin() + (i+1)*sa.Ncoeff);
+    CubicSuperAncillary::Chebyshev e{coeff, sa.xmins[i], sa.xmaxs[i]};
+    CHECK(e.eval(Ttilde) == sa.y(Ttilde));
+}
@@ -3,6 +3,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 using Catch::Approx;
 
@@ -41,6 +43,44 @@ TEST_CASE("Test construction of cubic", "[cubic]")
     int rr = 0;
 }
 
+TEST_CASE("Check fused block of derivatives", "[cubic][derivblock]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581, 150.687 },
+                pc_Pa = { 4599200, 5042800, 4863000 },
+               acentric = { 0.011, 0.022, -0.002};
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    double T = 200, rho = 5000;
+    auto molefrac = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+    using tdx = TDXDerivatives<decltype(model)>;
+    
+    auto block = tdx::get_Ar_block<2,2>(model, T, rho, molefrac);
+    CHECK(block(0,0) == Approx(tdx::get_Arxy<0,0>(model, T, rho, molefrac)));
+    CHECK(block(0,1) == Approx(tdx::get_Arxy<0,1>(model, T, rho, molefrac)));
+    CHECK(block(0,2) == Approx(tdx::get_Arxy<0,2>(model, T, rho, molefrac)));
+    CHECK(block(1,0) == Approx(tdx::get_Arxy<1,0>(model, T, rho, molefrac)));
+    CHECK(block(1,1) == Approx(tdx::get_Arxy<1,1>(model, T, rho, molefrac)));
+    CHECK(block(1,2) == Approx(tdx::get_Arxy<1,2>(model, T, rho, molefrac)));
+    CHECK(block(2,0) == Approx(tdx::get_Arxy<2,0>(model, T, rho, molefrac)));
+    CHECK(block(2,1) == Approx(tdx::get_Arxy<2,1>(model, T, rho, molefrac)));
+    CHECK(block(2,2) == Approx(tdx::get_Arxy<2,2>(model, T, rho, molefrac)));
+    
+    // Rectangular blocks, and the block via the AbstractModel
+    auto block21 = tdx::get_Ar_block<2,1>(model, T, rho, molefrac);
+    CHECK(block21(2,1) == Approx(block(2,1)));
+    auto block02 = tdx::get_Ar_block<0,2>(model, T, rho, molefrac);
+    CHECK(block02(0,2) == Approx(block(0,2)));
+    
+    auto am = teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", Tc_K}, {"pcrit / Pa", pc_Pa}, {"acentric", acentric}}}});
+    auto mat2 = am->get_deriv_mat2(T, rho, molefrac);
+    auto block1 = am->get_Ar_block(1, T, rho, molefrac);
+    // get_deriv_mat2 only has the entries that DerivativeHolderSquare calculates
+    for (const auto& ij : std::vector<std::pair<int, int>>{{0,0}, {0,1}, {0,2}, {1,0}, {2,0}, {1,1}}){
+        CHECK(mat2(ij.first, ij.second) == Approx(block(ij.first, ij.second)));
+    }
+    CHECK(block1(1,1) == Approx(block(1,1)));
+    CHECK_THROWS(am->get_Ar_block(3, T, rho, molefrac));
+}
+
 TEST_CASE("Check SRK with kij setting", "[cubic]")
 {
     // Values taken from http://dx.doi.org/10.6028/jres.121.011
@@ -86,6 +126,53 @@ TEST_CASE("Check calling superancillary curves", "[cubic][superanc]")
     }
 }
 
+TEST_CASE("Check inversion of superancillary curves", "[cubic][superanc]")
+{
+    using namespace CubicSuperAncillary;
+    for (int EOS : {VDW_CODE, SRK_CODE, PR_CODE}){
+        for (int prop : {P_CODE, RHOL_CODE, RHOV_CODE}){
+            CAPTURE(EOS);
+            CAPTURE(prop);
+            // Ttilde at the critical point is Omega_b/Omega_a
+            double Ttildec = (EOS == VDW_CODE) ? 8.0/27.0 : (EOS == SRK_CODE) ? 0.2026767 : 0.1701444;
+            for (double Theta : {0.85, 0.5, 0.1, 0.01}){
+                double Ttilde = Ttildec*(1-Theta);
+                double ytilde = supercubic(EOS, prop, Ttilde);
+                CHECK(supercubic_Ttilde(EOS, prop, ytilde) == Approx(Ttilde).epsilon(1e-13));
+            }
+            CHECK_THROWS(supercubic_Ttilde(EOS, prop, -1.0));
+        }
+    }
+}
+
+TEST_CASE("Check vectorized evaluation of superancillary curves", "[cubic][superanc]")
+{
+    using namespace CubicSuperAncillary;
+    for (int EOS : {VDW_CODE, SRK_CODE, PR_CODE}){
+        for (int prop : {P_CODE, RHOL_CODE, RHOV_CODE}){
+            CAPTURE(EOS);
+            CAPTURE(prop);
+            const auto& anc = *get_superancillary(EOS, prop);
+            // Points spread over the range, and on either side of each of the boundaries between the expansions
+            std::vector<double> Ttilde;
+            for (auto i = 0; i <= 100; ++i){
+                Ttilde.push_back(std::min(anc.get_xmin() + (anc.get_xmax()-anc.get_xmin())*i/100.0, anc.get_xmax()));
+            }
+            for (auto i = 1U; i < anc.Nexps; ++i){
+                Ttilde.push_back(anc.xmins[i]);
+                Ttilde.push_back(std::nextafter(anc.xmins[i], 0.0));
+            }
+            auto y = supercubic_many(EOS, prop, Ttilde);
+            for (auto i = 0U; i < Ttilde.size(); ++i){
+                auto j = anc.get_index(Ttilde[i]);
+                CHECK((Ttilde[i] >= anc.xmins[j] && Ttilde[i] <= anc.xmaxs[j]));
+                CHECK(y[i] == supercubic(EOS, prop, Ttilde[i]));
+            }
+            CHECK_THROWS(anc.y_many({anc.get_xmax()*1.01}));
+        }
+    }
+}
+
 TEST_CASE("Check orthobaric density derivatives for pure fluid", "[cubic][superanc]")
 {
     std::valarray<double> Tc_K = { 150.687 };
@@ -708,3 +795,88 @@ TEST_CASE("RK-PR EOS w/ make_model", "[RKPR]"){
     auto z = (Eigen::ArrayXd(1) << 1.0).finished();
     CHECK(std::isfinite(model->get_B2vir(300, z)));
 }
+
+/// Forwards only alphar and R, hiding the closed-form derivatives so that automatic differentiation is used
+template<typename Model>
+struct AutodiffOnly {
+    const Model& model;
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFracType& molefrac) const { return model.alphar(T, rho, molefrac); }
+    template<typename VecType>
+    auto R(const VecType& molefrac) const { return model.R(molefrac); }
+};
+
+TEST_CASE("Check closed-form cubic derivatives against autodiff", "[cubic][analytic]"){
+    std::valarray<double> Tc_K = { 190.564, 154.581, 150.687 },
+                pc_Pa = { 4599200, 5042800, 4863000 },
+               acentric = { 0.011, 0.022, -0.002};
+    Eigen::ArrayXXd kmat(3, 3); kmat << 0, 0.03, 0.05, 0.01, 0, -0.02, 0.05, -0.04, 0;
+    auto j = nlohmann::json{
+        {"type", "PR"}, {"Tcrit / K", {190.564, 154.581, 150.687}}, {"pcrit / Pa", {4599200, 5042800, 4863000}}, {"acentric", {0.011, 0.022, -0.002}},
+        {"alpha", {{{"type","Twu"},{"c",{0.1,0.8,2.0}}}, {{"type","Mathias-Copeman"},{"c",{0.4,-0.2,0.3}}}, {{"type","PR78"},{"acentric",0.02}}}}
+    };
+    
+    auto check = [](const auto& model){
+        using Model = std::decay_t<decltype(model)>;
+        static_assert(has_analytic_derivatives<Model>::value);
+        static_assert(!has_analytic_derivatives<AutodiffOnly<Model>>::value);
+        
+        AutodiffOnly<Model> ad{model};
+        using tdx = TDXDerivatives<Model>;
+        using tdxad = TDXDerivatives<AutodiffOnly<Model>>;
+        double T = 250, rho = 12000;
+        auto molefrac = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+        
+        auto Ar06 = tdx::template get_Ar0n<6>(model, T, rho, molefrac), Ar06ad = tdxad::template get_Ar0n<6>(ad, T, rho, molefrac);
+        for (auto n = 0; n <= 6; ++n){
+            CHECK(Ar06[n] == Approx(Ar06ad[n]).epsilon(1e-12));
+        }
+        
+        auto rhovec = (rho*molefrac).eval();
+        auto lnphi = IsochoricDerivatives<Model>::get_ln_fugacity_coefficients(model, T, rhovec);
+        auto lnphiad = IsochoricDerivatives<AutodiffOnly<Model>>::get_ln_fugacity_coefficients(ad, T, rhovec);
+        for (auto i = 0; i < rhovec.size(); ++i){
+            CHECK(lnphi[i] == Approx(lnphiad[i]).epsilon(1e-12));
+        }
+        
+        // The other backends are not affected
+        CHECK(tdx::template get_Ar01<ADBackends::complex_step>(model, T, rho, molefrac) == Approx(Ar06[1]).epsilon(1e-12));
+    };
+    SECTION("PR"){ check(canonical_PR(Tc_K, pc_Pa, acentric, kmat)); }
+    SECTION("SRK"){ check(canonical_SRK(Tc_K, pc_Pa, acentric, kmat)); }
+    SECTION("generalized"){ check(make_generalizedcubic(j)); }
+}
+
+TEST_CASE("Check hoisted mixing of the attractive parameter", "[cubic][mixing]"){
+    auto Ncomp = GENERATE(1, 5, 40);
+    std::valarray<double> Tc_K(Ncomp), pc_Pa(Ncomp), acentric(Ncomp);
+    for (auto i = 0; i < Ncomp; ++i){
+        Tc_K[i] = 190.0 + 10*i; pc_Pa[i] = 4.6e6 - 5e4*i; acentric[i] = 0.01 + 0.02*i;
+    }
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Constant(Ncomp, Ncomp, 0.01);
+    kmat.matrix().diagonal().setZero();
+    auto molefrac = (Eigen::ArrayXd::Ones(Ncomp)/Ncomp).eval();
+    double T = 300;
+    
+    for (auto model : {canonical_PR(Tc_K, pc_Pa, acentric), canonical_PR(Tc_K, pc_Pa, acentric, kmat)}){
+        // The quadratic form with the matrix of a_ij gives the same a as the hoisted summation
+        auto aij = model.get_aij(T);
+        double a = (molefrac.matrix().transpose()*aij.matrix()*molefrac.matrix())(0);
+        CHECK(model.get_a(T, molefrac) == Approx(a).epsilon(1e-14));
+        
+        // And so does the original double loop with the square roots of each pair
+        auto s = model.get_sqrt_aialpha(T);
+        double a_pairs = 0;
+        for (auto i = 0; i < Ncomp; ++i){
+            for (auto j = 0; j < Ncomp; ++j){
+                a_pairs += molefrac[i]*molefrac[j]*(1-model.get_kmat()(i,j))*sqrt(s[i]*s[i]*s[j]*s[j]);
+            }
+        }
+        CHECK(a == Approx(a_pairs).epsilon(1e-14));
+        
+        std::string kij = ((model.get_kmat() == 0).all()) ? "zero" : "nonzero";
+        BENCHMARK("get_a, N=" + std::to_string(Ncomp) + ", kij " + kij){
+            return model.get_a(T, molefrac);
+        };
+    }
+}
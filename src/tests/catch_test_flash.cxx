@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/flash.hpp"
+
+using namespace teqp;
+using namespace teqp::flash;
+
+namespace {
+    // Methane + propane with Peng-Robinson, and constant heat capacities for the ideal-gas part
+    auto make_flash_models(){
+        auto model = teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 369.89}}, {"pcrit / Pa", {4599200.0, 4251200.0}}, {"acentric", {0.011, 0.1521}}}}});
+        nlohmann::json jigs = nlohmann::json::array();
+        for (double cp0R : {4.3, 8.9}){
+            nlohmann::json terms = nlohmann::json::array();
+            terms.push_back({{"type", "Lead"}, {"a_1", 0.0}, {"a_2", 0.0}});
+            terms.push_back({{"type", "LogT"}, {"a", -(cp0R-1)}});
+            jigs.push_back({{"R", 8.31446261815324}, {"terms", terms}});
+        }
+        auto aig = teqp::cppinterface::make_model({{"kind", "IdealHelmholtz"}, {"model", jigs}});
+        return std::make_tuple(std::move(model), std::move(aig));
+    }
+}
+
+TEST_CASE("Isothermal-isobaric flash", "[flash]"){
+    auto [model, aig] = make_flash_models();
+    Eigen::ArrayXd z(2); z << 0.5, 0.5;
+    const double T = 250, p = 2e6;
+
+    auto r = model->flash(FlashSpecification::PT, p, T, z);
+    REQUIRE(r.success);
+    REQUIRE(r.Nphases == 2);
+    CHECK(r.beta > 0);
+    CHECK(r.beta < 1);
+    CHECK(r.x.sum() == Approx(1.0));
+    CHECK(r.y.sum() == Approx(1.0));
+    // Mass balance
+    Eigen::ArrayXd zcalc = r.beta*r.y + (1-r.beta)*r.x;
+    CHECK(zcalc[0] == Approx(z[0]));
+    // Equal pressures and fugacities in the two phases
+    const double R = model->get_R(z);
+    for (auto [rho, x] : {std::make_tuple(r.rhoL, Eigen::ArrayXd(r.x)), std::make_tuple(r.rhoV, Eigen::ArrayXd(r.y))}){
+        CHECK(rho*R*T*(1+model->get_Ar01(T, rho, x)) == Approx(p));
+    }
+    Eigen::ArrayXd fL = r.x*model->get_fugacity_coefficients(T, (r.rhoL*r.x).eval());
+    Eigen::ArrayXd fV = r.y*model->get_fugacity_coefficients(T, (r.rhoV*r.y).eval());
+    CHECK(fL[0] == Approx(fV[0]));
+    CHECK(fL[1] == Approx(fV[1]));
+
+    SECTION("Warm start at a nearby state point"){
+        auto r2 = model->flash(FlashSpecification::PT, p, T+1, z, nullptr, std::nullopt, r);
+        REQUIRE(r2.success);
+        CHECK(r2.Nphases == 2);
+        CHECK(r2.beta > r.beta);
+        auto r2cold = model->flash(FlashSpecification::PT, p, T+1, z);
+        CHECK(r2.beta == Approx(r2cold.beta));
+        CHECK(r2.num_SS <= r2cold.num_SS);
+    }
+    SECTION("Single phase"){
+        auto rvap = model->flash(FlashSpecification::PT, p, 400, z);
+        REQUIRE(rvap.success);
+        CHECK(rvap.Nphases == 1);
+        CHECK(rvap.rhoL == Approx(rvap.rhoV));
+        auto rliq = model->flash(FlashSpecification::PT, 1e7, 150, z);
+        REQUIRE(rliq.success);
+        CHECK(rliq.Nphases == 1);
+        CHECK(rliq.beta == 0);
+    }
+    SECTION("Bad inputs"){
+        Eigen::ArrayXd zbad(2); zbad << 0.5, 0.6;
+        CHECK_THROWS(model->flash(FlashSpecification::PT, p, T, zbad));
+        CHECK_THROWS(model->flash(FlashSpecification::PH, p, 0.0, z));
+    }
+}
+
+TEST_CASE("Flash with energy and entropy specifications", "[flash]"){
+    auto [model, aig] = make_flash_models();
+    Eigen::ArrayXd z(2); z << 0.5, 0.5;
+
+    // States in the two-phase region, and in the vapor and liquid
+    for (auto [T, p] : {std::make_tuple(250.0, 2e6), std::make_tuple(400.0, 2e6), std::make_tuple(150.0, 1e7)}){
+        CAPTURE(T, p);
+        auto rPT = model->flash(FlashSpecification::PT, p, T, z);
+        REQUIRE(rPT.success);
+        const double h = internal::get_property('H', *model, aig.get(), rPT);
+        const double s = internal::get_property('S', *model, aig.get(), rPT);
+        const double u = internal::get_property('U', *model, aig.get(), rPT);
+        const double v = internal::get_property('V', *model, aig.get(), rPT);
+
+        auto rPH = model->flash(FlashSpecification::PH, p, h, z, aig.get());
+        REQUIRE(rPH.success);
+        CHECK(rPH.T == Approx(T));
+        CHECK(rPH.Nphases == rPT.Nphases);
+
+        auto rPS = model->flash(FlashSpecification::PS, p, s, z, aig.get());
+        REQUIRE(rPS.success);
+        CHECK(rPS.T == Approx(T));
+
+        auto rTS = model->flash(FlashSpecification::TS, T, s, z, aig.get());
+        REQUIRE(rTS.success);
+        CHECK(rTS.p == Approx(p));
+
+        auto rUV = model->flash(FlashSpecification::UV, u, v, z, aig.get());
+        REQUIRE(rUV.success);
+        CHECK(rUV.T == Approx(T));
+        CHECK(rUV.p == Approx(p));
+    }
+}
@@ -2,9 +2,12 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <thread>
+#include <atomic>
 
 #include <catch2/catch_test_macros.hpp>
 #include "teqp/json_tools.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
 
 static nlohmann::json person_schema = R"(
 {
@@ -49,3 +52,40 @@ TEST_CASE("Test JSON validation with json-schema-validator", "[JSON]")
 //        std::cout << err << std::endl;
 //    }
 }
+
+TEST_CASE("Validation of models with cached validators from many threads", "[JSON]")
+{
+    nlohmann::json good = {
+        {"kind", "PR"},
+        {"model", {
+            {"Tcrit / K", {190.564}},
+            {"pcrit / Pa", {4599200}},
+            {"acentric", {0.011}}
+        }}
+    };
+    nlohmann::json bad = good;
+    bad["model"]["Tcrit / K"] = "190.564";
+    
+    std::atomic<int> Ngood = 0, Nbad = 0;
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 8; ++i){
+        threads.emplace_back([&](){
+            for (auto k = 0; k < 20; ++k){
+                try{
+                    teqp::cppinterface::make_model(good);
+                    Ngood++;
+                }
+                catch(...){}
+                try{
+                    teqp::cppinterface::make_model(bad);
+                }
+                catch(const teqp::JSONValidationError&){
+                    Nbad++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads){ t.join(); }
+    CHECK(Ngood == 160);
+    CHECK(Nbad == 160);
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <catch2/generators/catch_generators_adapters.hpp>
 #include <catch2/generators/catch_generators_range.hpp>
@@ -535,3 +536,307 @@ TEST_CASE("Ar20 for CO2", "[Ar20CO2]"){
         //std::cout << T << "," << mp << "," << mp/ad-1 << std::endl;
     }
 }
+
+TEST_CASE("Check that the flattened term table gives the same result as the individual terms", "[multifluid],[termtable]") {
+    JustPowerEOSTerm poly;
+    poly.n = (Eigen::ArrayXd(3) << 0.4, -1.2, 0.1).finished();
+    poly.t = (Eigen::ArrayXd(3) << 0.25, 1.125, 1.5).finished();
+    poly.d = (Eigen::ArrayXd(3) << 1, 1, 4).finished();
+
+    PowerEOSTerm power;
+    power.n = (Eigen::ArrayXd(3) << 0.3, -0.2, 0.05).finished();
+    power.t = (Eigen::ArrayXd(3) << 2.5, 3.0, 8.0).finished();
+    power.d = (Eigen::ArrayXd(3) << 1, 2, 3).finished();
+    power.l = (Eigen::ArrayXd(3) << 1, 2, 3).finished();
+    power.c = Eigen::ArrayXd::Ones(3);
+    power.l_i = power.l.cast<int>();
+
+    GaussianEOSTerm gauss;
+    gauss.n = (Eigen::ArrayXd(2) << 0.02, -0.01).finished();
+    gauss.t = (Eigen::ArrayXd(2) << 1.0, 2.5).finished();
+    gauss.d = (Eigen::ArrayXd(2) << 2, 3).finished();
+    gauss.eta = (Eigen::ArrayXd(2) << 20, 25).finished();
+    gauss.beta = (Eigen::ArrayXd(2) << 325, 300).finished();
+    gauss.gamma = (Eigen::ArrayXd(2) << 1.16, 1.19).finished();
+    gauss.epsilon = (Eigen::ArrayXd(2) << 1, 1).finished();
+
+    Lemmon2005EOSTerm lemmon;
+    lemmon.n = (Eigen::ArrayXd(1) << 0.1).finished();
+    lemmon.t = (Eigen::ArrayXd(1) << 1.5).finished();
+    lemmon.d = (Eigen::ArrayXd(1) << 2).finished();
+    lemmon.l = (Eigen::ArrayXd(1) << 2).finished();
+    lemmon.l_i = lemmon.l.cast<int>();
+    lemmon.m = (Eigen::ArrayXd(1) << 1.3).finished();
+
+    EOSTerms terms;
+    terms.add_term(poly);
+    terms.add_term(power);
+    terms.add_term(gauss);
+    terms.add_term(lemmon);
+    CHECK(terms.size() == 4);
+
+    auto sum_of_terms = [&](const auto& tau, const auto& delta) {
+        return forceeval(poly.alphar(tau, delta) + power.alphar(tau, delta) + gauss.alphar(tau, delta) + lemmon.alphar(tau, delta));
+    };
+    double tau = 1.3;
+    for (double delta : {0.0, 1e-4, 0.7, 2.5}) {
+        CAPTURE(delta);
+        CHECK(terms.alphar(tau, delta) == Approx(sum_of_terms(tau, delta)).margin(1e-14));
+        // Also with autodiff types, for which the table is evaluated term by term
+        autodiff::dual tauad = tau, deltaad = delta;
+        deltaad.grad = 1.0;
+        auto ad = terms.alphar(tauad, deltaad), adref = sum_of_terms(tauad, deltaad);
+        CHECK(ad.val == Approx(adref.val).margin(1e-14));
+        CHECK(ad.grad == Approx(adref.grad).margin(1e-14));
+    }
+}
+
+TEST_CASE("Check that the shared tau, delta context gives the same result as evaluating each fluid on its own", "[multifluid],[termtable]") {
+    std::string root = "../mycp";
+    const auto model = build_multifluid_model({ "Methane", "Ethane", "Water" }, root);
+    Eigen::ArrayXd z(3); z << 0.5, 0.3, 0.2;
+    const double T = 350, rho = 3000;
+    const double tau = model.redfunc.get_Tr(z)/T, delta = rho/model.redfunc.get_rhor(z);
+    const auto& F = model.dep.get_F();
+
+    auto alphar_separately = [&](const auto& tau_, const auto& delta_) {
+        std::common_type_t<std::decay_t<decltype(tau_)>, std::decay_t<decltype(delta_)>> o = 0.0;
+        for (auto i = 0; i < z.size(); ++i) {
+            o = o + z[i]*model.corr.alphari(tau_, delta_, i);
+            for (auto j = i+1; j < z.size(); ++j) {
+                o = o + z[i]*z[j]*F(i, j)*model.dep.get_alpharij(i, j, tau_, delta_);
+            }
+        }
+        return o;
+    };
+    CHECK(model.alphar(T, rho, z) == Approx(alphar_separately(tau, delta)).margin(1e-14));
+
+    autodiff::dual deltaad = delta;
+    deltaad.grad = 1.0;
+    auto ad = model.corr.alphar(tau, deltaad, z) + model.dep.alphar(tau, deltaad, z);
+    auto adref = alphar_separately(tau, deltaad);
+    CHECK(ad.val == Approx(adref.val).margin(1e-14));
+    CHECK(ad.grad == Approx(adref.grad).margin(1e-14));
+}
+
+TEST_CASE("Check that only the pairs with departure functions are visited", "[multifluid],[departure]") {
+    std::string root = "../mycp";
+    std::vector<std::string> names = { "Methane", "Nitrogen", "CarbonDioxide", "Ethane", "n-Propane", "Hydrogen", "Helium" };
+    const auto model = build_multifluid_model(names, root);
+    const auto N = static_cast<int>(names.size());
+    Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0/N);
+    const double tau = 1.3, delta = 0.6;
+    const auto& F = model.dep.get_F();
+
+    double dense = 0.0;
+    std::size_t Nnonzero = 0;
+    for (auto i = 0; i < N; ++i) {
+        for (auto j = i+1; j < N; ++j) {
+            auto alpharij = model.dep.get_alpharij(i, j, tau, delta);
+            dense += z[i]*z[j]*F(i, j)*alpharij;
+            if (F(i, j) != 0 && alpharij != 0) { Nnonzero++; }
+        }
+    }
+    CHECK(model.dep.get_Npairs() == Nnonzero);
+    CHECK(model.dep.get_Npairs() < static_cast<std::size_t>(N*(N-1)/2));
+    CHECK(model.dep.alphar(tau, delta, z) == Approx(dense).margin(1e-15));
+    CHECK_THROWS(model.dep.alphar(tau, delta, Eigen::ArrayXd::Constant(N-1, 1.0/(N-1))));
+}
+
+TEST_CASE("Resolved specification of a multifluid model", "[multifluid][export_spec]")
+{
+    nlohmann::json spec = {{"components", {"Ethane", "Nitrogen", "Methane"}}, {"root", "../mycp"}, {"BIP", ""}, {"departure", ""}};
+    auto resolved = resolve_multifluid_spec(spec);
+    CHECK(resolved.at("BIP").size() == 3);
+    CHECK(resolve_multifluid_spec(resolved) == resolved);
+    
+    auto model = multifluidfactory(spec);
+    auto modelresolved = multifluidfactory(resolved);
+    Eigen::ArrayXd z(3); z << 0.2, 0.3, 0.5;
+    CHECK(model.alphar(250.0, 3000.0, z) == modelresolved.alphar(250.0, 3000.0, z));
+    
+    // The wrapped model keeps the specification as given; it is only resolved when it is exported
+    auto am = cppinterface::make_model({{"kind", "multifluid"}, {"model", spec}});
+    CHECK(am->get_spec().at("model") == spec);
+    std::string path = (std::filesystem::temp_directory_path() / "teqp_multifluid_exported_spec.bin").string();
+    am->export_spec(path);
+    auto loaded = cppinterface::make_model_from_exported_spec(path);
+    CHECK(loaded->get_spec().at("model") == resolved);
+    CHECK(loaded->get_Ar11(250.0, 3000.0, z) == am->get_Ar11(250.0, 3000.0, z));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Exported specification of an ECS model does not need the file of the reference fluid", "[multifluid][export_spec]")
+{
+    auto tmp = std::filesystem::temp_directory_path();
+    auto fluidpath = (tmp / "teqp_ECS_reference_R134a.json").string();
+    std::filesystem::copy_file("../mycp/dev/fluids/R134a.json", fluidpath, std::filesystem::copy_options::overwrite_existing);
+    nlohmann::json j = {
+        {"kind", "multifluid-ECS-HuberEly1994"},
+        {"model", {
+            {"reference_fluid", {{"name", fluidpath}, {"acentric", 0.326680}, {"Z_crit", 4.056e6/(5030.8*8.314471*374.179)}, {"T_crit / K", 374.179}, {"rhomolar_crit / mol/m^3", 5030.8}}},
+            {"fluid", {{"name", "R143a"}, {"f_T_coeffs", {-0.22807e-1, -0.64746}}, {"h_T_coeffs", {0.36563, -0.26004e-1}}, {"acentric", 0.25540}, {"T_crit / K", 346.3}, {"rhomolar_crit / mol/m^3", 1/0.194*1000}, {"Z_crit", 3.76e6/(346.3*8.314471*(1/0.194*1000))}}}
+        }}
+    };
+    auto am = cppinterface::make_model(j);
+    auto path = (tmp / "teqp_ECS_exported_spec.bin").string();
+    am->export_spec(path);
+    std::filesystem::remove(fluidpath);
+
+    auto loaded = cppinterface::make_model_from_exported_spec(path);
+    Eigen::ArrayXd z(1); z << 1.0;
+    CHECK(loaded->get_Ar01(400.0, 2600.0, z) == am->get_Ar01(400.0, 2600.0, z));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Lookup of fluids in the shared fluid library", "[multifluid][library]")
+{
+    std::string root = "../mycp";
+    auto& library = FluidLibrary::get(root);
+    CHECK(&library == &FluidLibrary::get(root));
+    CHECK(library.get_alias_map() == build_alias_map(root));
+    CHECK(library.get_path("PROPANE").value() == std::filesystem::absolute(root + "/dev/fluids/n-Propane.json").string());
+    CHECK(!library.get_path("I am not a fluid"));
+    
+    // The index file is written in a temporary root with a copy of some of the fluid files
+    auto tmproot = (std::filesystem::temp_directory_path() / "teqp_fluid_library_test").string();
+    std::filesystem::remove_all(tmproot);
+    std::filesystem::create_directories(tmproot + "/dev/fluids");
+    for (auto name : {"n-Propane", "Nitrogen", "CarbonDioxide", "Water"}){
+        std::filesystem::copy_file(root + "/dev/fluids/" + name + ".json", tmproot + "/dev/fluids/" + name + ".json");
+    }
+    FluidLibrary tmplibrary(tmproot);
+    tmplibrary.write_index();
+    
+    SECTION("Loaded from the index file"){
+        FluidLibrary fromindex(tmproot);
+        CHECK(fromindex.get_alias_map() == build_alias_map(tmproot));
+    }
+    SECTION("Rebuilt when a fluid file is added"){
+        std::filesystem::copy_file(root + "/dev/fluids/Methane.json", tmproot + "/dev/fluids/Methane.json");
+        FluidLibrary fromindex(tmproot);
+        CHECK(fromindex.get_path("METHANE"));
+        CHECK(fromindex.get_alias_map() == build_alias_map(tmproot));
+    }
+    SECTION("Rebuilt when an identifier is out of range"){
+        auto j = load_a_JSON_file(tmplibrary.get_index_path());
+        j["identifiers"]["PROPANE"] = 1000;
+        std::ofstream(tmplibrary.get_index_path()) << j.dump();
+        FluidLibrary fromindex(tmproot);
+        CHECK(fromindex.get_alias_map() == build_alias_map(tmproot));
+    }
+    SECTION("Rebuilt when the index file is not valid"){
+        for (auto contents : {std::string("{\"version\": 1, \"files\": "), std::string("[1, 2, 3]"), std::string("{\"version\": 1, \"files\": 7, \"identifiers\": {}}")}){
+            CAPTURE(contents);
+            std::ofstream(tmplibrary.get_index_path()) << contents;
+            FluidLibrary fromindex(tmproot);
+            CHECK_NOTHROW(fromindex.get_path("PROPANE"));
+            CHECK(fromindex.get_alias_map() == build_alias_map(tmproot));
+        }
+    }
+    SECTION("Parsed contents are cached until the file changes"){
+        auto path = tmproot + "/dev/fluids/Nitrogen.json";
+        auto j = tmplibrary.get_fluid_JSON(path);
+        CHECK(j == tmplibrary.get_fluid_JSON(path));
+        CHECK(*j == load_a_JSON_file(path));
+        
+        auto modified = *j;
+        modified["INFO"]["NAME"] = "ModifiedNitrogen";
+        std::ofstream(path) << modified.dump(1);
+        CHECK(tmplibrary.get_fluid_JSON(path)->at("INFO").at("NAME") == "ModifiedNitrogen");
+    }
+    
+    std::vector<std::string> names = {"PROPANE", "NITROGEN", "CO2", "WATER"};
+    BENCHMARK("build_alias_map and lookup"){
+        auto amap = build_alias_map(tmproot);
+        std::size_t N = 0;
+        for (const auto& name : names){ N += amap.at(name).size(); }
+        return N;
+    };
+    BENCHMARK("index file and lookup"){
+        FluidLibrary lib(tmproot);
+        std::size_t N = 0;
+        for (const auto& name : names){ N += lib.get_path(name).value().size(); }
+        return N;
+    };
+    std::filesystem::remove_all(tmproot);
+}
+
+TEST_CASE("Hessian of Psir with HessianDual numbers", "[multifluid][hessiandual]")
+{
+    std::string root = "../mycp";
+    std::vector<std::string> names = {"Methane", "Nitrogen", "CarbonDioxide", "Ethane", "n-Propane", "n-Butane", "IsoButane", "n-Pentane", "Isopentane", "n-Hexane",
+        "n-Heptane", "n-Octane", "n-Nonane", "n-Decane", "Hydrogen", "Oxygen", "CarbonMonoxide", "Water", "HydrogenSulfide", "Argon"};
+    const double T = 300.0;
+    
+    SECTION("Same as with autodiff"){
+        auto N = GENERATE(2, 5, 10, 20);
+        auto model = build_multifluid_model(std::vector<std::string>(names.begin(), names.begin()+N), root);
+        using id = IsochoricDerivatives<decltype(model)>;
+        Eigen::ArrayXd rhovec = Eigen::ArrayXd::LinSpaced(N, 1.0, 2.0); rhovec *= 3000.0/rhovec.sum();
+        
+        auto H1 = id::build_Psir_Hessian_hessiandual(model, T, rhovec);
+        Eigen::MatrixXd H2 = id::build_Psir_Hessian_autodiff(model, T, rhovec);
+        CHECK(((H1 - H2).array().abs()/H2.array().abs()).maxCoeff() < 1e-12);
+        
+        auto [Psir, grad, H3] = id::build_Psir_fgradHessian_hessiandual(model, T, rhovec);
+        CHECK(Psir == Approx(id::get_Psir(model, T, rhovec)));
+        CHECK(((grad - id::build_Psir_gradient_autodiff(model, T, rhovec).array())/grad).abs().maxCoeff() < 1e-12);
+        CHECK(H3 == H1);
+    }
+    SECTION("Too many components"){
+        // The number of concentrations is checked before the model is evaluated
+        auto model = build_multifluid_model(std::vector<std::string>(names.begin(), names.begin()+2), root);
+        using id = IsochoricDerivatives<decltype(model)>;
+        CHECK_THROWS_AS(id::build_Psir_Hessian_hessiandual(model, T, Eigen::ArrayXd::Constant(33, 100.0)), teqp::InvalidArgument);
+    }
+    SECTION("Benchmarks"){
+        for (auto N : {2, 5, 10, 20}){
+            auto model = build_multifluid_model(std::vector<std::string>(names.begin(), names.begin()+N), root);
+            using id = IsochoricDerivatives<decltype(model)>;
+            Eigen::ArrayXd rhovec = Eigen::ArrayXd::Constant(N, 3000.0/N);
+            BENCHMARK("dual2nd, N=" + std::to_string(N)){
+                return id::build_Psir_Hessian_autodiff(model, T, rhovec);
+            };
+            BENCHMARK("HessianDual, N=" + std::to_string(N)){
+                return id::build_Psir_Hessian_hessiandual(model, T, rhovec);
+            };
+        }
+    }
+}
+
+TEST_CASE("Value, gradient and Hessian of Psi for more than two components", "[multifluid][hessiandual]")
+{
+    std::vector<std::string> names = {"Methane", "Ethane", "n-Propane", "Nitrogen", "CarbonDioxide"};
+    auto N = GENERATE(3, 5);
+    auto model = build_multifluid_model(std::vector<std::string>(names.begin(), names.begin()+N), "../mycp");
+    using id = IsochoricDerivatives<decltype(model)>;
+    const double T = 300.0;
+    Eigen::ArrayXd rhovec = Eigen::ArrayXd::LinSpaced(N, 1.0, 2.0); rhovec *= 3000.0/rhovec.sum();
+    auto RT = model.R(rhovec/rhovec.sum())*T;
+    
+    auto [Psi, grad, H] = id::build_Psi_fgradHessian_autodiff(model, T, rhovec);
+    auto [Psir, gradr, Hr] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+    CHECK(Psi == Approx(Psir + RT*(rhovec*(rhovec.log() - 1.0)).sum()));
+    CHECK(((grad - (id::get_chempotVLE_autodiff(model, T, rhovec) - RT))/grad).abs().maxCoeff() < 1e-12);
+    Eigen::MatrixXd Hdiff = H - Hr;
+    for (auto i = 0; i < N; ++i){
+        CHECK(Hdiff(i, i) == Approx(RT/rhovec[i]));
+    }
+    CHECK(Hdiff.isDiagonal());
+    CHECK(H == id::build_Psi_Hessian_autodiff(model, T, rhovec));
+    
+    // Pressure from the Euler relation
+    double p = (rhovec*grad).sum() - Psi;
+    CHECK(p == Approx(rhovec.sum()*RT + id::get_pr(model, T, rhovec)));
+    
+    // At infinite dilution the ideal-gas terms of the component that is absent are skipped, so everything stays finite
+    Eigen::ArrayXd rhovec0 = rhovec; rhovec0[1] = 0.0;
+    auto [Psi0, grad0, H0] = id::build_Psi_fgradHessian_autodiff(model, T, rhovec0);
+    auto [Psir0, gradr0, Hr0] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec0);
+    CHECK(std::isfinite(Psi0));
+    CHECK(grad0.allFinite());
+    CHECK(H0.allFinite());
+    CHECK(grad0[1] == gradr0[1]);
+    CHECK(H0(1, 1) == Hr0(1, 1));
+}
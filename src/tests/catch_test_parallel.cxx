@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/parallel.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Parallel batch evaluation matches per-point evaluation", "[parallel]")
+{
+    nlohmann::json j = {
+        {"kind", "PR"},
+        {"model", {
+            {"Tcrit / K", {190.564, 305.32}},
+            {"pcrit / Pa", {4599200, 4872200}},
+            {"acentric", {0.011, 0.099}}
+        }}
+    };
+    auto model = teqp::cppinterface::make_model(j);
+    
+    const Eigen::Index N = 1003; // Not a multiple of the chunk size
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 250, 350);
+    Eigen::ArrayXd rho = Eigen::ArrayXd::LinSpaced(N, 1, 10000);
+    Eigen::ArrayXXd Z(N, 2); Z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.1, 0.9); Z.col(1) = 1.0 - Z.col(0);
+    Eigen::ArrayXXd rhovecs = Z.colwise()*rho;
+    
+    parallel::WorkStealingPool pool(4);
+    parallel::BatchOptions opt; opt.chunk_size = 64;
+    
+    SECTION("Arxy"){
+        Eigen::ArrayXd serial(N), par(N);
+        model->get_Arxy_many(1, 2, T, rho, Z, serial);
+        parallel::get_Arxy_many(pool, *model, 1, 2, T, rho, Z, par, opt);
+        for (auto k = 0; k < N; ++k){
+            Eigen::ArrayXd z = Z.row(k).transpose();
+            CHECK(serial[k] == Approx(model->get_Ar12(T[k], rho[k], z)));
+        }
+        CHECK((serial == par).all());
+    }
+    SECTION("Ar0n"){
+        Eigen::ArrayXXd serial(N, 4), par(N, 4);
+        model->get_Ar0n_many(3, T, rho, Z, serial);
+        parallel::get_Ar0n_many(pool, *model, 3, T, rho, Z, par, opt);
+        CHECK((serial == par).all());
+    }
+    SECTION("fugacity coefficients"){
+        Eigen::ArrayXXd serial(N, 2), par(N, 2);
+        model->get_fugacity_coefficients_many(T, rhovecs, serial);
+        parallel::get_fugacity_coefficients_many(pool, *model, T, rhovecs, par, opt);
+        CHECK((serial == par).all());
+    }
+    SECTION("bad derivative orders are rethrown"){
+        Eigen::ArrayXd par(N);
+        CHECK_THROWS(parallel::get_Arxy_many(pool, *model, 4, 4, T, rho, Z, par, opt));
+    }
+    SECTION("bad lengths"){
+        Eigen::ArrayXd par(N-1);
+        CHECK_THROWS(parallel::get_Arxy_many(pool, *model, 1, 1, T, rho, Z, par, opt));
+    }
+}
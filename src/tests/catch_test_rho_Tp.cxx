@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/rho_Tp.hpp"
+
+using namespace teqp;
+
+namespace {
+    auto make_PR(){
+        return teqp::cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 369.89}}, {"pcrit / Pa", {4599200.0, 4251200.0}}, {"acentric", {0.011, 0.1521}}}}});
+    }
+    auto make_PCSAFT(){
+        return teqp::cppinterface::make_model(nlohmann::json::parse(R"({"kind": "PCSAFT", "model": {"names": ["Methane","Ethane"]}})"));
+    }
+    double get_p(const cppinterface::AbstractModel& model, const double T, const double rho, const Eigen::ArrayXd& z){
+        return rho*model.get_R(z)*T*(1.0 + model.get_Ar01(T, rho, z));
+    }
+}
+
+TEST_CASE("Closed-form cubic roots agree with the iterative density solver", "[rho_Tp][cubic]"){
+    auto model = make_PR();
+    Eigen::ArrayXd z(2); z << 0.3, 0.7;
+    
+    for (auto [T, p] : std::vector<std::tuple<double, double>>{{250, 1e5}, {250, 1e6}, {300, 5e6}, {450, 1e7}, {200, 3e7}}){
+        CAPTURE(T); CAPTURE(p);
+        for (auto hint : {PhaseHint::liquid, PhaseHint::vapor, PhaseHint::stable}){
+            double rho = model->solve_rho_Tp(T, p, z, hint);
+            double rhoiter = teqp::solve_rho_Tp(*model, T, p, z, hint);
+            REQUIRE(std::isfinite(rho));
+            CHECK(rho == Approx(rhoiter).epsilon(1e-10));
+            CHECK(get_p(*model, T, rho, z) == Approx(p).epsilon(1e-8));
+        }
+    }
+}
+
+TEST_CASE("Root selection at a state with three roots", "[rho_Tp]"){
+    auto model = make_PR();
+    Eigen::ArrayXd z(2); z << 0.3, 0.7;
+    const double T = 250, p = 1e6;
+    
+    auto check_hints = [&](auto solve){
+        double rhoL = solve(PhaseHint::liquid), rhoV = solve(PhaseHint::vapor), rhostable = solve(PhaseHint::stable);
+        CHECK(rhoL > 10*rhoV);
+        CHECK((rhostable == rhoL || rhostable == rhoV));
+        // The stable root has the lower Gibbs energy
+        const double R = model->get_R(z);
+        CHECK(rho_Tp::get_gr_RT(*model, T, rhostable, p, z, R) <= rho_Tp::get_gr_RT(*model, T, (rhostable == rhoL) ? rhoV : rhoL, p, z, R));
+    };
+    SECTION("closed-form"){
+        check_hints([&](PhaseHint hint){ return model->solve_rho_Tp(T, p, z, hint); });
+    }
+    SECTION("iterative"){
+        check_hints([&](PhaseHint hint){ return teqp::solve_rho_Tp(*model, T, p, z, hint); });
+    }
+    CHECK_THROWS(model->solve_rho_Tp(T, -1.0, z));
+}
+
+TEST_CASE("Density solver for a non-cubic model", "[rho_Tp][PCSAFT]"){
+    auto model = make_PCSAFT();
+    Eigen::ArrayXd z(2); z << 0.4, 0.6;
+    for (auto [T, p] : std::vector<std::tuple<double, double>>{{200, 1e5}, {200, 1e7}, {300, 5e6}}){
+        CAPTURE(T); CAPTURE(p);
+        for (auto hint : {PhaseHint::liquid, PhaseHint::vapor, PhaseHint::stable}){
+            double rho = model->solve_rho_Tp(T, p, z, hint);
+            REQUIRE(std::isfinite(rho));
+            CHECK(get_p(*model, T, rho, z) == Approx(p).epsilon(1e-8));
+            auto [pr, dpdrho, d2pdrho2] = rho_Tp::get_p_derivs(*model, T, rho, z, model->get_R(z));
+            CHECK(dpdrho > 0);
+        }
+    }
+}
+
+TEST_CASE("Batched density solver", "[rho_Tp]"){
+    auto model = make_PR();
+    const Eigen::Index N = 50;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 200, 400), p = Eigen::ArrayXd::LinSpaced(N, 1e5, 1e7);
+    Eigen::ArrayXXd Z(N, 2); Z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.1, 0.9); Z.col(1) = 1.0 - Z.col(0);
+    Eigen::ArrayXd out(N);
+    model->solve_rho_Tp_many(T, p, Z, PhaseHint::stable, out);
+    for (auto k = 0; k < N; ++k){
+        Eigen::ArrayXd z = Z.row(k).transpose();
+        CHECK(out[k] == model->solve_rho_Tp(T[k], p[k], z));
+    }
+    Eigen::ArrayXd tooshort(N-1);
+    CHECK_THROWS(model->solve_rho_Tp_many(T, p, Z, PhaseHint::stable, tooshort));
+}
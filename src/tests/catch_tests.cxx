@@ -547,6 +547,43 @@ TEST_CASE("Test water w/ factory", "[CPA]") {
    REQUIRE(p_withassoc == Approx(312682.0709));
 }
 
+TEST_CASE("Test water+methanol", "[CPA]") {
+    // Methanol is 2B, parameters from Kontogeorgis and Folas
+    std::valarray<double> a0 = {0.12277, 0.40531}, bi = {0.000014515, 0.000030978}, c1 = {0.67359, 0.43102}, Tc = {647.096, 512.64};
+    auto R = 8.3144598;
+    std::vector<CPA::association_classes> schemes = { CPA::association_classes::a4C, CPA::association_classes::a2B };
+    std::valarray<double> epsAB = { 16655, 24591 }, betaAB = { 0.0692, 0.0161 };
+    CPA::CPAAssociation cpaa(CPA::CPACubic(CPA::cubic_flag::SRK, a0, bi, c1, Tc, R), schemes, CPA::radial_dist::KG, epsAB, betaAB, R);
+    CPA::CPAEOS cpa(CPA::CPACubic(CPA::cubic_flag::SRK, a0, bi, c1, Tc, R), std::move(cpaa));
+    double T = 350, rhomolar = 30000;
+
+    SECTION("Pure water limit") {
+        std::valarray<double> a0w = {a0[0]}, biw = {bi[0]}, c1w = {c1[0]}, Tcw = {Tc[0]}, epsABw = {epsAB[0]}, betaABw = {betaAB[0]};
+        std::vector<CPA::association_classes> schemesw = { schemes[0] };
+        CPA::CPAAssociation water(CPA::CPACubic(CPA::cubic_flag::SRK, a0w, biw, c1w, Tcw, R), schemesw, CPA::radial_dist::KG, epsABw, betaABw, R);
+        auto z = (Eigen::ArrayXd(2) << 1.0, 0.0).finished();
+        auto zw = (Eigen::ArrayXd(1) << 1.0).finished();
+        CHECK(cpa.assoc.alphar(T, rhomolar, z) == Approx(water.alphar(T, rhomolar, zw)));
+        // The closed-form solution for the site fraction of a pure fluid
+        double XA = CPA::XA_calc_pure(4, CPA::association_classes::a4C, CPA::radial_dist::KG, epsAB[0], betaAB[0], bi[0], R*T, rhomolar, zw)(0, 0);
+        CHECK(water.alphar(T, rhomolar, zw) == Approx(4*(log(XA) - XA/2 + 0.5)));
+    }
+    SECTION("Derivatives") {
+        auto z = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+        using my_float_type = boost::multiprecision::number<boost::multiprecision::cpp_bin_float<100U>>;
+        my_float_type Trecip = 1/T, rhof = rhomolar, h = my_float_type(1e-30);
+        using tdc = TDXDerivatives<decltype(cpa)>;
+        auto fT = [&cpa, &z, &rhof](const auto& Trecip) -> my_float_type { return cpa.alphar(forceeval(1/Trecip), rhof, z); };
+        auto frho = [&cpa, &z, &Trecip](const auto& rho) -> my_float_type { return cpa.alphar(forceeval(1/Trecip), rho, z); };
+        auto Ar10_cd = static_cast<double>(centered_diff<1, 4>(fT, Trecip, h) * Trecip);
+        auto Ar01_cd = static_cast<double>(centered_diff<1, 4>(frho, rhof, h) * rhof);
+        auto Ar02_cd = static_cast<double>(centered_diff<2, 4>(frho, rhof, h) * rhof * rhof);
+        CHECK(tdc::get_Ar10(cpa, T, rhomolar, z) == Approx(Ar10_cd));
+        CHECK(tdc::get_Ar01(cpa, T, rhomolar, z) == Approx(Ar01_cd));
+        CHECK(tdc::get_Ar02(cpa, T, rhomolar, z) == Approx(Ar02_cd));
+    }
+}
+
 TEST_CASE("Check zero(ish)","") {
     double zero = 0.0;
     REQUIRE(zero == 0.0);
@@ -2,7 +2,7 @@ import os, warnings, functools
 
 # Bring all entities from the extension module into this namespace
 from .teqp import *
-from .teqp import _make_model, _build_multifluid_mutant
+from .teqp import _make_model, _make_model_from_exported_spec, _build_multifluid_mutant
 
 def get_datapath():
     """Get the absolute path to the folder containing the root of multi-fluid data"""
@@ -48,6 +48,14 @@ def make_model(*args, **kwargs):
     attach_model_specific_methods(AS)
     return AS
 
+def make_model_from_exported_spec(path):
+    """
+    Make a model from the specification written by the export_spec method of a model, and attach the model-specific methods
+    """
+    AS = _make_model_from_exported_spec(path)
+    attach_model_specific_methods(AS)
+    return AS
+
 def vdWEOS(Tc_K, pc_Pa):
     j = {
         "kind": "vdW",